@@ -0,0 +1,218 @@
+#include "async.h"
+
+#include <fstream>
+
+void Executor::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        ready.push_back(handle);
+    }
+    wakeup.notify_one();
+}
+
+void Executor::stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+}
+
+
+void BlockingPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            wakeup.wait(guard, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+BlockingPool::BlockingPool(unsigned threadCount) {
+    for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+        workers.emplace_back(&BlockingPool::workerLoop, this);
+    }
+}
+
+BlockingPool::~BlockingPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void BlockingPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wakeup.notify_one();
+}
+
+
+void AsyncWarehouse::notifyStockChanged(int itemId) {
+    auto it = stockWaiters.find(itemId);
+    if (it == stockWaiters.end()) {
+        return;
+    }
+    auto waiters = std::move(it->second);
+    stockWaiters.erase(it);
+    for (int orderId : waiters) {
+        notifyOrderChanged(orderId);
+    }
+}
+
+void AsyncWarehouse::notifyOrderChanged(int orderId) {
+    auto it = orderWaiters.find(orderId);
+    if (it == orderWaiters.end()) {
+        return;
+    }
+    auto handle = it->second;
+    orderWaiters.erase(it);
+    executor.post(handle);
+}
+
+void AsyncWarehouse::wakeCancelledOrders() {
+    std::vector<int> cancelled;
+    for (const auto& [orderId, handle] : orderWaiters) {
+        if (system.findOrder(orderId)->getStatus() == OrderStatus::Cancelled) {
+            cancelled.push_back(orderId);
+        }
+    }
+    for (int orderId : cancelled) {
+        notifyOrderChanged(orderId);
+    }
+}
+
+Task<std::optional<InventoryItem>> AsyncWarehouse::findItemAsync(int id) {
+    co_await executor.schedule();
+    const auto& constSystem = system;
+    auto item = constSystem.findItem(id);
+    co_return item ? std::optional<InventoryItem>(*item) : std::nullopt;
+}
+
+Task<bool> AsyncWarehouse::addItemAsync(InventoryItem item) {
+    co_await executor.schedule();
+    item.setId(system.getNextId());
+    if (!WarehouseSystem::isValidItem(item)) {
+        co_return false;
+    }
+    system.addItem(item);
+    notifyStockChanged(item.getId());
+    co_return true;
+}
+
+Task<bool> AsyncWarehouse::updateItemAsync(InventoryItem item) {
+    co_await executor.schedule();
+    if (!WarehouseSystem::isValidItem(item) || !system.updateItem(item)) {
+        co_return false;
+    }
+    notifyStockChanged(item.getId());
+    co_return true;
+}
+
+Task<bool> AsyncWarehouse::removeItemAsync(int id) {
+    co_await executor.schedule();
+    bool removed = system.removeItem(id);
+    // Waiting orders for a removed item were cancelled; they resume and give up
+    notifyStockChanged(id);
+    wakeCancelledOrders();
+    co_return removed;
+}
+
+Task<WarehouseSystem::ReceiveResult> AsyncWarehouse::receiveShipmentAsync(std::vector<RestockLine> lines) {
+    co_await executor.schedule();
+    auto result = system.receiveShipment(lines);
+    if (result.received) {
+        for (const auto& line : lines) {
+            notifyStockChanged(line.itemId);
+        }
+    }
+    co_return result;
+}
+
+Task<int> AsyncWarehouse::createOrderAsync(std::vector<OrderLine> lines) {
+    co_await executor.schedule();
+    int orderId = system.placeOrder(lines);
+    if (!orderId) {
+        co_return 0;
+    }
+
+    while (true) {
+        auto result = system.fulfillOrder(orderId);
+        if (result == WarehouseSystem::OrderResult::NoOrders) {
+            // Someone else processed or cancelled the order while it waited
+            auto status = system.findOrder(orderId)->getStatus();
+            co_return status == OrderStatus::Cancelled ? 0 : orderId;
+        }
+        if (result == WarehouseSystem::OrderResult::Processed) {
+            co_return orderId;
+        }
+        if (result == WarehouseSystem::OrderResult::ItemMissing) {
+            co_return 0;
+        }
+        // Wait for the first line that is still short; the others are
+        // checked again when it wakes up
+        int itemId = 0;
+        for (const auto& line : system.findOrder(orderId)->getLines()) {
+            if (system.getAvailableQuantity(line.getItemId()) < line.getQuantity()) {
+                itemId = line.getItemId();
+                break;
+            }
+        }
+        waitingOrders++;
+        co_await waitForStock(orderId, itemId);
+        waitingOrders--;
+    }
+}
+
+Task<bool> AsyncWarehouse::setOrderStatusAsync(int orderId, OrderStatus status) {
+    co_await executor.schedule();
+    bool changed = system.setOrderStatus(orderId, status);
+    if (changed) {
+        notifyOrderChanged(orderId);
+    }
+    co_return changed;
+}
+
+Task<int> AsyncWarehouse::createOrderAsync(int itemId, int quantity) {
+    auto order = createOrderAsync(std::vector<OrderLine>{OrderLine(itemId, quantity)});
+    co_return co_await std::move(order);
+}
+
+Task<> AsyncWarehouse::saveAsync() {
+    co_await executor.schedule();
+    auto snapshot = std::make_shared<WarehouseSystem::CsvSnapshot>(system.snapshotCsv());
+    // Auto-save is off here, so the logs are only flushed by saves
+    system.flushLogs();
+    std::string path = system.getFilename();
+    auto written = std::make_shared<bool>(false);
+    // Named rather than a temporary: GCC 12 mis-destroys non-trivial
+    // awaiter temporaries held across a suspension point
+    std::string locationsPath = system.getLocationsPath();
+    auto write = pool.run(executor, [snapshot, path, locationsPath, written]() {
+        std::ofstream file(path);
+        file.write(snapshot->text.data(), static_cast<std::streamsize>(snapshot->text.size()));
+        file.close();
+        *written = static_cast<bool>(file);
+        if (*written && !snapshot->locationsText.empty()) {
+            std::ofstream locationsFile(locationsPath);
+            locationsFile << snapshot->locationsText;
+        }
+    });
+    co_await write;
+    if (*written) {
+        system.csvSaved(*snapshot);
+    }
+}
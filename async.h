@@ -0,0 +1,333 @@
+#pragma once
+
+#include "warehouse.h"
+
+#include <atomic>
+#include <coroutine>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Coroutine API
+//
+// AsyncWarehouse runs every WarehouseSystem call on a single-threaded
+// Executor, so coroutines never need a lock around the inventory. Blocking
+// file I/O is handed to a BlockingPool and the awaiting coroutine resumes on
+// the executor when it finishes. Orders short on stock suspend until the
+// item is replenished instead of cycling through the order queue.
+
+// Result storage for Task<T>; specialized so Task<void> uses return_void()
+template <typename T>
+struct TaskResult {
+    std::optional<T> value;
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(*value); }
+};
+
+template <>
+struct TaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+// Lazily started coroutine. Awaiting a task starts it and resumes the
+// awaiting coroutine when it finishes.
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : TaskResult<T> {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+        return handle.promise().take();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+};
+
+// Fire-and-forget coroutine that frees itself when it finishes
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// Single-threaded run queue. post() may be called from any thread; queued
+// coroutines only ever resume on the thread calling run().
+class Executor {
+private:
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::coroutine_handle<>> ready;
+    bool stopping = false;
+    std::atomic<std::thread::id> owner;  // Thread inside runUntil(), if any
+
+    template <typename T>
+    static DetachedTask runDetached(Executor& executor, Task<T> task) {
+        co_await executor.schedule();
+        co_await std::move(task);
+    }
+
+public:
+    void post(std::coroutine_handle<> handle);
+
+    bool runsOnCurrentThread() const { return owner == std::this_thread::get_id(); }
+
+    // co_await executor.schedule() moves the coroutine onto the executor.
+    // Coroutines already running on it continue without a round trip.
+    auto schedule() {
+        struct ScheduleAwaiter {
+            Executor& executor;
+            bool await_ready() const noexcept { return executor.runsOnCurrentThread(); }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return ScheduleAwaiter{*this};
+    }
+
+    // Start a task on the executor without waiting for it
+    template <typename T>
+    void spawn(Task<T> task) {
+        runDetached(*this, std::move(task));
+    }
+
+    // Resume queued coroutines until done() returns true or stop() is called,
+    // sleeping while the queue is empty
+    template <typename Predicate>
+    void runUntil(Predicate done) {
+        auto previousOwner = owner.exchange(std::this_thread::get_id());
+        while (!done()) {
+            std::coroutine_handle<> next;
+            {
+                std::unique_lock<std::mutex> guard(mutex);
+                wakeup.wait(guard, [this]() { return stopping || !ready.empty(); });
+                if (ready.empty()) {
+                    break;
+                }
+                next = ready.front();
+                ready.pop_front();
+            }
+            next.resume();
+        }
+        owner = previousOwner;
+    }
+
+    void run() {
+        runUntil([]() { return false; });
+    }
+
+    void stop();
+};
+
+// Small thread pool for blocking work such as file writes
+class BlockingPool {
+private:
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    explicit BlockingPool(unsigned threadCount = 1);
+
+    ~BlockingPool();
+
+    void submit(std::function<void()> job);
+
+    // co_await pool.run(executor, fn) runs fn on a pool thread, then resumes
+    // the coroutine on the executor
+    template <typename Function>
+    auto run(Executor& executor, Function function) {
+        struct RunAwaiter {
+            BlockingPool& pool;
+            Executor& executor;
+            Function function;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                pool.submit([this, handle]() {
+                    function();
+                    executor.post(handle);
+                });
+            }
+            void await_resume() const noexcept {}
+        };
+        return RunAwaiter{*this, executor, std::move(function)};
+    }
+};
+
+template <typename T>
+Task<> completeInto(Task<T>& task, std::optional<T>& result, std::exception_ptr& error,
+                    bool& finished) {
+    try {
+        result = co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    finished = true;
+}
+
+inline Task<> completeInto(Task<>& task, std::exception_ptr& error, bool& finished) {
+    try {
+        co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    finished = true;
+}
+
+// Run a task to completion, driving the executor on the calling thread
+template <typename T>
+T syncWait(Executor& executor, Task<T> task) {
+    bool finished = false;
+    std::exception_ptr error;
+    if constexpr (std::is_void_v<T>) {
+        executor.spawn(completeInto(task, error, finished));
+        executor.runUntil([&finished]() { return finished; });
+        if (error) std::rethrow_exception(error);
+    } else {
+        std::optional<T> result;
+        executor.spawn(completeInto(task, result, error, finished));
+        executor.runUntil([&finished]() { return finished; });
+        if (error) std::rethrow_exception(error);
+        return std::move(*result);
+    }
+}
+
+// Coroutine front end for WarehouseSystem. Saving is deferred while an
+// AsyncWarehouse is in use; call saveAsync() to persist.
+class AsyncWarehouse {
+private:
+    WarehouseSystem& system;
+    Executor& executor;
+    BlockingPool& pool;
+    // Orders waiting on each item, and the coroutine waiting on each order.
+    // An order woken through notifyOrderChanged() stays in its item's list
+    // and is skipped when the item wakes it.
+    std::map<int, std::deque<int>> stockWaiters;
+    std::map<int, std::coroutine_handle<>> orderWaiters;
+    std::size_t waitingOrders = 0;
+
+    // Suspend until notifyStockChanged() is called for itemId or
+    // notifyOrderChanged() for orderId
+    auto waitForStock(int orderId, int itemId) {
+        struct StockAwaiter {
+            AsyncWarehouse& warehouse;
+            int orderId;
+            int itemId;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                warehouse.stockWaiters[itemId].push_back(orderId);
+                warehouse.orderWaiters[orderId] = handle;
+            }
+            void await_resume() const noexcept {}
+        };
+        return StockAwaiter{*this, orderId, itemId};
+    }
+
+    // Wake waiting orders that were cancelled, such as the orders of a
+    // removed item that were waiting on one of their other items
+    void wakeCancelledOrders();
+
+public:
+    AsyncWarehouse(WarehouseSystem& system, Executor& executor, BlockingPool& pool)
+        : system(system), executor(executor), pool(pool) {
+        system.setAutoSave(false);
+    }
+
+    // Wake every order waiting on itemId so it can check stock again.
+    // Call this after changing the item's stock outside AsyncWarehouse.
+    void notifyStockChanged(int itemId);
+
+    // Wake the coroutine waiting on an order, if any, so it sees the
+    // order's new status. Call this after cancelling or reserving an order
+    // outside AsyncWarehouse.
+    void notifyOrderChanged(int orderId);
+
+    std::size_t getWaitingOrderCount() const { return waitingOrders; }
+
+    Task<std::optional<InventoryItem>> findItemAsync(int id);
+
+    Task<bool> addItemAsync(InventoryItem item);
+
+    Task<bool> updateItemAsync(InventoryItem item);
+
+    Task<bool> removeItemAsync(int id);
+
+    // Receive a shipment and wake the orders waiting on its items
+    Task<WarehouseSystem::ReceiveResult> receiveShipmentAsync(std::vector<RestockLine> lines);
+
+    // Create an order and reserve its stock once stock allows, suspending
+    // while an item is short. The order is queued like any other and shows
+    // as Backordered while it waits. Returns the order ID, or 0 if the order
+    // is invalid or was cancelled, or an item was removed while waiting.
+    Task<int> createOrderAsync(std::vector<OrderLine> lines);
+
+    Task<int> createOrderAsync(int itemId, int quantity);
+
+    // Move an order along the state machine, waking its waiting coroutine
+    Task<bool> setOrderStatusAsync(int orderId, OrderStatus status);
+
+    Task<bool> cancelOrderAsync(int orderId) { return setOrderStatusAsync(orderId, OrderStatus::Cancelled); }
+
+    // Snapshot the inventory on the executor, then write it on the blocking
+    // pool so requests keep running during the disk write. The order and
+    // stock logs are flushed when the snapshot is taken.
+    Task<> saveAsync();
+};
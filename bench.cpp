@@ -0,0 +1,604 @@
+#include "warehouse.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+
+// Benchmark suite for WarehouseSystem
+//
+// Usage: bench [--items N] [--depth D] [--fanout F] [--name-length L]
+//              [--seed S] [--min-time SECONDS] [--filter TEXT] [--csv]
+//
+// Every benchmark runs against a synthetic inventory loaded from a generated
+// CSV file. Like Google Benchmark, each one is repeated with a growing
+// iteration count until it runs for at least --min-time seconds, and the
+// time per iteration is reported. Output from the display functions is
+// discarded so the terminal does not dominate the measurement, and auto-save
+// is off so only the save benchmark writes the CSV file. The order and
+// history benchmarks build on the orders and transactions queued before them.
+
+struct BenchmarkConfig {
+    int items = 100000;
+    int depth = 3;           // Levels in each category path
+    int fanout = 8;          // Subcategories per level
+    int nameLength = 12;
+    unsigned seed = 42;
+    double minTime = 0.5;
+    std::string filter;
+    bool csv = false;
+};
+
+// Timing loop handed to each benchmark. Use it as
+//     for (auto _ : state) { ... }
+// and wrap per-iteration setup in pauseTiming()/resumeTiming().
+class BenchmarkState {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t iterations;
+    Clock::duration paused{};
+    Clock::time_point pausedAt;
+    Clock::time_point start;
+    Clock::time_point stop;
+    std::uint64_t itemsProcessed = 0;
+
+public:
+    struct [[maybe_unused]] Value {};
+
+    struct Iterator {
+        BenchmarkState* state;
+        std::uint64_t remaining;
+
+        bool operator!=(const Iterator&) const {
+            if (remaining == 0) {
+                state->stop = Clock::now();
+                return false;
+            }
+            return true;
+        }
+        void operator++() { remaining--; }
+        Value operator*() const { return Value(); }
+    };
+
+    explicit BenchmarkState(std::uint64_t iterations) : iterations(iterations) {}
+
+    Iterator begin() {
+        paused = Clock::duration::zero();
+        start = Clock::now();
+        return Iterator{this, iterations};
+    }
+    Iterator end() { return Iterator{this, 0}; }
+
+    void pauseTiming() { pausedAt = Clock::now(); }
+    void resumeTiming() { paused += Clock::now() - pausedAt; }
+
+    // Units of work per iteration, for the items/s column
+    void setItemsProcessed(std::uint64_t items) { itemsProcessed = items; }
+
+    std::uint64_t getIterations() const { return iterations; }
+    std::uint64_t getItemsProcessed() const { return itemsProcessed; }
+    double elapsedSeconds() const {
+        return std::chrono::duration<double>(stop - start - paused).count();
+    }
+};
+
+// Generated catalog shared by all benchmarks
+struct BenchmarkData {
+    BenchmarkConfig config;
+    std::string csvPath;
+    std::vector<std::string> categories;  // Leaf category paths
+    std::unique_ptr<WarehouseSystem> system;
+    std::mt19937 random;
+};
+
+// Stream buffer that drops everything written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Redirects std::cout to a NullBuffer for the lifetime of the object
+class SilenceOutput {
+private:
+    NullBuffer buffer;
+    std::streambuf* previous;
+
+public:
+    SilenceOutput() : previous(std::cout.rdbuf(&buffer)) {}
+    ~SilenceOutput() { std::cout.rdbuf(previous); }
+};
+
+std::string randomName(std::mt19937& random, int length) {
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::string name(static_cast<std::size_t>(length), 'a');
+    for (auto& c : name) {
+        c = static_cast<char>('a' + letter(random));
+    }
+    name[0] = static_cast<char>(name[0] - 'a' + 'A');
+    return name;
+}
+
+// Build every leaf path of a category tree, e.g. "C3/C3.1/C3.1.7"
+void generateCategories(const std::string& prefix, const std::string& label, int level,
+                        const BenchmarkConfig& config, std::vector<std::string>& out) {
+    for (int i = 0; i < config.fanout; i++) {
+        std::string childLabel = label.empty() ? std::string("C") : label + ".";
+        childLabel += std::to_string(i);
+        std::string path = prefix.empty() ? childLabel : prefix + "/" + childLabel;
+        if (level + 1 >= config.depth) {
+            out.push_back(path);
+        } else {
+            generateCategories(path, childLabel, level + 1, config, out);
+        }
+    }
+}
+
+void generateInventory(BenchmarkData& data) {
+    const auto& config = data.config;
+    generateCategories("", "", 0, config, data.categories);
+
+    std::ofstream file(data.csvPath);
+    file << "ID,Name,Category,Quantity,Price,MinStockLevel\n";
+    std::uniform_int_distribution<std::size_t> category(0, data.categories.size() - 1);
+    std::uniform_int_distribution<int> quantity(0, 1000);
+    std::uniform_int_distribution<int> minStock(0, 50);
+    std::uniform_real_distribution<double> price(0.5, 500.0);
+    for (int id = 1; id <= config.items; id++) {
+        file << id << "," << randomName(data.random, config.nameLength) << ","
+             << data.categories[category(data.random)] << "," << quantity(data.random) << ","
+             << std::fixed << std::setprecision(2) << price(data.random) << ","
+             << minStock(data.random) << "\n";
+    }
+}
+
+void benchLoad(BenchmarkState& state, BenchmarkData& data) {
+    for (auto _ : state) {
+        WarehouseSystem system(data.csvPath);
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchSave(BenchmarkState& state, BenchmarkData& data) {
+    for (auto _ : state) {
+        data.system->save();
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchFindItem(BenchmarkState& state, BenchmarkData& data) {
+    std::vector<int> ids(4096);
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    for (auto& value : ids) {
+        value = id(data.random);
+    }
+    std::size_t next = 0;
+    std::uint64_t found = 0;
+    for (auto _ : state) {
+        found += data.system->findItem(ids[next++ & 4095]) != nullptr;
+    }
+    if (found == 0) {
+        std::cerr << "find_item: no items found\n";
+    }
+    state.setItemsProcessed(1);
+}
+
+// Search queries cut from existing names: a prefix, a piece from the
+// middle, or the whole name with one letter changed
+enum class SearchQuery { Prefix, Substring, Typo };
+
+template <SearchQuery Kind>
+void benchSearch(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    std::vector<std::string> queries(4096);
+    for (auto& query : queries) {
+        std::string name = data.system->findItem(id(data.random))->getName();
+        std::size_t length = std::min<std::size_t>(name.size(), 5);
+        if (Kind == SearchQuery::Prefix) {
+            query = name.substr(0, length);
+        } else if (Kind == SearchQuery::Substring) {
+            query = name.substr(name.size() - length);
+        } else {
+            name[name.size() / 2] = name[name.size() / 2] == 'z' ? 'a' : 'z';
+            query = name;
+        }
+    }
+    std::size_t next = 0;
+    std::uint64_t found = 0;
+    for (auto _ : state) {
+        found += data.system->searchItems(queries[next++ & 4095]).size();
+    }
+    if (found == 0) {
+        std::cerr << "search: no items found\n";
+    }
+    state.setItemsProcessed(1);
+}
+
+// Ad-hoc queries shaped so the planner takes each of its access paths:
+// low stock over the whole catalog, a category subtree, a name prefix, a
+// narrow price band and nearly sold-out items
+enum class QueryShape { Scan, Category, NamePrefix, PriceRange, LowQuantity };
+
+template <QueryShape Shape>
+void benchQuery(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    std::uniform_int_distribution<int> price(1, 475);
+    std::uniform_int_distribution<std::size_t> category(0, data.categories.size() - 1);
+    std::vector<ItemQuery> queries(64);
+    for (auto& query : queries) {
+        std::string text;
+        if (Shape == QueryShape::Scan) {
+            text = "lowstock sort=-quantity limit=20";
+        } else if (Shape == QueryShape::PriceRange) {
+            int low = price(data.random);
+            text = "price=" + std::to_string(low) + ".." + std::to_string(low + 2) + " sort=price limit=20";
+        } else if (Shape == QueryShape::LowQuantity) {
+            text = "quantity<" + std::to_string(price(data.random) % 5 + 1) + " limit=20";
+        } else if (Shape == QueryShape::Category) {
+            const std::string& leaf = data.categories[category(data.random)];
+            text = "category=" + leaf.substr(0, leaf.rfind('/')) + " quantity<100 limit=20";
+        } else {
+            text = "name=" + data.system->findItem(id(data.random))->getName().substr(0, 3) + " limit=20";
+        }
+        ItemQuery::parse(text, query);
+    }
+    std::size_t next = 0;
+    std::uint64_t matched = 0;
+    for (auto _ : state) {
+        matched += data.system->queryItems(queries[next++ & 63]).matched;
+    }
+    if (matched == 0) {
+        std::cerr << "query: no items matched\n";
+    }
+    state.setItemsProcessed(Shape == QueryShape::Scan ? static_cast<std::uint64_t>(data.config.items) : 1);
+}
+
+void benchCategoryQuery(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<std::size_t> category(0, data.categories.size() - 1);
+    SilenceOutput silence;
+    for (auto _ : state) {
+        data.system->displayByCategory(data.categories[category(data.random)]);
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+// Stock totals of every category, on Threads threads (0 for all of them)
+template <unsigned Threads>
+void benchAggregateStock(BenchmarkState& state, BenchmarkData& data) {
+    long long quantity = 0;
+    for (auto _ : state) {
+        quantity += data.system->aggregateStock(Threads).total.quantity;
+    }
+    if (quantity == 0) {
+        std::cerr << "aggregate: no stock counted\n";
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+// Running totals of a random category, as a dashboard would poll them
+void benchStockTotals(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<std::size_t> category(0, data.categories.size() - 1);
+    std::size_t items = 0;
+    for (auto _ : state) {
+        items += data.system->getStockTotals(data.categories[category(data.random)]).items;
+    }
+    if (items == 0) {
+        std::cerr << "stock totals: no items counted\n";
+    }
+    state.setItemsProcessed(1);
+}
+
+// Demand for a random item, about four events per item per simulated day
+void benchRecordDemand(BenchmarkState& state, BenchmarkData& data) {
+    DemandForecaster forecaster;
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    std::uint64_t events = 0;
+    for (auto _ : state) {
+        auto day = static_cast<std::time_t>(events / (4 * static_cast<std::uint64_t>(data.config.items)));
+        forecaster.recordDemand(id(data.random), static_cast<double>(1 + (events & 3)), day * 86400);
+        events++;
+    }
+    if (forecaster.size() == 0) {
+        std::cerr << "record demand: no items seen\n";
+    }
+    state.setItemsProcessed(1);
+}
+
+// Reorder recommendations for every item after 30 days of demand, on
+// Threads threads (0 for all of them)
+template <unsigned Threads>
+void benchRecommendReorders(BenchmarkState& state, BenchmarkData& data) {
+    DemandForecaster forecaster;
+    std::uniform_int_distribution<int> units(0, 8);
+    for (std::time_t day = 0; day < 30; day++) {
+        for (int id = 1; id <= data.config.items; id++) {
+            forecaster.recordDemand(id, units(data.random), day * 86400);
+        }
+    }
+    long long reorderPoints = 0;
+    for (auto _ : state) {
+        for (const auto& recommendation : forecaster.recommendAll(30 * 86400, Threads)) {
+            reorderPoints += recommendation.reorderPoint;
+        }
+    }
+    if (reorderPoints == 0) {
+        std::cerr << "recommend reorders: no reorder points\n";
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchLowStockScan(BenchmarkState& state, BenchmarkData& data) {
+    SilenceOutput silence;
+    for (auto _ : state) {
+        data.system->displayLowStockItems();
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchSortByName(BenchmarkState& state, BenchmarkData& data) {
+    SilenceOutput silence;
+    for (auto _ : state) {
+        data.system->sortByName();
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchSortByQuantity(BenchmarkState& state, BenchmarkData& data) {
+    SilenceOutput silence;
+    for (auto _ : state) {
+        data.system->sortByQuantity();
+    }
+    state.setItemsProcessed(static_cast<std::uint64_t>(data.config.items));
+}
+
+void benchCreateOrder(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    for (auto _ : state) {
+        data.system->placeOrder(id(data.random), 1);
+    }
+    state.setItemsProcessed(1);
+}
+
+// Raise every item to a huge quantity, through updateItem() so the
+// query columns see the change
+void restockAll(WarehouseSystem& system, int items) {
+    for (int i = 1; i <= items; i++) {
+        InventoryItem item = *system.findItem(i);
+        item.setQuantity(1 << 30);
+        system.updateItem(item);
+    }
+}
+
+void benchProcessOrder(BenchmarkState& state, BenchmarkData& data) {
+    auto& system = *data.system;
+    // Restock every item so no order falls short, drain orders left by
+    // earlier runs, then queue one order per iteration
+    restockAll(system, data.config.items);
+    while (system.getPendingOrderCount() > 0) {
+        system.fulfillNextOrder();
+    }
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    for (std::uint64_t i = 0; i < state.getIterations(); i++) {
+        system.placeOrder(id(data.random), 1);
+    }
+
+    for (auto _ : state) {
+        system.fulfillNextOrder();
+    }
+    state.setItemsProcessed(1);
+}
+
+// Process single-unit orders whose items sit in four bins over two
+// warehouses, so each order picks its bin by Policy
+template <AllocationPolicy Policy>
+void benchPickFromBins(BenchmarkState& state, BenchmarkData& data) {
+    auto& system = *data.system;
+    restockAll(system, data.config.items);
+    while (system.getPendingOrderCount() > 0) {
+        system.fulfillNextOrder();
+    }
+    static const char* const kBins[] = {"East/A/01", "East/B/02", "West/A/01", "West/C/03"};
+    for (int i = 1; i <= data.config.items; i++) {
+        for (const char* bin : kBins) {
+            system.receiveStockAt(i, bin, 1 << 24);
+        }
+    }
+    system.setAllocationPolicy(Policy, "East/A/09");
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    for (std::uint64_t i = 0; i < state.getIterations(); i++) {
+        system.placeOrder(id(data.random), 1);
+    }
+
+    for (auto _ : state) {
+        system.fulfillNextOrder();
+    }
+    state.setItemsProcessed(1);
+}
+
+// Deliver stock for a random item, as receiving at a dock would
+void benchReceiveStock(BenchmarkState& state, BenchmarkData& data) {
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    std::size_t received = 0;
+    for (auto _ : state) {
+        received += data.system->receiveStock(id(data.random), 1).received;
+    }
+    if (received == 0) {
+        std::cerr << "receive: no stock received\n";
+    }
+    state.setItemsProcessed(1);
+}
+
+// Place and process one order of Lines lines per iteration, so the items/s
+// column counts order lines
+template <int Lines>
+void benchMultiLineOrder(BenchmarkState& state, BenchmarkData& data) {
+    auto& system = *data.system;
+    restockAll(system, data.config.items);
+    while (system.getPendingOrderCount() > 0) {
+        system.fulfillNextOrder();
+    }
+    std::uniform_int_distribution<int> id(1, data.config.items);
+    std::vector<std::vector<OrderLine>> orders(256);
+    for (auto& lines : orders) {
+        for (int i = 0; i < Lines; i++) {
+            lines.emplace_back(id(data.random), 1);
+        }
+    }
+
+    std::size_t next = 0;
+    for (auto _ : state) {
+        int orderId = system.placeOrder(orders[next++ & 255]);
+        system.fulfillOrder(orderId);
+    }
+    state.setItemsProcessed(Lines);
+}
+
+void benchDisplayHistory(BenchmarkState& state, BenchmarkData& data) {
+    SilenceOutput silence;
+    for (auto _ : state) {
+        data.system->displayTransactionHistory();
+    }
+    state.setItemsProcessed(10);
+}
+
+struct Benchmark {
+    std::string name;
+    void (*function)(BenchmarkState&, BenchmarkData&);
+};
+
+// Run with growing iteration counts until the run lasts at least minTime
+BenchmarkState runBenchmark(const Benchmark& benchmark, BenchmarkData& data) {
+    std::uint64_t iterations = 1;
+    while (true) {
+        BenchmarkState state(iterations);
+        benchmark.function(state, data);
+        double elapsed = state.elapsedSeconds();
+        if (elapsed >= data.config.minTime || iterations >= (std::uint64_t(1) << 30)) {
+            return state;
+        }
+        // Aim 40% past the target, growing at most 10x per round
+        double scale = elapsed > 0 ? data.config.minTime * 1.4 / elapsed : 10.0;
+        iterations = std::max<std::uint64_t>(iterations + 1,
+            static_cast<std::uint64_t>(iterations * std::min(scale, 10.0)));
+    }
+}
+
+bool parseArguments(int argc, char* argv[], BenchmarkConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--csv") {
+            config.csv = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (flag == "--items") config.items = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--depth") config.depth = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--fanout") config.fanout = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--name-length") config.nameLength = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--seed") config.seed = static_cast<unsigned>(std::atoi(value.c_str()));
+        else if (flag == "--min-time") config.minTime = std::atof(value.c_str());
+        else if (flag == "--filter") config.filter = value;
+        else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkData data;
+    if (!parseArguments(argc, argv, data.config)) {
+        return 1;
+    }
+    data.random.seed(data.config.seed);
+    data.csvPath = (std::filesystem::temp_directory_path() / "warehouse_bench.csv").string();
+    generateInventory(data);
+    std::filesystem::remove(WarehouseSystem::orderLogPathFor(data.csvPath));
+    std::filesystem::remove(WarehouseSystem::stockLogPathFor(data.csvPath));
+    std::filesystem::remove(WarehouseSystem::locationsPathFor(data.csvPath));
+    data.system = std::make_unique<WarehouseSystem>(data.csvPath);
+    data.system->setAutoSave(false);
+    Metrics::setEnabled(false);
+
+    // Benchmarks that change the inventory run after those that only read it
+    const std::vector<Benchmark> benchmarks = {
+        {"load", benchLoad},
+        {"save", benchSave},
+        {"find_item", benchFindItem},
+        {"search_prefix", benchSearch<SearchQuery::Prefix>},
+        {"search_substring", benchSearch<SearchQuery::Substring>},
+        {"search_typo", benchSearch<SearchQuery::Typo>},
+        {"query_scan", benchQuery<QueryShape::Scan>},
+        {"query_category", benchQuery<QueryShape::Category>},
+        {"query_name_prefix", benchQuery<QueryShape::NamePrefix>},
+        {"query_price_range", benchQuery<QueryShape::PriceRange>},
+        {"query_low_quantity", benchQuery<QueryShape::LowQuantity>},
+        {"category_query", benchCategoryQuery},
+        {"aggregate_stock", benchAggregateStock<0>},
+        {"aggregate_stock_1t", benchAggregateStock<1>},
+        {"stock_totals", benchStockTotals},
+        {"record_demand", benchRecordDemand},
+        {"recommend_reorders", benchRecommendReorders<0>},
+        {"recommend_reorders_1t", benchRecommendReorders<1>},
+        {"low_stock_scan", benchLowStockScan},
+        {"sort_by_name", benchSortByName},
+        {"sort_by_quantity", benchSortByQuantity},
+        {"create_order", benchCreateOrder},
+        {"process_order", benchProcessOrder},
+        {"receive_stock", benchReceiveStock},
+        {"pick_nearest", benchPickFromBins<AllocationPolicy::Nearest>},
+        {"pick_fifo_lot", benchPickFromBins<AllocationPolicy::FifoLot>},
+        {"pick_fewest", benchPickFromBins<AllocationPolicy::FewestPicks>},
+        {"order_lines_1", benchMultiLineOrder<1>},
+        {"order_lines_10", benchMultiLineOrder<10>},
+        {"order_lines_100", benchMultiLineOrder<100>},
+        {"display_history", benchDisplayHistory},
+    };
+
+    if (data.config.csv) {
+        std::cout << "name,iterations,ns_per_iteration,items_per_second\n";
+    } else {
+        std::cout << "Items: " << data.config.items << ", categories: " << data.categories.size()
+                  << " (depth " << data.config.depth << ", fanout " << data.config.fanout
+                  << "), name length: " << data.config.nameLength << "\n";
+        std::cout << std::left << std::setw(20) << "Benchmark" << std::right
+                  << std::setw(14) << "Iterations" << std::setw(18) << "Time/iter (ns)"
+                  << std::setw(18) << "Items/s" << "\n";
+        std::cout << std::string(70, '-') << "\n";
+    }
+
+    for (const auto& benchmark : benchmarks) {
+        if (!data.config.filter.empty() && benchmark.name.find(data.config.filter) == std::string::npos) {
+            continue;
+        }
+        auto state = runBenchmark(benchmark, data);
+        double nanosPerIteration = state.elapsedSeconds() * 1e9 / state.getIterations();
+        double itemsPerSecond = nanosPerIteration > 0
+            ? state.getItemsProcessed() * 1e9 / nanosPerIteration : 0.0;
+        if (data.config.csv) {
+            std::cout << benchmark.name << "," << state.getIterations() << ","
+                      << std::fixed << std::setprecision(1) << nanosPerIteration << ","
+                      << std::setprecision(0) << itemsPerSecond << "\n";
+        } else {
+            std::cout << std::left << std::setw(20) << benchmark.name << std::right
+                      << std::setw(14) << state.getIterations()
+                      << std::setw(18) << std::fixed << std::setprecision(1) << nanosPerIteration
+                      << std::setw(18) << std::setprecision(0) << itemsPerSecond << "\n";
+        }
+    }
+
+    data.system.reset();
+    std::remove(data.csvPath.c_str());
+    std::remove(WarehouseSystem::orderLogPathFor(data.csvPath).c_str());
+    std::remove(WarehouseSystem::stockLogPathFor(data.csvPath).c_str());
+    std::remove(WarehouseSystem::locationsPathFor(data.csvPath).c_str());
+    return 0;
+}
@@ -0,0 +1,668 @@
+#include "commands.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+const std::vector<CommandSpec>& commandSpecs() {
+    static const std::vector<CommandSpec> specs = {
+        {CommandKind::Add, "add", {"name", "category", "quantity", "price", "min"}, 5, true},
+        {CommandKind::Update, "update", {"id", "name", "category", "quantity", "price", "min"}, 6, true},
+        {CommandKind::Remove, "remove", {"id"}, 1, true},
+        {CommandKind::Find, "find", {"id"}, 1, true},
+        {CommandKind::Search, "search", {"query", "limit"}, 1, true},
+        {CommandKind::Query, "query", {"filters"}, 0, true},
+        {CommandKind::Rollup, "rollup", {}, 0, true},
+        {CommandKind::CheckTotals, "checktotals", {}, 0, true},
+        {CommandKind::Reorders, "reorders", {"limit"}, 0, true},
+        {CommandKind::ApplyReorders, "applyreorders", {}, 0, true},
+        {CommandKind::Restocks, "restocks", {"limit"}, 0, true},
+        {CommandKind::IssueRestocks, "issuerestocks", {}, 0, true},
+        {CommandKind::Receive, "receive", {"item", "quantity"}, 2, true},
+        {CommandKind::Shipment, "shipment", {"lines"}, 1, true},
+        {CommandKind::Locations, "locations", {"item"}, 1, true},
+        {CommandKind::ReceiveAt, "receiveat", {"item", "location", "quantity"}, 3, true},
+        {CommandKind::MoveStock, "movestock", {"item", "from", "to", "quantity"}, 4, true},
+        {CommandKind::Policy, "policy", {"policy", "origin"}, 1, true},
+        {CommandKind::Order, "order", {"item", "quantity"}, 2, true},
+        {CommandKind::MultiOrder, "multiorder", {"lines"}, 1, true},
+        {CommandKind::Process, "process", {"count"}, 0, true},
+        {CommandKind::List, "list", {}, 0, true},
+        {CommandKind::LowStock, "lowstock", {}, 0, true},
+        {CommandKind::Category, "category", {"category"}, 1, true},
+        {CommandKind::Sort, "sort", {"key"}, 0, true},
+        {CommandKind::History, "history", {"limit"}, 0, true},
+        {CommandKind::Queue, "queue", {}, 0, true},
+        {CommandKind::Orders, "orders", {"status"}, 1, true},
+        {CommandKind::Status, "status", {"order", "status"}, 2, true},
+        {CommandKind::GetOrder, "getorder", {"order"}, 1, true},
+        {CommandKind::ItemOrders, "itemorders", {"item"}, 1, true},
+        {CommandKind::Cancel, "cancel", {"order"}, 1, true},
+        {CommandKind::Amend, "amend", {"order", "quantity", "item"}, 2, true},
+        // File and report commands depend on the machine they run on
+        {CommandKind::Save, "save", {}, 0, false},
+        {CommandKind::Import, "import", {"file"}, 1, false},
+        {CommandKind::Metrics, "metrics", {"file", "format"}, 0, false},
+    };
+    return specs;
+}
+
+const CommandSpec& commandSpec(CommandKind kind) {
+    return commandSpecs()[static_cast<std::size_t>(kind)];
+}
+
+const CommandSpec* findCommandSpec(std::string_view name) {
+    for (const auto& spec : commandSpecs()) {
+        if (spec.name == name) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+bool isCommandLine(std::string_view line) {
+    auto first = line.find_first_not_of(" \t\r");
+    return first != std::string_view::npos && line[first] != '#';
+}
+
+// Parse a flat JSON object of string, number and boolean values.
+// Returns false on malformed input; nested objects and arrays are rejected.
+static bool parseJsonObject(const std::string& text, std::map<std::string, std::string>& fields) {
+    std::size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+    };
+    auto parseString = [&](std::string& out) {
+        if (pos >= text.size() || text[pos] != '"') return false;
+        pos++;
+        out.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c == '\\') {
+                if (pos >= text.size()) return false;
+                char escaped = text[pos++];
+                switch (escaped) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case '"': case '\\': case '/': out += escaped; break;
+                    default: return false;
+                }
+            } else {
+                out += c;
+            }
+        }
+        if (pos >= text.size()) return false;
+        pos++;  // Closing quote
+        return true;
+    };
+
+    skipSpace();
+    if (pos >= text.size() || text[pos] != '{') return false;
+    pos++;
+    skipSpace();
+    if (pos < text.size() && text[pos] == '}') {
+        pos++;
+    } else {
+        while (true) {
+            std::string key, value;
+            skipSpace();
+            if (!parseString(key)) return false;
+            skipSpace();
+            if (pos >= text.size() || text[pos] != ':') return false;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '"') {
+                if (!parseString(value)) return false;
+            } else {
+                std::size_t start = pos;
+                while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+                       !std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    pos++;
+                }
+                value = text.substr(start, pos - start);
+                if (value.empty() || value[0] == '{' || value[0] == '[') return false;
+            }
+            fields[key] = value;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ',') {
+                pos++;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                break;
+            }
+            return false;
+        }
+    }
+    skipSpace();
+    return pos == text.size();
+}
+
+// A row limit or count argument, or fallback if it is absent. Returns
+// false unless it is positive.
+static bool parseCount(const std::vector<std::string>& args, std::size_t index, int fallback, int& count) {
+    count = index < args.size() ? std::stoi(args[index]) : fallback;
+    return count > 0;
+}
+
+// Fill in the typed fields of a command from its arguments, which hold at
+// least the required ones. May throw std::invalid_argument or
+// std::out_of_range for numbers that do not parse.
+static std::string parseArguments(const CommandSpec& spec, Command& command) {
+    const auto& args = command.args;
+    auto optional = [&](std::size_t index, const std::string& fallback) {
+        return index < args.size() ? args[index] : fallback;
+    };
+    auto parseLimit = [&](std::size_t index, int fallback) {
+        int limit;
+        if (!parseCount(args, index, fallback, limit)) {
+            return false;
+        }
+        command.limit = static_cast<std::size_t>(limit);
+        return true;
+    };
+    const std::string needsPositiveLimit = "limit for '" + spec.name + "' must be positive";
+
+    switch (command.kind) {
+        case CommandKind::Add:
+        case CommandKind::Update: {
+            std::size_t base = command.kind == CommandKind::Add ? 0 : 1;
+            if (args[base].find(',') != std::string::npos || args[base + 1].find(',') != std::string::npos) {
+                return "name and category must not contain commas";
+            }
+            command.id = base == 0 ? 0 : std::stoi(args[0]);
+            command.item = InventoryItem(command.id, args[base], args[base + 1], std::stoi(args[base + 2]),
+                                         std::stod(args[base + 3]), std::stoi(args[base + 4]));
+            break;
+        }
+        case CommandKind::Remove:
+        case CommandKind::Find:
+        case CommandKind::Locations:
+        case CommandKind::GetOrder:
+        case CommandKind::ItemOrders:
+        case CommandKind::Cancel:
+            command.id = std::stoi(args[0]);
+            break;
+        case CommandKind::Search:
+            command.text = args[0];
+            if (!parseLimit(1, 10)) {
+                return needsPositiveLimit;
+            }
+            break;
+        case CommandKind::Query: {
+            command.text = optional(0, "");
+            std::string error = ItemQuery::parse(command.text, command.query);
+            if (!error.empty()) {
+                return "invalid query: " + error;
+            }
+            break;
+        }
+        case CommandKind::Reorders:
+        case CommandKind::Restocks:
+            if (!parseLimit(0, 20)) {
+                return needsPositiveLimit;
+            }
+            break;
+        case CommandKind::History:
+            if (!parseLimit(0, 10)) {
+                return needsPositiveLimit;
+            }
+            break;
+        case CommandKind::Receive:
+        case CommandKind::Order:
+            command.id = std::stoi(args[0]);
+            command.quantity = std::stoi(args[1]);
+            break;
+        case CommandKind::Shipment:
+        case CommandKind::MultiOrder:
+            if (!WarehouseSystem::parseOrderLines(args[0], command.lines)) {
+                return "order lines for '" + spec.name + "' must be itemId:quantity pairs separated by spaces";
+            }
+            break;
+        case CommandKind::ReceiveAt:
+            command.id = std::stoi(args[0]);
+            command.location = args[1];
+            command.quantity = std::stoi(args[2]);
+            break;
+        case CommandKind::MoveStock:
+            command.id = std::stoi(args[0]);
+            command.location = args[1];
+            command.destination = args[2];
+            command.quantity = std::stoi(args[3]);
+            break;
+        case CommandKind::Policy:
+            if (!parseAllocationPolicy(args[0], command.policy)) {
+                return "unknown allocation policy '" + args[0] + "' (Nearest, FifoLot or FewestPicks)";
+            }
+            command.location = optional(1, "");
+            break;
+        case CommandKind::Process:
+            if (!parseCount(args, 0, 1, command.id)) {
+                return "count for 'process' must be positive";
+            }
+            break;
+        case CommandKind::Category:
+        case CommandKind::Import:
+            command.text = args[0];
+            break;
+        case CommandKind::Sort:
+            command.text = optional(0, "name");
+            if (command.text != "name" && command.text != "quantity") {
+                return "sort key must be 'name' or 'quantity'";
+            }
+            break;
+        case CommandKind::Orders:
+        case CommandKind::Status:
+            if (!parseOrderStatus(args.back(), command.status)) {
+                return "unknown order status '" + args.back() + "'";
+            }
+            command.id = command.kind == CommandKind::Status ? std::stoi(args[0]) : 0;
+            break;
+        case CommandKind::Amend:
+            command.id = std::stoi(args[0]);
+            command.quantity = std::stoi(args[1]);
+            command.itemId = args.size() > 2 ? std::stoi(args[2]) : 0;
+            break;
+        case CommandKind::Metrics:
+            command.text = optional(0, "");
+            command.destination = optional(1, "text");
+            if (command.destination != "text" && command.destination != "prometheus") {
+                return "unknown metrics format '" + command.destination + "'";
+            }
+            break;
+        case CommandKind::Rollup:
+        case CommandKind::CheckTotals:
+        case CommandKind::ApplyReorders:
+        case CommandKind::IssueRestocks:
+        case CommandKind::List:
+        case CommandKind::LowStock:
+        case CommandKind::Queue:
+        case CommandKind::Save:
+        case CommandKind::Count:
+            break;
+    }
+    return "";
+}
+
+std::string parseCommand(const std::string& line, Command& command) {
+    command = Command();
+    auto first = line.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "empty command";
+    }
+
+    std::string name;
+    const CommandSpec* spec;
+    if (line[first] == '{') {
+        std::map<std::string, std::string> fields;
+        if (!parseJsonObject(line, fields)) {
+            return "malformed JSON";
+        }
+        name = fields["cmd"];
+        spec = findCommandSpec(name);
+        if (!spec) {
+            return "unknown command '" + name + "'";
+        }
+        for (const auto& field : spec->fields) {
+            auto it = fields.find(field);
+            if (it == fields.end()) {
+                break;
+            }
+            command.args.push_back(it->second);
+        }
+    } else {
+        std::stringstream ss(line.substr(first));
+        std::string token;
+        std::getline(ss, name, ',');
+        while (std::getline(ss, token, ',')) {
+            command.args.push_back(token);
+        }
+        spec = findCommandSpec(name);
+        if (!spec) {
+            return "unknown command '" + name + "'";
+        }
+        if (command.args.size() > spec->fields.size()) {
+            return "too many arguments for '" + name + "'";
+        }
+    }
+    if (command.args.size() < spec->required) {
+        return "missing arguments for '" + name + "'";
+    }
+
+    command.kind = spec->kind;
+    try {
+        return parseArguments(*spec, command);
+    } catch (const std::exception&) {
+        return "invalid argument for '" + name + "'";
+    }
+}
+
+CommandResult executeCommand(WarehouseSystem& system, const Command& command) {
+    CommandResult result;
+    auto reject = [&result]() { result.status = CommandStatus::Rejected; };
+    auto notFound = [&result]() { result.status = CommandStatus::NotFound; };
+
+    switch (command.kind) {
+        case CommandKind::Add: {
+            InventoryItem item = command.item;
+            item.setId(system.getNextId());
+            if (!WarehouseSystem::isValidItem(item)) {
+                std::cout << "Invalid item!\n";
+                reject();
+                break;
+            }
+            system.addItem(item);
+            std::cout << "Added item " << item.getId() << "\n";
+            result.observe(static_cast<std::uint64_t>(item.getId()));
+            break;
+        }
+        case CommandKind::Update: {
+            if (!WarehouseSystem::isValidItem(command.item)) {
+                std::cout << "Invalid item!\n";
+                reject();
+                break;
+            }
+            bool updated = system.updateItem(command.item);
+            if (updated) {
+                std::cout << "Updated item " << command.id << "\n";
+            } else {
+                std::cout << "Item " << command.id << " not found\n";
+                notFound();
+            }
+            result.observe(updated);
+            break;
+        }
+        case CommandKind::Remove: {
+            bool removed = system.removeItem(command.id);
+            if (removed) {
+                std::cout << "Removed item " << command.id << "\n";
+            } else {
+                std::cout << "Item " << command.id << " not found\n";
+                notFound();
+            }
+            result.observe(removed);
+            break;
+        }
+        case CommandKind::Find: {
+            auto item = system.findItem(command.id);
+            if (!item) {
+                std::cout << "Item " << command.id << " not found\n";
+                result.observe(~0ull);
+                notFound();
+                break;
+            }
+            std::ostringstream price;
+            price << std::fixed << std::setprecision(2) << item->getPrice();
+            std::cout << item->getId() << "," << item->getName() << "," << item->getCategory() << ","
+                      << item->getQuantity() << "," << price.str() << "," << item->getMinStockLevel() << "\n";
+            result.observe(static_cast<std::uint64_t>(item->getQuantity()));
+            break;
+        }
+        case CommandKind::Search: {
+            auto matches = system.searchItems(command.text, command.limit);
+            result.observe(matches.size());
+            result.observe(matches.empty() ? 0ull : static_cast<std::uint64_t>(matches[0].itemId));
+            system.displaySearchResults(command.text, matches);
+            break;
+        }
+        case CommandKind::Query: {
+            auto found = system.queryItems(command.query);
+            result.observe(found.matched);
+            result.observe(found.items.empty() ? 0ull : static_cast<std::uint64_t>(found.items[0].getId()));
+            system.displayQueryResults(found);
+            break;
+        }
+        case CommandKind::Rollup: {
+            auto report = system.getStockReport();
+            result.observe(report.total.items);
+            result.observe(static_cast<std::uint64_t>(report.total.quantity));
+            result.observe(report.total.lowStock);
+            result.observe(report.categories.size());
+            system.displayStockReport(report);
+            break;
+        }
+        case CommandKind::CheckTotals: {
+            auto drift = system.verifyStockTotals();
+            result.observe(drift.mismatchedCounts);
+            displayStockDrift(drift);
+            break;
+        }
+        case CommandKind::Reorders:
+            system.displayReorderRecommendations(command.limit);
+            break;
+        case CommandKind::ApplyReorders: {
+            std::size_t changed = system.applyReorderPoints();
+            std::cout << "Set reorder points of " << changed << " items\n";
+            result.observe(changed);
+            break;
+        }
+        case CommandKind::Restocks:
+            system.displayRestockOrders(command.limit);
+            break;
+        case CommandKind::IssueRestocks: {
+            std::size_t issued = system.issueRestockOrders();
+            std::cout << "Issued " << issued << " restock orders\n";
+            result.observe(issued);
+            break;
+        }
+        case CommandKind::Receive:
+        case CommandKind::Shipment:
+        case CommandKind::ReceiveAt: {
+            WarehouseSystem::ReceiveResult received;
+            if (command.kind == CommandKind::ReceiveAt) {
+                received = system.receiveStockAt(command.id, command.location, command.quantity);
+            } else {
+                std::vector<RestockLine> lines;
+                if (command.kind == CommandKind::Receive) {
+                    lines.push_back({command.id, command.quantity});
+                }
+                for (const auto& line : command.lines) {
+                    lines.push_back({line.getItemId(), line.getQuantity()});
+                }
+                received = system.receiveShipment(lines);
+            }
+            result.observe(received.received);
+            result.observe(received.ordersReserved);
+            if (!displayReceiveResult(received)) reject();
+            break;
+        }
+        case CommandKind::Locations:
+            system.displayItemLocations(command.id);
+            break;
+        case CommandKind::MoveStock: {
+            bool moved = system.moveStock(command.id, command.location, command.destination, command.quantity);
+            result.observe(moved);
+            if (!displayMoveResult(moved)) reject();
+            break;
+        }
+        case CommandKind::Policy: {
+            bool changed = setAllocationPolicy(system, command.policy, command.location);
+            result.observe(changed);
+            if (!changed) reject();
+            break;
+        }
+        case CommandKind::Order:
+        case CommandKind::MultiOrder: {
+            std::vector<OrderLine> single{OrderLine(command.id, command.quantity)};
+            const auto& lines = command.kind == CommandKind::Order ? single : command.lines;
+            int orderId = command.kind == CommandKind::Order ? system.createOrder(command.id, command.quantity)
+                                                             : system.createOrder(lines);
+            if (!orderId) {
+                // An unknown item is a lookup miss; anything else is bad input
+                bool missing = std::any_of(lines.begin(), lines.end(), [&system](const OrderLine& line) {
+                    return !system.findItem(line.getItemId());
+                });
+                missing ? notFound() : reject();
+            }
+            result.observe(system.getPendingOrderCount());
+            break;
+        }
+        case CommandKind::Process:
+            for (int i = 0; i < command.id; i++) {
+                if (system.processNextOrder() == WarehouseSystem::OrderResult::NoOrders) {
+                    break;
+                }
+            }
+            result.observe(system.getPendingOrderCount());
+            break;
+        case CommandKind::List:
+            system.displayAllItems();
+            break;
+        case CommandKind::LowStock:
+            system.displayLowStockItems();
+            break;
+        case CommandKind::Category:
+            system.displayByCategory(command.text);
+            break;
+        case CommandKind::Sort:
+            if (command.text == "quantity") {
+                system.sortByQuantity();
+            } else {
+                system.sortByName();
+            }
+            break;
+        case CommandKind::History:
+            system.displayTransactionHistory(static_cast<int>(command.limit));
+            break;
+        case CommandKind::Queue:
+            system.displayOrderQueue();
+            break;
+        case CommandKind::Orders:
+            system.displayOrdersByStatus(command.status);
+            break;
+        case CommandKind::Status: {
+            bool changed = system.setOrderStatus(command.id, command.status);
+            if (changed) {
+                std::cout << "Order " << command.id << " is now " << orderStatusName(command.status) << "\n";
+            } else {
+                std::cout << "Cannot move order " << command.id << " to " << orderStatusName(command.status) << "\n";
+                reject();
+            }
+            result.observe(changed);
+            break;
+        }
+        case CommandKind::GetOrder: {
+            auto order = system.findOrder(command.id);
+            if (!order) {
+                std::cout << "Order " << command.id << " not found\n";
+                result.observe(~0ull);
+                notFound();
+                break;
+            }
+            system.displayOrder(*order);
+            result.observe(static_cast<std::uint64_t>(order->getStatus()));
+            break;
+        }
+        case CommandKind::ItemOrders:
+            system.displayItemOrders(command.id);
+            break;
+        case CommandKind::Cancel: {
+            bool cancelled = system.cancelOrder(command.id);
+            std::cout << (cancelled ? "Cancelled order " : "Cannot cancel order ") << command.id << "\n";
+            result.observe(cancelled);
+            if (!cancelled) notFound();
+            break;
+        }
+        case CommandKind::Amend: {
+            bool amended = command.itemId != 0 ? system.amendOrder(command.id, command.itemId, command.quantity)
+                                               : system.amendOrder(command.id, command.quantity);
+            std::cout << (amended ? "Amended order " : "Cannot amend order ") << command.id << "\n";
+            result.observe(amended);
+            if (!amended) notFound();
+            break;
+        }
+        case CommandKind::Save:
+            system.save();
+            break;
+        case CommandKind::Import:
+            if (!importItems(system, command.text)) reject();
+            break;
+        case CommandKind::Metrics:
+            if (command.text.empty()) {
+                Metrics::writeText(std::cout);
+            } else if (!dumpMetrics(command.text, command.destination)) {
+                reject();
+            }
+            break;
+        case CommandKind::Count:
+            reject();
+            break;
+    }
+    return result;
+}
+
+void displayStockDrift(const StockDrift& drift) {
+    if (drift.mismatchedCounts == 0) {
+        std::cout << "Running stock totals match a recount";
+    } else {
+        std::cout << "Corrected " << drift.mismatchedCounts << " running stock totals";
+    }
+    std::ostringstream error;
+    error << std::setprecision(3) << drift.maxValueError;
+    std::cout << " (stock value off by at most " << error.str() << ")\n";
+}
+
+bool displayReceiveResult(const WarehouseSystem::ReceiveResult& result) {
+    if (!result.received) {
+        std::cout << "Stock not received: unknown item or invalid quantity\n";
+        return false;
+    }
+    std::cout << "Stock received";
+    if (result.ordersReserved > 0) {
+        std::cout << ", " << result.ordersReserved << " backorders reserved";
+    }
+    std::cout << "\n";
+    return true;
+}
+
+bool displayMoveResult(bool moved) {
+    std::cout << (moved ? "Stock moved\n" : "Stock not moved: not enough stock there or invalid location\n");
+    return moved;
+}
+
+bool setAllocationPolicy(WarehouseSystem& system, AllocationPolicy policy, const std::string& origin) {
+    if (!system.setAllocationPolicy(policy, origin)) {
+        std::cout << "Unknown location '" << origin << "'\n";
+        return false;
+    }
+    std::cout << "Orders now pick by " << allocationPolicyName(policy) << "\n";
+    return true;
+}
+
+bool importItems(WarehouseSystem& system, const std::string& path) {
+    WarehouseSystem::BulkUpsertResult result;
+    std::size_t malformedRows;
+    if (!system.importFromFile(path, result, malformedRows)) {
+        std::cout << "Cannot open import file: " << path << "\n";
+        return false;
+    }
+    std::cout << "Imported " << result.added << " new and " << result.updated
+              << " updated items (" << result.rejectedIds.size() << " invalid, "
+              << malformedRows << " malformed rows skipped)\n";
+    return result.rejectedIds.empty() && malformedRows == 0;
+}
+
+bool dumpMetrics(const std::string& path, const std::string& format) {
+    if (format != "text" && format != "prometheus") {
+        std::cout << "Unknown metrics format: " << format << "\n";
+        return false;
+    }
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "Cannot write metrics file: " << path << "\n";
+        return false;
+    }
+    if (format == "text") {
+        Metrics::writeText(file);
+    } else {
+        Metrics::writePrometheus(file);
+    }
+    std::cout << "Metrics written to " << path << "\n";
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "warehouse.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Batch commands
+//
+// The commands of the CLI's batch mode, which are also what it records
+// with --record and what the replay tool runs. Commands are read one per
+// line, either comma-separated
+//     add,Rice,Pantry,8,65.00,2
+// or as JSON objects with named fields
+//     {"cmd": "order", "item": 1, "quantity": 3}
+// A line is parsed once into a Command, which can then be run any number
+// of times.
+
+enum class CommandKind {
+    Add, Update, Remove, Find, Search, Query, Rollup, CheckTotals, Reorders, ApplyReorders,
+    Restocks, IssueRestocks, Receive, Shipment, Locations, ReceiveAt, MoveStock, Policy,
+    Order, MultiOrder, Process, List, LowStock, Category, Sort, History, Queue, Orders,
+    Status, GetOrder, ItemOrders, Cancel, Amend, Save, Import, Metrics,
+    Count
+};
+
+constexpr std::size_t kCommandKindCount = static_cast<std::size_t>(CommandKind::Count);
+
+struct CommandSpec {
+    CommandKind kind;
+    std::string name;
+    std::vector<std::string> fields;  // Argument names, in positional order
+    std::size_t required;             // Leading fields that must be present
+    bool recorded;                    // Written to the trace, so it can be replayed
+};
+
+// Every command, in CommandKind order
+const std::vector<CommandSpec>& commandSpecs();
+const CommandSpec& commandSpec(CommandKind kind);
+const CommandSpec* findCommandSpec(std::string_view name);
+
+struct Command {
+    CommandKind kind = CommandKind::List;
+    std::vector<std::string> args;  // As written, in positional order
+    int id = 0;                     // Item or order ID, or the process count
+    int quantity = 0;
+    int itemId = 0;                 // Line to amend, or 0 for a single-line order
+    std::size_t limit = 0;          // Rows for search, reorders, restocks and history
+    std::string text;               // Category, search text, sort key or file
+    std::string location;           // Bin for receiveat, source for movestock, origin for policy
+    std::string destination;        // Bin for movestock, or the metrics format
+    OrderStatus status = OrderStatus::Pending;
+    AllocationPolicy policy = AllocationPolicy::Nearest;
+    InventoryItem item;             // Fields for add and update
+    ItemQuery query;                // Filters for query
+    std::vector<OrderLine> lines;   // For multiorder and shipment
+};
+
+// Whether a line holds a command rather than being blank or a '#' comment
+bool isCommandLine(std::string_view line);
+
+// Parse one command line. Returns an error message, or an empty string on
+// success.
+std::string parseCommand(const std::string& line, Command& command);
+
+enum class CommandStatus {
+    Done,
+    NotFound,  // The item or order looked up is missing; still part of the workload
+    Rejected,  // Invalid input or an impossible change
+};
+
+struct CommandResult {
+    CommandStatus status = CommandStatus::Done;
+    // Values the command read or changed, so replays can check they agree
+    std::array<std::uint64_t, 4> observed{};
+    std::size_t observedCount = 0;
+
+    bool succeeded() const { return status == CommandStatus::Done; }
+    void observe(std::uint64_t value) { observed[observedCount++] = value; }
+};
+
+// Run a command against the system, printing its outcome to std::cout
+CommandResult executeCommand(WarehouseSystem& system, const Command& command);
+
+// Outcome messages, shared with the interactive menu
+
+void displayStockDrift(const StockDrift& drift);
+bool displayReceiveResult(const WarehouseSystem::ReceiveResult& result);
+bool displayMoveResult(bool moved);
+bool setAllocationPolicy(WarehouseSystem& system, AllocationPolicy policy, const std::string& origin);
+
+// Bulk-load a CSV file in the inventory file format and report the outcome
+bool importItems(WarehouseSystem& system, const std::string& path);
+
+// Write the collected metrics to a file as "text" or "prometheus"
+bool dumpMetrics(const std::string& path, const std::string& format);
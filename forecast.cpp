@@ -0,0 +1,134 @@
+#include "forecast.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+void DemandForecaster::advance(Demand& demand, std::int32_t day) const {
+    if (day <= demand.day) {
+        return;
+    }
+    double alpha = settings.smoothing;
+    double finished = std::max(demand.pending, 0.0);
+    if (demand.foldedDays == 0) {
+        demand.level = finished;
+        demand.variance = 0;
+    } else {
+        double error = finished - demand.level;
+        demand.level += alpha * error;
+        demand.variance = (1 - alpha) * (demand.variance + alpha * error * error);
+    }
+
+    // Folding k days without demand, one at a time, shrinks the level by
+    // (1 - alpha) each day and adds its square to the variance as error:
+    //     level' = d * level,  variance' = d * (variance + level^2 * (1 - d))
+    // with d = (1 - alpha)^k
+    std::int64_t quiet = static_cast<std::int64_t>(day) - demand.day - 1;
+    if (quiet > 0) {
+        double decay = std::pow(1 - alpha, static_cast<double>(quiet));
+        demand.variance = decay * (demand.variance + demand.level * demand.level * (1 - decay));
+        demand.level *= decay;
+    }
+    std::int64_t folded = static_cast<std::int64_t>(demand.foldedDays) + quiet + 1;
+    demand.foldedDays = static_cast<std::uint32_t>(
+        std::min<std::int64_t>(folded, std::numeric_limits<std::uint32_t>::max()));
+    demand.day = day;
+    demand.pending = 0;
+}
+
+void DemandForecaster::recordDemand(int itemId, double units, std::time_t when) {
+    std::int32_t day = dayOf(when);
+    auto [entry, added] = slotOf.try_emplace(itemId, static_cast<std::uint32_t>(demands.size()));
+    if (added) {
+        demands.push_back(Demand{itemId, day, 0, units, 0, 0});
+        return;
+    }
+    Demand& demand = demands[entry->second];
+    advance(demand, day);
+    demand.pending += units;
+}
+
+void DemandForecaster::erase(int itemId) {
+    auto entry = slotOf.find(itemId);
+    if (entry == slotOf.end()) {
+        return;
+    }
+    // Move the last record into the hole
+    std::uint32_t slot = entry->second;
+    slotOf.erase(entry);
+    if (slot + 1 != demands.size()) {
+        demands[slot] = demands.back();
+        slotOf[demands[slot].itemId] = slot;
+    }
+    demands.pop_back();
+}
+
+void DemandForecaster::clear() {
+    demands.clear();
+    slotOf.clear();
+}
+
+void DemandForecaster::recommend(const Demand& demand, std::int32_t today,
+                                 ReorderRecommendation& result) const {
+    Demand current = demand;
+    advance(current, today);
+    if (current.foldedDays == 0) {
+        current.level = std::max(current.pending, 0.0);
+        current.variance = 0;
+    }
+
+    // Round up, but not for the rounding error of a whole number
+    auto units = [](double value) {
+        double rounded = std::ceil(value - 1e-9);
+        return static_cast<int>(std::clamp(rounded, 0.0, static_cast<double>(std::numeric_limits<int>::max())));
+    };
+    double leadTime = std::max(settings.leadTimeDays, 0.0);
+    result.itemId = current.itemId;
+    result.dailyDemand = current.level;
+    result.deviation = std::sqrt(std::max(current.variance, 0.0));
+    result.reorderPoint = units(current.level * leadTime +
+                                settings.serviceFactor * result.deviation * std::sqrt(leadTime));
+    result.reorderQuantity = units(current.level * std::max(settings.coverDays, 0.0));
+}
+
+bool DemandForecaster::recommend(int itemId, std::time_t now, ReorderRecommendation& result) const {
+    auto entry = slotOf.find(itemId);
+    if (entry == slotOf.end()) {
+        return false;
+    }
+    recommend(demands[entry->second], dayOf(now), result);
+    return true;
+}
+
+std::vector<ReorderRecommendation> DemandForecaster::recommendAll(std::time_t now,
+                                                                  unsigned threadCount) const {
+    // Below this many items per thread, starting a thread costs more than it saves
+    constexpr std::size_t kMinItemsPerThread = 1 << 15;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(
+        std::clamp<std::size_t>(demands.size() / kMinItemsPerThread, 1, threadCount));
+
+    // Each thread fills a contiguous slice of the result
+    std::vector<ReorderRecommendation> result(demands.size());
+    std::int32_t today = dayOf(now);
+    auto fill = [this, &result, today](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            recommend(demands[i], today, result[i]);
+        }
+    };
+    auto slice = [this, threadCount](unsigned index) {
+        return demands.size() * index / threadCount;
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back([&fill, &slice, i]() { fill(slice(i), slice(i + 1)); });
+    }
+    fill(0, slice(1));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return result;
+}
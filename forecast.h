@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+// How demand forecasts become reorder points
+struct ForecastSettings {
+    double smoothing = 0.2;        // Weight of each new day in the smoothed daily demand, in (0, 1]
+    double leadTimeDays = 7;       // Days from placing a restock order to receiving it
+    double coverDays = 14;         // Days of demand one restock order should cover
+    double serviceFactor = 1.65;   // Safety stock in standard deviations of lead-time demand
+};
+
+// Reorder point and quantity suggested for one item
+struct ReorderRecommendation {
+    int itemId = 0;
+    double dailyDemand = 0;   // Smoothed units per day
+    double deviation = 0;     // Standard deviation of daily demand
+    int reorderPoint = 0;     // Restock once stock falls to this level
+    int reorderQuantity = 0;  // Units to order when it does
+};
+
+// Daily demand of every item, smoothed exponentially. Demand is counted
+// into the item's current day; once demand arrives on a later day, the
+// finished day and the quiet days after it are folded into the smoothed
+// level and variance in closed form, so recording demand is O(1) however
+// long the item was idle. Each item's state is one small record, touched
+// once per event, and the records sit in one array that the batch pass
+// splits between threads.
+//
+// The reorder point covers the expected demand over the lead time plus
+// serviceFactor standard deviations of it; the reorder quantity covers
+// coverDays of expected demand.
+class DemandForecaster {
+private:
+    struct Demand {
+        int itemId;
+        std::int32_t day;         // Day the pending demand falls on
+        std::uint32_t foldedDays; // Days folded into level and variance
+        double pending;           // Demand so far on that day
+        double level;             // Smoothed daily demand
+        double variance;          // Smoothed squared error of the daily demand
+    };
+
+    ForecastSettings settings;
+    std::vector<Demand> demands;
+    std::unordered_map<int, std::uint32_t> slotOf;  // Item ID -> index in demands
+
+    static std::int32_t dayOf(std::time_t time) {
+        return static_cast<std::int32_t>(time >= 0 ? time / 86400 : (time - 86399) / 86400);
+    }
+    // Advance an item's state to day, folding in its pending demand and the
+    // quiet days in between
+    void advance(Demand& demand, std::int32_t day) const;
+    void recommend(const Demand& demand, std::int32_t today, ReorderRecommendation& result) const;
+
+public:
+    explicit DemandForecaster(const ForecastSettings& settings = {}) : settings(settings) {}
+
+    // New settings apply to days folded from now on
+    const ForecastSettings& getSettings() const { return settings; }
+    void setSettings(const ForecastSettings& newSettings) { settings = newSettings; }
+
+    // Count units taken from stock for an item at time when. Returned
+    // stock is negative demand and offsets the demand of its day. Demand
+    // dated before the item's current day counts towards the current day.
+    void recordDemand(int itemId, double units, std::time_t when);
+
+    void erase(int itemId);
+    void clear();
+    std::size_t size() const { return demands.size(); }
+
+    // Recommendation for one item as of now. Only finished days count,
+    // except for an item with no finished day yet, whose demand so far
+    // stands in for its daily demand. Returns false if no demand was ever
+    // recorded for the item.
+    bool recommend(int itemId, std::time_t now, ReorderRecommendation& result) const;
+
+    // Recommendations for every item with recorded demand, in no
+    // particular order. The items are split between up to threadCount
+    // threads (0 for one per hardware thread); small sets are handled on
+    // the calling thread.
+    std::vector<ReorderRecommendation> recommendAll(std::time_t now, unsigned threadCount = 0) const;
+};
@@ -0,0 +1,235 @@
+#include "location.h"
+
+#include <algorithm>
+#include <iterator>
+
+bool LocationStock::isValidPath(std::string_view path) {
+    std::size_t parts = 1;
+    std::size_t partLength = 0;
+    for (char c : path) {
+        if (c == '/') {
+            if (partLength == 0) {
+                return false;
+            }
+            parts++;
+            partLength = 0;
+        } else if (c == ',' || std::iscntrl(static_cast<unsigned char>(c))) {
+            return false;
+        } else {
+            partLength++;
+        }
+    }
+    return parts == 3 && partLength > 0;
+}
+
+LocationId LocationStock::intern(std::string_view path) {
+    if (!isValidPath(path)) {
+        return kNoLocation;
+    }
+    auto [entry, added] = locationOf.try_emplace(std::string(path), static_cast<LocationId>(places.size()));
+    if (!added) {
+        return entry->second;
+    }
+    std::string_view zonePath = path.substr(0, path.rfind('/'));
+    std::string_view warehouse = path.substr(0, path.find('/'));
+    auto [warehouseEntry, newWarehouse] =
+        warehouseOf.try_emplace(std::string(warehouse), static_cast<std::uint32_t>(warehouses.size()));
+    if (newWarehouse) {
+        warehouses.emplace_back(warehouse);
+        warehouseTotals.push_back(0);
+    }
+    auto [zoneEntry, newZone] =
+        zoneOf.try_emplace(std::string(zonePath), static_cast<std::uint32_t>(zoneTotals.size()));
+    if (newZone) {
+        zoneTotals.push_back(0);
+    }
+    places.push_back({std::string(path), warehouseEntry->second, zoneEntry->second});
+    locationTotals.push_back(0);
+    return entry->second;
+}
+
+LocationId LocationStock::find(std::string_view path) const {
+    auto entry = locationOf.find(std::string(path));
+    return entry != locationOf.end() ? entry->second : kNoLocation;
+}
+
+int LocationStock::getQuantity(int itemId, LocationId location) const {
+    auto slot = slotOf.find(slotKey(itemId, location));
+    return slot != slotOf.end() ? items.find(itemId)->second.bins[slot->second].quantity : 0;
+}
+
+int LocationStock::getItemTotal(int itemId) const {
+    auto entry = items.find(itemId);
+    return entry != items.end() ? entry->second.total : 0;
+}
+
+long long LocationStock::getZoneTotal(std::string_view zone) const {
+    auto entry = zoneOf.find(std::string(zone));
+    return entry != zoneOf.end() ? zoneTotals[entry->second] : 0;
+}
+
+long long LocationStock::getWarehouseTotal(std::string_view warehouse) const {
+    auto entry = warehouseOf.find(std::string(warehouse));
+    return entry != warehouseOf.end() ? warehouseTotals[entry->second] : 0;
+}
+
+std::span<const BinStock> LocationStock::getBins(int itemId) const {
+    auto entry = items.find(itemId);
+    return entry != items.end() ? std::span<const BinStock>(entry->second.bins) : std::span<const BinStock>();
+}
+
+void LocationStock::change(ItemBins& entry, BinStock& bin, int delta) {
+    const Place& place = places[bin.location];
+    bin.quantity += delta;
+    entry.total += delta;
+    locationTotals[bin.location] += delta;
+    zoneTotals[place.zone] += delta;
+    warehouseTotals[place.warehouse] += delta;
+    total += delta;
+}
+
+void LocationStock::dropBin(int itemId, ItemBins& entry, std::uint32_t slot) {
+    slotOf.erase(slotKey(itemId, entry.bins[slot].location));
+    if (slot + 1 != entry.bins.size()) {
+        entry.bins[slot] = entry.bins.back();
+        slotOf[slotKey(itemId, entry.bins[slot].location)] = slot;
+    }
+    entry.bins.pop_back();
+}
+
+void LocationStock::add(int itemId, LocationId location, int quantity, std::uint64_t lot) {
+    if (quantity <= 0 || !isLocation(location)) {
+        return;
+    }
+    if (lot == 0) {
+        lot = nextLot++;
+    } else {
+        noteLot(lot);
+    }
+    ItemBins& entry = items[itemId];
+    auto [slot, added] = slotOf.try_emplace(slotKey(itemId, location),
+                                            static_cast<std::uint32_t>(entry.bins.size()));
+    if (added) {
+        entry.bins.push_back({location, 0, lot});
+    }
+    BinStock& bin = entry.bins[slot->second];
+    bin.lot = std::min(bin.lot, lot);
+    change(entry, bin, quantity);
+}
+
+int LocationStock::distance(LocationId from, LocationId to) const {
+    if (from == to) {
+        return 0;
+    }
+    if (!isLocation(from)) {
+        return 3;
+    }
+    if (places[from].zone == places[to].zone) {
+        return 1;
+    }
+    return places[from].warehouse == places[to].warehouse ? 2 : 3;
+}
+
+int LocationStock::take(int itemId, int quantity, AllocationPolicy policy, LocationId origin,
+                        std::vector<Pick>& picks) {
+    auto entry = items.find(itemId);
+    if (entry == items.end() || quantity <= 0) {
+        return 0;
+    }
+    auto& bins = entry->second.bins;
+
+    // Rank the bins; an item rarely sits in more than a handful
+    std::vector<BinStock> order(bins.begin(), bins.end());
+    switch (policy) {
+        case AllocationPolicy::Nearest:
+            std::sort(order.begin(), order.end(), [this, origin](const BinStock& a, const BinStock& b) {
+                int da = distance(origin, a.location);
+                int db = distance(origin, b.location);
+                return da != db ? da < db : a.location < b.location;
+            });
+            break;
+        case AllocationPolicy::FifoLot:
+            std::sort(order.begin(), order.end(), [](const BinStock& a, const BinStock& b) {
+                return a.lot != b.lot ? a.lot < b.lot : a.location < b.location;
+            });
+            break;
+        case AllocationPolicy::FewestPicks: {
+            std::sort(order.begin(), order.end(), [](const BinStock& a, const BinStock& b) {
+                return a.quantity != b.quantity ? a.quantity > b.quantity : a.location < b.location;
+            });
+            // The smallest bin that covers the quantity on its own goes first
+            auto covering = std::find_if(order.rbegin(), order.rend(), [quantity](const BinStock& bin) {
+                return bin.quantity >= quantity;
+            });
+            if (covering != order.rend()) {
+                std::rotate(order.begin(), std::prev(covering.base()), covering.base());
+            }
+            break;
+        }
+        case AllocationPolicy::Count:
+            break;
+    }
+
+    int taken = 0;
+    for (const auto& ranked : order) {
+        if (taken == quantity) {
+            break;
+        }
+        std::uint32_t slot = slotOf.find(slotKey(itemId, ranked.location))->second;
+        BinStock& bin = bins[slot];
+        int units = std::min(bin.quantity, quantity - taken);
+        picks.push_back({itemId, bin.location, units, bin.lot});
+        change(entry->second, bin, -units);
+        taken += units;
+        if (bin.quantity == 0) {
+            dropBin(itemId, entry->second, slot);
+        }
+    }
+    if (bins.empty()) {
+        items.erase(entry);
+    }
+    return taken;
+}
+
+bool LocationStock::move(int itemId, LocationId from, LocationId to, int quantity) {
+    auto slot = slotOf.find(slotKey(itemId, from));
+    if (slot == slotOf.end() || !isLocation(to) || quantity <= 0) {
+        return false;
+    }
+    ItemBins& entry = items.find(itemId)->second;
+    BinStock& bin = entry.bins[slot->second];
+    if (bin.quantity < quantity) {
+        return false;
+    }
+    if (from == to) {
+        return true;
+    }
+    std::uint64_t lot = bin.lot;
+    change(entry, bin, -quantity);
+    if (bin.quantity == 0) {
+        dropBin(itemId, entry, slot->second);
+    }
+    add(itemId, to, quantity, lot);
+    return true;
+}
+
+void LocationStock::erase(int itemId) {
+    auto entry = items.find(itemId);
+    if (entry == items.end()) {
+        return;
+    }
+    for (auto& bin : entry->second.bins) {
+        slotOf.erase(slotKey(itemId, bin.location));
+        change(entry->second, bin, -bin.quantity);
+    }
+    items.erase(entry);
+}
+
+void LocationStock::clear() {
+    items.clear();
+    slotOf.clear();
+    std::fill(locationTotals.begin(), locationTotals.end(), 0);
+    std::fill(zoneTotals.begin(), zoneTotals.end(), 0);
+    std::fill(warehouseTotals.begin(), warehouseTotals.end(), 0);
+    total = 0;
+}
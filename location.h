@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Places stock is kept in: a bin in a zone of a warehouse, named by a
+// "Warehouse/Zone/Bin" path. Locations are numbered densely in the order
+// they are first seen.
+using LocationId = std::uint32_t;
+
+constexpr LocationId kNoLocation = static_cast<LocationId>(-1);
+
+// How an order's stock is picked from the bins holding the item:
+//     Nearest      bins closest to the pick origin first: the origin bin,
+//                  then its zone, then its warehouse, then anywhere
+//     FifoLot      oldest stock first
+//     FewestPicks  the smallest bin that holds the whole quantity, or else
+//                  the fullest bins first
+// Ties go to the lower location ID.
+enum class AllocationPolicy : std::uint8_t { Nearest, FifoLot, FewestPicks, Count };
+
+constexpr std::size_t kAllocationPolicyCount = static_cast<std::size_t>(AllocationPolicy::Count);
+
+inline const char* allocationPolicyName(AllocationPolicy policy) {
+    switch (policy) {
+        case AllocationPolicy::Nearest: return "Nearest";
+        case AllocationPolicy::FifoLot: return "FifoLot";
+        case AllocationPolicy::FewestPicks: return "FewestPicks";
+        case AllocationPolicy::Count: break;
+    }
+    return "";
+}
+
+// Match a policy name, ignoring case. Returns false for unknown names.
+inline bool parseAllocationPolicy(std::string_view name, AllocationPolicy& policy) {
+    for (std::size_t i = 0; i < kAllocationPolicyCount; i++) {
+        std::string_view candidate = allocationPolicyName(static_cast<AllocationPolicy>(i));
+        if (std::equal(name.begin(), name.end(), candidate.begin(), candidate.end(),
+                       [](char a, char b) {
+                           return std::tolower(static_cast<unsigned char>(a)) ==
+                                  std::tolower(static_cast<unsigned char>(b));
+                       })) {
+            policy = static_cast<AllocationPolicy>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stock of one item in one bin. The lot is the receipt number of the
+// oldest stock in the bin; stock received later joins the bin's lot.
+struct BinStock {
+    LocationId location;
+    int quantity;
+    std::uint64_t lot;
+};
+
+// Stock taken from a bin for an order, kept so it can go back to the bin
+struct Pick {
+    int itemId;
+    LocationId location;
+    int quantity;
+    std::uint64_t lot;
+};
+
+// Stock of every item by location. Each item keeps its bins in a small
+// array of its own, and a hash of (item, location) pairs gives the slot of
+// any bin in O(1), so no item pays for the bins of the others. Totals per
+// item, location and warehouse are kept up to date as stock moves, so
+// reading them is O(1). Empty bins are dropped.
+class LocationStock {
+private:
+    struct Place {
+        std::string path;
+        std::uint32_t warehouse;  // Index into warehouses
+        std::uint32_t zone;       // Index of the warehouse and zone pair
+    };
+    struct ItemBins {
+        std::vector<BinStock> bins;
+        int total = 0;
+    };
+
+    std::vector<Place> places;  // By location ID
+    std::unordered_map<std::string, LocationId> locationOf;
+    std::vector<std::string> warehouses;
+    std::unordered_map<std::string, std::uint32_t> warehouseOf;
+    std::unordered_map<std::string, std::uint32_t> zoneOf;  // By "Warehouse/Zone"
+    std::vector<long long> locationTotals;
+    std::vector<long long> zoneTotals;
+    std::vector<long long> warehouseTotals;
+    long long total = 0;
+    std::unordered_map<int, ItemBins> items;
+    std::unordered_map<std::uint64_t, std::uint32_t> slotOf;  // (item, location) -> index in the item's bins
+    std::uint64_t nextLot = 1;
+
+    static std::uint64_t slotKey(int itemId, LocationId location) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(itemId)) << 32 | location;
+    }
+    void change(ItemBins& entry, BinStock& bin, int delta);
+    // Empty the bin at slot, moving the item's last bin into its place
+    void dropBin(int itemId, ItemBins& entry, std::uint32_t slot);
+    // 0 for the origin bin, 1 for its zone, 2 for its warehouse, 3 elsewhere
+    int distance(LocationId from, LocationId to) const;
+
+public:
+    // Check that a path names a bin: three non-empty parts separated by
+    // '/', without commas or control characters
+    static bool isValidPath(std::string_view path);
+
+    // ID of a location, numbering it if it is new. Returns kNoLocation for
+    // an invalid path.
+    LocationId intern(std::string_view path);
+    // ID of a known location, or kNoLocation
+    LocationId find(std::string_view path) const;
+    const std::string& getPath(LocationId location) const { return places[location].path; }
+    std::size_t getLocationCount() const { return places.size(); }
+    bool isLocation(LocationId location) const { return location < places.size(); }
+
+    int getQuantity(int itemId, LocationId location) const;
+    // Stock of an item over all its bins
+    int getItemTotal(int itemId) const;
+    long long getLocationTotal(LocationId location) const { return locationTotals[location]; }
+    // Stock in every bin of a "Warehouse/Zone" zone or of a warehouse, or
+    // 0 for one never seen
+    long long getZoneTotal(std::string_view zone) const;
+    long long getWarehouseTotal(std::string_view warehouse) const;
+    long long getTotal() const { return total; }
+
+    // Bins holding an item, in no particular order
+    std::span<const BinStock> getBins(int itemId) const;
+
+    // Put stock in a bin. Stock from a new receipt (lot 0) takes the next
+    // receipt number; returned stock keeps the lot it was picked from.
+    void add(int itemId, LocationId location, int quantity, std::uint64_t lot = 0);
+
+    // Take up to quantity units of an item from its bins in the order the
+    // policy picks them, appending a pick per bin touched. Returns the
+    // units taken, which fall short if the bins hold less.
+    int take(int itemId, int quantity, AllocationPolicy policy, LocationId origin,
+             std::vector<Pick>& picks);
+
+    // Move stock of an item from one bin to another, keeping its lot.
+    // Returns false, changing nothing, if the first bin holds less.
+    bool move(int itemId, LocationId from, LocationId to, int quantity);
+
+    void erase(int itemId);
+    void clear();
+
+    // Visit every bin as (itemId, BinStock), items in no particular order
+    template <typename Visit>
+    void forEachBin(Visit visit) const {
+        for (const auto& [itemId, entry] : items) {
+            for (const auto& bin : entry.bins) {
+                visit(itemId, bin);
+            }
+        }
+    }
+
+    // Receipt numbers continue after the largest lot seen, so loaded lots
+    // stay older than new receipts
+    void noteLot(std::uint64_t lot) { nextLot = std::max(nextLot, lot + 1); }
+};
@@ -0,0 +1,110 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+std::uint64_t OperationStats::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < LatencyBuckets::kCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(LatencyBuckets::midpoint(i), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+
+Metrics::Registry& Metrics::registry() {
+    static Registry instance;
+    return instance;
+}
+
+Metrics::ThreadBlock& Metrics::localBlock() {
+    thread_local std::shared_ptr<ThreadBlock> block = []() {
+        auto created = std::make_shared<ThreadBlock>();
+        std::lock_guard<std::mutex> guard(registry().mutex);
+        registry().blocks.push_back(created);
+        return created;
+    }();
+    return *block;
+}
+
+void Metrics::record(Operation operation, std::uint64_t nanos) {
+    auto& counters = localBlock().operations[static_cast<int>(operation)];
+    add(counters.count, 1);
+    add(counters.totalNanos, nanos);
+    add(counters.buckets[LatencyBuckets::indexOf(nanos)], 1);
+    if (nanos > counters.maxNanos.load(std::memory_order_relaxed)) {
+        counters.maxNanos.store(nanos, std::memory_order_relaxed);
+    }
+}
+
+std::vector<OperationStats> Metrics::snapshot() {
+    std::vector<OperationStats> stats(static_cast<int>(Operation::Count));
+    std::lock_guard<std::mutex> guard(registry().mutex);
+    for (const auto& block : registry().blocks) {
+        for (std::size_t op = 0; op < stats.size(); op++) {
+            const auto& counters = block->operations[op];
+            auto& merged = stats[op];
+            merged.count += counters.count.load(std::memory_order_relaxed);
+            merged.totalNanos += counters.totalNanos.load(std::memory_order_relaxed);
+            merged.maxNanos = std::max(merged.maxNanos, counters.maxNanos.load(std::memory_order_relaxed));
+            for (int i = 0; i < LatencyBuckets::kCount; i++) {
+                merged.buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return stats;
+}
+
+void Metrics::writeText(std::ostream& stream) {
+    auto stats = snapshot();
+    // Formatted in a local stream so the caller's stream keeps its own precision
+    std::ostringstream out;
+    out << std::left << std::setw(28) << "Operation" << std::right
+        << std::setw(10) << "Count" << std::setw(12) << "Mean us"
+        << std::setw(12) << "p50 us" << std::setw(12) << "p99 us"
+        << std::setw(12) << "p99.9 us" << std::setw(12) << "Max us" << "\n";
+    out << std::string(98, '-') << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (std::size_t op = 0; op < stats.size(); op++) {
+        const auto& s = stats[op];
+        if (s.count == 0) {
+            continue;
+        }
+        out << std::left << std::setw(28) << operationName(static_cast<Operation>(op)) << std::right
+            << std::setw(10) << s.count
+            << std::setw(12) << s.meanNanos() / 1000.0
+            << std::setw(12) << s.percentile(0.50) / 1000.0
+            << std::setw(12) << s.percentile(0.99) / 1000.0
+            << std::setw(12) << s.percentile(0.999) / 1000.0
+            << std::setw(12) << s.maxNanos / 1000.0 << "\n";
+    }
+    stream << out.str();
+}
+
+void Metrics::writePrometheus(std::ostream& stream) {
+    auto stats = snapshot();
+    std::ostringstream out;
+    out << "# HELP warehouse_operation_duration_seconds Latency of WarehouseSystem operations.\n"
+        << "# TYPE warehouse_operation_duration_seconds summary\n";
+    out << std::setprecision(9) << std::defaultfloat;
+    for (std::size_t op = 0; op < stats.size(); op++) {
+        const auto& s = stats[op];
+        std::string label = std::string("operation=\"") + operationName(static_cast<Operation>(op)) + "\"";
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            out << "warehouse_operation_duration_seconds{" << label << ",quantile=\"" << q << "\"} "
+                << s.percentile(q) / 1e9 << "\n";
+        }
+        out << "warehouse_operation_duration_seconds_sum{" << label << "} " << s.totalNanos / 1e9 << "\n"
+            << "warehouse_operation_duration_seconds_count{" << label << "} " << s.count << "\n";
+    }
+    stream << out.str();
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Operations timed by the instrumentation layer
+enum class Operation {
+    LoadFromFile,
+    SaveToFile,
+    FindItem,
+    CreateOrder,
+    ProcessNextOrder,
+    FetchPage,
+    BulkUpsert,
+    DisplayAllItems,
+    DisplayLowStockItems,
+    DisplayByCategory,
+    SortByName,
+    SortByQuantity,
+    DisplayTransactionHistory,
+    DisplayOrderQueue,
+    LoadOrderLog,
+    CompactOrderLog,
+    SearchItems,
+    QueryItems,
+    AggregateStock,
+    VerifyStockTotals,
+    RecommendReorders,
+    ReceiveStock,
+    Count
+};
+
+inline const char* operationName(Operation operation) {
+    static const char* const names[] = {
+        "load_from_file", "save_to_file", "find_item", "create_order",
+        "process_next_order", "fetch_page", "bulk_upsert", "display_all_items",
+        "display_low_stock_items", "display_by_category", "sort_by_name",
+        "sort_by_quantity", "display_transaction_history", "display_order_queue",
+        "load_order_log", "compact_order_log", "search_items",
+        "query_items", "aggregate_stock", "verify_stock_totals",
+        "recommend_reorders", "receive_stock",
+    };
+    return names[static_cast<int>(operation)];
+}
+
+// Bucket layout for latency histograms in the style of HdrHistogram: values
+// below 16 ns get exact buckets, above that each power of two is split into
+// 16 linear sub-buckets, so a bucket is never wider than 1/16 of its value.
+// Values are clamped to 2^44 ns (about 4.9 hours).
+struct LatencyBuckets {
+    static const int kSubBucketBits = 4;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kMaxExponent = 44;
+    static const int kCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    static int indexOf(std::uint64_t nanos) {
+        nanos = std::min<std::uint64_t>(nanos, (std::uint64_t(1) << kMaxExponent) - 1);
+        if (nanos < static_cast<std::uint64_t>(kSubBuckets)) {
+            return static_cast<int>(nanos);
+        }
+        int shift = static_cast<int>(std::bit_width(nanos)) - 1 - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<int>((nanos >> shift) & (kSubBuckets - 1));
+    }
+
+    static std::uint64_t lowerBound(int index) {
+        if (index < kSubBuckets) {
+            return static_cast<std::uint64_t>(index);
+        }
+        int shift = index / kSubBuckets - 1;
+        return static_cast<std::uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    }
+
+    // Midpoint of the bucket, used when reporting percentiles
+    static std::uint64_t midpoint(int index) {
+        if (index < kSubBuckets) {
+            return lowerBound(index);
+        }
+        int shift = index / kSubBuckets - 1;
+        return lowerBound(index) + ((std::uint64_t(1) << shift) >> 1);
+    }
+};
+
+// Merged view of one operation's counters across all threads
+struct OperationStats {
+    std::uint64_t count = 0;
+    std::uint64_t totalNanos = 0;
+    std::uint64_t maxNanos = 0;
+    std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(LatencyBuckets::kCount);
+
+    double meanNanos() const { return count ? static_cast<double>(totalNanos) / count : 0.0; }
+
+    // Latency at quantile q (0..1), accurate to the bucket width
+    std::uint64_t percentile(double q) const;
+};
+
+// Per-operation counters and latency histograms. Each thread records into
+// its own block, so recording costs two clock reads and a few uncontended
+// relaxed stores; readers merge all blocks, including those of threads that
+// have exited.
+class Metrics {
+private:
+    struct OperationCounters {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> totalNanos{0};
+        std::atomic<std::uint64_t> maxNanos{0};
+        std::atomic<std::uint64_t> buckets[LatencyBuckets::kCount] = {};
+    };
+
+    struct ThreadBlock {
+        OperationCounters operations[static_cast<int>(Operation::Count)];
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBlock>> blocks;
+        std::atomic<bool> enabled{true};
+    };
+
+    static Registry& registry();
+
+    static ThreadBlock& localBlock();
+
+    // Only the owning thread writes its block, so a load and store suffice
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+public:
+    static bool isEnabled() { return registry().enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled) { registry().enabled = enabled; }
+
+    static void record(Operation operation, std::uint64_t nanos);
+
+    static std::vector<OperationStats> snapshot();
+
+    // Human-readable table; latencies in microseconds
+    static void writeText(std::ostream& out);
+
+    // Prometheus text exposition format, one summary per operation
+    static void writePrometheus(std::ostream& out);
+};
+
+// Records the lifetime of a scope as one sample of an operation
+class ScopedTimer {
+private:
+    Operation operation;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Operation operation)
+        : operation(operation), active(Metrics::isEnabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            Metrics::record(operation, static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
@@ -1,428 +1,13 @@
-#include <string>
-#include <map>
-#include <vector>
+#include "commands.h"
+#include "server.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
-#include <sstream>
-#include <algorithm>
-#include <iostream>
 #include <iomanip>
 #include <limits>
-#include <stack>
-#include <queue>
-#include <memory>
-#include <ctime>
-
-// InventoryItem class definition
-class InventoryItem {
-private:
-    int id;
-    std::string name;
-    std::string category;
-    int quantity;
-    double price;
-    int minStockLevel;
-
-public:
-    InventoryItem() = default;
-    InventoryItem(int id, const std::string& name, const std::string& category, 
-                 int quantity, double price, int minStockLevel)
-        : id(id), name(name), category(category), quantity(quantity), 
-          price(price), minStockLevel(minStockLevel) {}
-
-    // Getters
-    int getId() const { return id; }
-    std::string getName() const { return name; }
-    std::string getCategory() const { return category; }
-    int getQuantity() const { return quantity; }
-    double getPrice() const { return price; }
-    int getMinStockLevel() const { return minStockLevel; }
-
-    // Setters
-    void setId(int newId) { id = newId; }
-    void setName(const std::string& newName) { name = newName; }
-    void setCategory(const std::string& newCategory) { category = newCategory; }
-    void setQuantity(int newQuantity) { quantity = newQuantity; }
-    void setPrice(double newPrice) { price = newPrice; }
-    void setMinStockLevel(int newMinStockLevel) { minStockLevel = newMinStockLevel; }
-
-    // Check if item is low on stock
-    bool isLowStock() const { return quantity <= minStockLevel; }
-};
-
-// Transaction class for history tracking
-class Transaction {
-private:
-    std::time_t timestamp;
-    std::string action;
-    int itemId;
-    std::string details;
-
-public:
-    Transaction(const std::string& action, int itemId, const std::string& details)
-        : action(action), itemId(itemId), details(details) {
-        timestamp = std::time(nullptr);
-    }
-
-    std::string getFormattedTime() const {
-        char buffer[26];
-        ctime_s(buffer, sizeof(buffer), &timestamp);
-        std::string time(buffer);
-        return time.substr(0, time.length() - 1); // Remove newline
-    }
-
-    std::string toString() const {
-        return getFormattedTime() + " - " + action + " (Item ID: " + 
-               std::to_string(itemId) + ") " + details;
-    }
-};
-
-// Category tree node
-struct CategoryNode {
-    std::string name;
-    std::vector<std::shared_ptr<CategoryNode>> children;
-    std::vector<int> itemIds; // Store item IDs in this category
-
-    CategoryNode(const std::string& name) : name(name) {}
-};
-
-// Order class for queue
-class Order {
-private:
-    int orderId;
-    int itemId;
-    int quantity;
-    std::string status;
-    std::time_t orderTime;
-
-public:
-    Order(int orderId, int itemId, int quantity)
-        : orderId(orderId), itemId(itemId), quantity(quantity), status("Pending") {
-        orderTime = std::time(nullptr);
-    }
-
-    int getOrderId() const { return orderId; }
-    int getItemId() const { return itemId; }
-    int getQuantity() const { return quantity; }
-    std::string getStatus() const { return status; }
-    std::time_t getOrderTime() const { return orderTime; }
-
-    void setStatus(const std::string& newStatus) { status = newStatus; }
-};
-
-// WarehouseSystem class definition
-class WarehouseSystem {
-private:
-    std::map<int, InventoryItem> inventory;
-    std::string filename;
-    int nextId;
-    std::stack<Transaction> transactionHistory;
-    std::queue<Order> orderQueue;
-    std::shared_ptr<CategoryNode> categoryRoot;
-    int nextOrderId;
-
-    void loadFromFile() {
-        std::ifstream file(filename);
-        if (!file) {
-            return;  // File doesn't exist yet
-        }
-
-        std::string line;
-        // Skip header line
-        std::getline(file, line);
-        
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string token;
-            
-            int id;
-            std::string name, category;
-            int quantity;
-            double price;
-            int minStockLevel;
-            
-            // Parse CSV line
-            std::getline(ss, token, ','); id = std::stoi(token);
-            std::getline(ss, name, ',');
-            std::getline(ss, category, ',');
-            std::getline(ss, token, ','); quantity = std::stoi(token);
-            std::getline(ss, token, ','); price = std::stod(token);
-            std::getline(ss, token, ','); minStockLevel = std::stoi(token);
-            
-            inventory[id] = InventoryItem(id, name, category, quantity, price, minStockLevel);
-            nextId = std::max(nextId, id + 1);
-        }
-    }
-
-    void saveToFile() const {
-        std::ofstream file(filename);
-        file << "ID,Name,Category,Quantity,Price,MinStockLevel\n";
-        
-        for (const auto& [id, item] : inventory) {
-            file << item.getId() << ","
-                 << item.getName() << ","
-                 << item.getCategory() << ","
-                 << item.getQuantity() << ","
-                 << std::fixed << std::setprecision(2) << item.getPrice() << ","
-                 << item.getMinStockLevel() << "\n";
-        }
-    }
-
-    std::vector<InventoryItem> getItemsByCategory(const std::string& category) const {
-        std::vector<InventoryItem> items;
-        for (const auto& [id, item] : inventory) {
-            if (item.getCategory() == category) {
-                items.push_back(item);
-            }
-        }
-        return items;
-    }
-
-    void addTransaction(const std::string& action, int itemId, const std::string& details) {
-        transactionHistory.push(Transaction(action, itemId, details));
-    }
-
-    void initializeCategoryTree() {
-        categoryRoot = std::make_shared<CategoryNode>("Root");
-    }
-
-    std::shared_ptr<CategoryNode> findOrCreateCategory(const std::string& category) {
-        // Split category path (e.g., "Electronics/Phones" -> ["Electronics", "Phones"])
-        std::vector<std::string> path;
-        std::stringstream ss(category);
-        std::string segment;
-        while (std::getline(ss, segment, '/')) {
-            path.push_back(segment);
-        }
-
-        auto current = categoryRoot;
-        for (const auto& name : path) {
-            auto it = std::find_if(current->children.begin(), current->children.end(),
-                [&name](const auto& child) { return child->name == name; });
-            
-            if (it == current->children.end()) {
-                auto newNode = std::make_shared<CategoryNode>(name);
-                current->children.push_back(newNode);
-                current = newNode;
-            } else {
-                current = *it;
-            }
-        }
-        return current;
-    }
-
-public:
-    WarehouseSystem(const std::string& filename) 
-        : filename(filename), nextId(1), nextOrderId(1) {
-        loadFromFile();
-        initializeCategoryTree();
-    }
-
-    void addItem(const InventoryItem& item) {
-        inventory[item.getId()] = item;
-        nextId = item.getId() + 1;
-        
-        // Add item to category tree
-        auto categoryNode = findOrCreateCategory(item.getCategory());
-        categoryNode->itemIds.push_back(item.getId());
-        
-        addTransaction("Add", item.getId(), 
-            "Added " + item.getName() + " to category " + item.getCategory());
-        saveToFile();
-    }
-
-    bool removeItem(int id) {
-        if (inventory.erase(id) > 0) {
-            saveToFile();
-            return true;
-        }
-        return false;
-    }
-
-    bool updateItem(const InventoryItem& item) {
-        if (inventory.find(item.getId()) != inventory.end()) {
-            inventory[item.getId()] = item;
-            saveToFile();
-            return true;
-        }
-        return false;
-    }
-
-    InventoryItem* findItem(int id) {
-        auto it = inventory.find(id);
-        return (it != inventory.end()) ? &it->second : nullptr;
-    }
-
-    void displayAllItems() const {
-        std::cout << std::setw(5) << "ID" << " | "
-                  << std::setw(20) << "Name" << " | "
-                  << std::setw(15) << "Category" << " | "
-                  << std::setw(10) << "Quantity" << " | "
-                  << std::setw(10) << "Price" << " | "
-                  << std::setw(15) << "Min Stock" << "\n";
-        std::cout << std::string(80, '-') << "\n";
-        
-        for (const auto& [id, item] : inventory) {
-            std::cout << std::setw(5) << item.getId() << " | "
-                      << std::setw(20) << item.getName() << " | "
-                      << std::setw(15) << item.getCategory() << " | "
-                      << std::setw(10) << item.getQuantity() << " | "
-                      << std::setw(10) << std::fixed << std::setprecision(2) << item.getPrice() << " | "
-                      << std::setw(15) << item.getMinStockLevel() << "\n";
-        }
-    }
-
-    void displayLowStockItems() const {
-        bool found = false;
-        for (const auto& [id, item] : inventory) {
-            if (item.isLowStock()) {
-                if (!found) {
-                    std::cout << "Low Stock Items:\n";
-                    found = true;
-                }
-                std::cout << "ID: " << item.getId() 
-                          << ", Name: " << item.getName()
-                          << ", Current Stock: " << item.getQuantity()
-                          << ", Min Stock: " << item.getMinStockLevel() << "\n";
-            }
-        }
-        if (!found) {
-            std::cout << "No items are low on stock.\n";
-        }
-    }
-
-    void displayByCategory(const std::string& category) const {
-        auto items = getItemsByCategory(category);
-        if (items.empty()) {
-            std::cout << "No items found in category: " << category << "\n";
-            return;
-        }
-        
-        std::cout << "Items in category '" << category << "':\n";
-        for (const auto& item : items) {
-            std::cout << "ID: " << item.getId() 
-                      << ", Name: " << item.getName()
-                      << ", Quantity: " << item.getQuantity()
-                      << ", Price: " << item.getPrice() << "\n";
-        }
-    }
-
-    std::vector<InventoryItem> getAllItems() const {
-        std::vector<InventoryItem> items;
-        for (const auto& [id, item] : inventory) {
-            items.push_back(item);
-        }
-        return items;
-    }
-
-    void sortByName() {
-        auto items = getAllItems();
-        std::sort(items.begin(), items.end(), 
-                  [](const InventoryItem& a, const InventoryItem& b) {
-                      return a.getName() < b.getName();
-                  });
-        
-        // Display sorted items
-        for (const auto& item : items) {
-            std::cout << "ID: " << item.getId() 
-                      << ", Name: " << item.getName()
-                      << ", Category: " << item.getCategory()
-                      << ", Quantity: " << item.getQuantity() << "\n";
-        }
-    }
-
-    void sortByQuantity() {
-        auto items = getAllItems();
-        std::sort(items.begin(), items.end(), 
-                  [](const InventoryItem& a, const InventoryItem& b) {
-                      return a.getQuantity() < b.getQuantity();
-                  });
-        
-        // Display sorted items
-        for (const auto& item : items) {
-            std::cout << "ID: " << item.getId() 
-                      << ", Name: " << item.getName()
-                      << ", Quantity: " << item.getQuantity() << "\n";
-        }
-    }
-
-    int getNextId() const { return nextId; }
-
-    void createOrder(int itemId, int quantity) {
-        auto item = findItem(itemId);
-        if (item && quantity > 0) {
-            orderQueue.push(Order(nextOrderId++, itemId, quantity));
-            addTransaction("Order Created", itemId, 
-                "Ordered " + std::to_string(quantity) + " units");
-            std::cout << "Order created successfully!\n";
-        } else {
-            std::cout << "Invalid item ID or quantity!\n";
-        }
-    }
-
-    void processNextOrder() {
-        if (orderQueue.empty()) {
-            std::cout << "No orders to process!\n";
-            return;
-        }
-
-        Order order = orderQueue.front();
-        orderQueue.pop();
-
-        auto item = findItem(order.getItemId());
-        if (item) {
-            if (item->getQuantity() >= order.getQuantity()) {
-                item->setQuantity(item->getQuantity() - order.getQuantity());
-                addTransaction("Order Processed", order.getItemId(),
-                    "Processed order #" + std::to_string(order.getOrderId()) + 
-                    " for " + std::to_string(order.getQuantity()) + " units");
-                std::cout << "Order #" << order.getOrderId() << " processed successfully!\n";
-                saveToFile();
-            } else {
-                std::cout << "Insufficient stock for order #" << order.getOrderId() << "!\n";
-                // Put the order back in queue
-                orderQueue.push(order);
-            }
-        }
-    }
-
-    void displayTransactionHistory(int limit = 10) const {
-        std::cout << "\nRecent Transaction History:\n";
-        std::cout << std::string(50, '-') << "\n";
-        
-        auto tempStack = transactionHistory;
-        int count = 0;
-        
-        while (!tempStack.empty() && count < limit) {
-            std::cout << tempStack.top().toString() << "\n";
-            tempStack.pop();
-            count++;
-        }
-    }
-
-    void displayOrderQueue() const {
-        if (orderQueue.empty()) {
-            std::cout << "No pending orders.\n";
-            return;
-        }
-
-        std::cout << "\nPending Orders:\n";
-        std::cout << std::string(50, '-') << "\n";
-        
-        auto tempQueue = orderQueue;
-        while (!tempQueue.empty()) {
-            const auto& order = tempQueue.front();
-            auto item = inventory.find(order.getItemId());
-            
-            std::cout << "Order #" << order.getOrderId() << ":\n"
-                     << "  Item: " << (item != inventory.end() ? item->second.getName() : "Unknown")
-                     << " (ID: " << order.getItemId() << ")\n"
-                     << "  Quantity: " << order.getQuantity() << "\n"
-                     << "  Status: " << order.getStatus() << "\n\n";
-            
-            tempQueue.pop();
-        }
-    }
-};
+#include <sstream>
 
 // Helper functions for the main menu
 void clearInputBuffer() {
@@ -445,6 +30,30 @@ void displayMenu() {
     std::cout << "11. Process Next Order\n";
     std::cout << "12. Display Order Queue\n";
     std::cout << "13. Display Transaction History\n";
+    std::cout << "14. Browse Items (paged)\n";
+    std::cout << "15. Import Items from CSV\n";
+    std::cout << "16. Display Performance Metrics\n";
+    std::cout << "17. Display Orders by Status\n";
+    std::cout << "18. Update Order Status\n";
+    std::cout << "19. Find Order\n";
+    std::cout << "20. Display Open Orders for Item\n";
+    std::cout << "21. Cancel Order\n";
+    std::cout << "22. Amend Order Quantity\n";
+    std::cout << "23. Create Multi-Line Order\n";
+    std::cout << "24. Search Items by Name\n";
+    std::cout << "25. Query Items\n";
+    std::cout << "26. Stock Valuation by Category\n";
+    std::cout << "27. Verify Stock Totals\n";
+    std::cout << "28. Reorder Recommendations\n";
+    std::cout << "29. Apply Reorder Points\n";
+    std::cout << "30. Restock Orders\n";
+    std::cout << "31. Issue Restock Orders\n";
+    std::cout << "32. Receive Stock\n";
+    std::cout << "33. Receive Shipment\n";
+    std::cout << "34. Item Locations\n";
+    std::cout << "35. Receive Stock at Location\n";
+    std::cout << "36. Move Stock to Location\n";
+    std::cout << "37. Set Allocation Policy\n";
     std::cout << "0. Exit\n";
     std::cout << "Enter your choice: ";
 }
@@ -481,8 +90,217 @@ InventoryItem inputItemDetails(WarehouseSystem& system, bool isNew = true) {
     return InventoryItem(id, name, category, quantity, price, minStockLevel);
 }
 
-int main() {
+// Page through the inventory one screen at a time. Prints a resume token when
+// the user stops early so the same listing can be continued later.
+void browseItems(const WarehouseSystem& system) {
+    std::string token;
+    std::cout << "Enter resume token (leave empty to start a new listing): ";
+    std::getline(std::cin, token);
+
+    PageCursor cursor;
+    if (!token.empty()) {
+        if (!PageCursor::fromToken(token, cursor)) {
+            std::cout << "Invalid resume token!\n";
+            return;
+        }
+    } else {
+        int key;
+        std::string category;
+        std::cout << "Sort by (1. ID, 2. Name, 3. Quantity): ";
+        std::cin >> key;
+        clearInputBuffer();
+        if (key < 1 || key > 3) {
+            std::cout << "Invalid sort key!\n";
+            return;
+        }
+        std::cout << "Enter category (leave empty for all): ";
+        std::getline(std::cin, category);
+        cursor = PageCursor(static_cast<SortKey>(key - 1), category);
+    }
+
+    std::size_t pageSize;
+    std::cout << "Enter page size: ";
+    std::cin >> pageSize;
+    clearInputBuffer();
+    if (!std::cin || pageSize == 0) {
+        std::cout << "Invalid page size!\n";
+        return;
+    }
+
+    system.displayTableHeader();
+    while (!cursor.isFinished()) {
+        auto page = system.fetchPage(cursor, pageSize);
+        for (const auto& item : page) {
+            system.displayTableRow(item);
+        }
+        if (cursor.isFinished()) {
+            break;
+        }
+
+        std::string answer;
+        std::cout << "-- Press Enter for the next page, or q to stop: " << std::flush;
+        std::getline(std::cin, answer);
+        if (answer == "q" || answer == "Q" || !std::cin) {
+            std::cout << "Resume token: " << cursor.toToken() << "\n";
+            return;
+        }
+    }
+    std::cout << "End of listing.\n";
+}
+
+void displayMetrics() {
+    std::cout << "\nPerformance Metrics:\n";
+    Metrics::writeText(std::cout);
+
+    std::string path, format;
+    std::cout << "Enter a file to save them to (leave empty to skip): ";
+    std::getline(std::cin, path);
+    if (path.empty()) {
+        return;
+    }
+    std::cout << "Format (text or prometheus): ";
+    std::getline(std::cin, format);
+    dumpMetrics(path, format);
+}
+
+// Workload recording
+//
+// With --record FILE, the inventory, order and report commands run from the
+// menu or in batch mode are appended to FILE in the comma-separated syntax
+// of commands.h, so the session can be fed to the replay tool later. Only
+// commands marked as recorded in the command table are written, and the
+// replay tool runs exactly those through the same parser and executor.
+
+std::ofstream traceFile;
+
+void recordCommand(CommandKind kind, const std::vector<std::string>& args = {}) {
+    if (!traceFile.is_open() || !commandSpec(kind).recorded) {
+        return;
+    }
+    traceFile << commandSpec(kind).name;
+    for (const auto& arg : args) {
+        traceFile << "," << arg;
+    }
+    traceFile << "\n";
+}
+
+// Arguments of an add command for item; update takes the ID in front
+std::vector<std::string> itemArguments(const InventoryItem& item) {
+    std::ostringstream price;
+    price << std::fixed << std::setprecision(2) << item.getPrice();
+    return {item.getName(), item.getCategory(), std::to_string(item.getQuantity()),
+            price.str(), std::to_string(item.getMinStockLevel())};
+}
+
+// Batch command mode
+//
+// Commands are read one per line in the syntax of commands.h. Blank lines
+// and lines starting with '#' are ignored. The CSV file is written once at
+// the end of the run instead of after every change.
+
+// Run every command from input, then save once. Throughput figures go to
+// stderr so they do not mix with command results. Returns the exit status.
+int runBatch(WarehouseSystem& system, std::istream& input) {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    system.setAutoSave(false);
+
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    Command command;
+    std::size_t lineNumber = 0, executed = 0, failed = 0;
+
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!isCommandLine(line)) {
+            continue;
+        }
+
+        std::string error = parseCommand(line, command);
+        if (error.empty()) {
+            auto result = executeCommand(system, command);
+            if (!result.succeeded()) {
+                failed++;
+            }
+            // Lookups of missing items or orders are part of the workload;
+            // rejected commands are bad input the replay tool would refuse
+            if (result.status != CommandStatus::Rejected) {
+                recordCommand(command.kind, command.args);
+            }
+        } else {
+            std::cout << "Line " << lineNumber << ": " << error << "\n";
+            failed++;
+        }
+        executed++;
+    }
+
+    system.save();
+    std::cout.flush();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Batch: " << executed << " commands (" << failed << " failed) in "
+              << std::fixed << std::setprecision(3) << elapsed << " s";
+    if (elapsed > 0) {
+        std::cerr << ", " << std::setprecision(0) << executed / elapsed << " commands/s";
+    }
+    std::cerr << "\n";
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
     WarehouseSystem system("inventory.csv");
+
+    // project --record FILE [mode...]: append the commands run to a trace file
+    if (argc > 2 && std::string(argv[1]) == "--record") {
+        traceFile.open(argv[2], std::ios::app);
+        if (!traceFile) {
+            std::cerr << "Cannot open trace file: " << argv[2] << "\n";
+            return 1;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
+    // project --batch [file]: run commands non-interactively ('-' or no file reads stdin)
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        if (argc > 2 && std::string(argv[2]) != "-") {
+            std::ifstream input(argv[2]);
+            if (!input) {
+                std::cerr << "Cannot open command file: " << argv[2] << "\n";
+                return 1;
+            }
+            return runBatch(system, input);
+        }
+        return runBatch(system, std::cin);
+    }
+
+    // project --serve [port] [threads]: serve the inventory over TCP
+    // project --loadgen [host] [port] [connections] [requests] [depth] [items]
+    if (argc > 1 && (std::string(argv[1]) == "--serve" || std::string(argv[1]) == "--loadgen")) {
+#ifdef __linux__
+        if (std::string(argv[1]) == "--serve") {
+            int port = argc > 2 ? std::atoi(argv[2]) : 9090;
+            unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+            return runServer(system, port, threads);
+        }
+        LoadgenOptions options;
+        if (argc > 2) options.host = argv[2];
+        if (argc > 3) options.port = std::atoi(argv[3]);
+        if (argc > 4) options.connections = static_cast<unsigned>(std::max(1, std::atoi(argv[4])));
+        if (argc > 5) options.requestsPerConnection = static_cast<unsigned>(std::max(1, std::atoi(argv[5])));
+        if (argc > 6) options.depth = static_cast<unsigned>(std::max(1, std::atoi(argv[6])));
+        if (argc > 7) options.items = std::atoi(argv[7]);
+        return runLoadgen(options);
+#else
+        std::cerr << "The network server is only available on Linux.\n";
+        return 1;
+#endif
+    }
+
     int choice;
     
     do {
@@ -494,6 +312,7 @@ int main() {
             case 1: {  // Add New Item
                 auto item = inputItemDetails(system);
                 system.addItem(item);
+                recordCommand(CommandKind::Add, itemArguments(item));
                 std::cout << "Item added successfully!\n";
                 break;
             }
@@ -501,6 +320,7 @@ int main() {
                 int id;
                 std::cout << "Enter item ID to remove: ";
                 std::cin >> id;
+                recordCommand(CommandKind::Remove, {std::to_string(id)});
                 if (system.removeItem(id)) {
                     std::cout << "Item removed successfully!\n";
                 } else {
@@ -510,6 +330,9 @@ int main() {
             }
             case 3: {  // Update Item
                 auto item = inputItemDetails(system, false);
+                auto args = itemArguments(item);
+                args.insert(args.begin(), std::to_string(item.getId()));
+                recordCommand(CommandKind::Update, args);
                 if (system.updateItem(item)) {
                     std::cout << "Item updated successfully!\n";
                 } else {
@@ -521,6 +344,7 @@ int main() {
                 int id;
                 std::cout << "Enter item ID to find: ";
                 std::cin >> id;
+                recordCommand(CommandKind::Find, {std::to_string(id)});
                 auto item = system.findItem(id);
                 if (item) {
                     std::cout << "Item found:\n"
@@ -536,22 +360,27 @@ int main() {
                 break;
             }
             case 5:  // Display All Items
+                recordCommand(CommandKind::List);
                 system.displayAllItems();
                 break;
             case 6:  // Display Low Stock Items
+                recordCommand(CommandKind::LowStock);
                 system.displayLowStockItems();
                 break;
             case 7: {  // Display Items by Category
                 std::string category;
                 std::cout << "Enter category: ";
                 std::getline(std::cin, category);
+                recordCommand(CommandKind::Category, {category});
                 system.displayByCategory(category);
                 break;
             }
             case 8:  // Sort by Name
+                recordCommand(CommandKind::Sort, {"name"});
                 system.sortByName();
                 break;
             case 9:  // Sort by Quantity
+                recordCommand(CommandKind::Sort, {"quantity"});
                 system.sortByQuantity();
                 break;
             case 10: {  // Create Order
@@ -560,18 +389,262 @@ int main() {
                 std::cin >> itemId;
                 std::cout << "Enter quantity: ";
                 std::cin >> quantity;
+                recordCommand(CommandKind::Order, {std::to_string(itemId), std::to_string(quantity)});
                 system.createOrder(itemId, quantity);
                 break;
             }
             case 11:  // Process Next Order
+                recordCommand(CommandKind::Process);
                 system.processNextOrder();
                 break;
             case 12:  // Display Order Queue
+                recordCommand(CommandKind::Queue);
                 system.displayOrderQueue();
                 break;
             case 13:  // Display Transaction History
+                recordCommand(CommandKind::History);
                 system.displayTransactionHistory();
                 break;
+            case 14:  // Browse Items (paged)
+                browseItems(system);
+                break;
+            case 15: {  // Import Items from CSV
+                std::string path;
+                std::cout << "Enter CSV file path: ";
+                std::getline(std::cin, path);
+                importItems(system, path);
+                break;
+            }
+            case 16:  // Display Performance Metrics
+                displayMetrics();
+                break;
+            case 17: {  // Display Orders by Status
+                std::string name;
+                OrderStatus status;
+                std::cout << "Enter status (Pending, Reserved, Picked, Shipped, Cancelled, Backordered): ";
+                std::getline(std::cin, name);
+                if (!parseOrderStatus(name, status)) {
+                    std::cout << "Unknown order status!\n";
+                    break;
+                }
+                recordCommand(CommandKind::Orders, {orderStatusName(status)});
+                system.displayOrdersByStatus(status);
+                break;
+            }
+            case 18: {  // Update Order Status
+                int orderId;
+                std::string name;
+                OrderStatus status;
+                std::cout << "Enter order ID: ";
+                std::cin >> orderId;
+                clearInputBuffer();
+                std::cout << "Enter new status: ";
+                std::getline(std::cin, name);
+                if (!parseOrderStatus(name, status)) {
+                    std::cout << "Unknown order status!\n";
+                    break;
+                }
+                if (system.setOrderStatus(orderId, status)) {
+                    recordCommand(CommandKind::Status, {std::to_string(orderId), orderStatusName(status)});
+                    std::cout << "Order status updated!\n";
+                } else {
+                    std::cout << "Order not found or status change not allowed!\n";
+                }
+                break;
+            }
+            case 19: {  // Find Order
+                int orderId;
+                std::cout << "Enter order ID: ";
+                std::cin >> orderId;
+                recordCommand(CommandKind::GetOrder, {std::to_string(orderId)});
+                if (auto order = system.findOrder(orderId)) {
+                    system.displayOrder(*order);
+                } else {
+                    std::cout << "Order not found!\n";
+                }
+                break;
+            }
+            case 20: {  // Display Open Orders for Item
+                int itemId;
+                std::cout << "Enter item ID: ";
+                std::cin >> itemId;
+                recordCommand(CommandKind::ItemOrders, {std::to_string(itemId)});
+                system.displayItemOrders(itemId);
+                break;
+            }
+            case 21: {  // Cancel Order
+                int orderId;
+                std::cout << "Enter order ID to cancel: ";
+                std::cin >> orderId;
+                recordCommand(CommandKind::Cancel, {std::to_string(orderId)});
+                if (system.cancelOrder(orderId)) {
+                    std::cout << "Order cancelled!\n";
+                } else {
+                    std::cout << "Order not found or already picked!\n";
+                }
+                break;
+            }
+            case 22: {  // Amend Order Quantity
+                int orderId, itemId, quantity;
+                std::cout << "Enter order ID: ";
+                std::cin >> orderId;
+                std::cout << "Enter item ID (0 for a single-line order): ";
+                std::cin >> itemId;
+                std::cout << "Enter new quantity: ";
+                std::cin >> quantity;
+                std::vector<std::string> args{std::to_string(orderId), std::to_string(quantity)};
+                if (itemId != 0) {
+                    args.push_back(std::to_string(itemId));
+                }
+                recordCommand(CommandKind::Amend, args);
+                bool amended = itemId != 0 ? system.amendOrder(orderId, itemId, quantity)
+                                           : system.amendOrder(orderId, quantity);
+                if (amended) {
+                    std::cout << "Order amended!\n";
+                } else {
+                    std::cout << "Order cannot be amended!\n";
+                }
+                break;
+            }
+            case 23: {  // Create Multi-Line Order
+                std::string text;
+                std::vector<OrderLine> lines;
+                std::cout << "Enter lines as itemId:quantity separated by spaces: ";
+                std::getline(std::cin, text);
+                if (!WarehouseSystem::parseOrderLines(text, lines)) {
+                    std::cout << "Invalid order lines!\n";
+                    break;
+                }
+                recordCommand(CommandKind::MultiOrder, {WarehouseSystem::formatOrderLines(lines)});
+                system.createOrder(lines);
+                break;
+            }
+            case 24: {  // Search Items by Name
+                std::string query;
+                std::cout << "Enter name or part of a name: ";
+                std::getline(std::cin, query);
+                recordCommand(CommandKind::Search, {query});
+                system.displaySearchResults(query);
+                break;
+            }
+            case 25: {  // Query Items
+                std::string text;
+                std::cout << "Enter filters, e.g. category=Tools price=50..100 lowstock sort=-quantity limit=20\n> ";
+                std::getline(std::cin, text);
+                ItemQuery query;
+                std::string error = ItemQuery::parse(text, query);
+                if (!error.empty()) {
+                    std::cout << "Invalid query: " << error << "\n";
+                    break;
+                }
+                recordCommand(CommandKind::Query, {text});
+                system.displayQueryResults(query);
+                break;
+            }
+            case 26:  // Stock Valuation by Category
+                recordCommand(CommandKind::Rollup);
+                system.displayStockReport();
+                break;
+            case 27:  // Verify Stock Totals
+                recordCommand(CommandKind::CheckTotals);
+                displayStockDrift(system.verifyStockTotals());
+                break;
+            case 28:  // Reorder Recommendations
+                recordCommand(CommandKind::Reorders);
+                system.displayReorderRecommendations();
+                break;
+            case 29:  // Apply Reorder Points
+                recordCommand(CommandKind::ApplyReorders);
+                std::cout << "Set reorder points of " << system.applyReorderPoints() << " items\n";
+                break;
+            case 30:  // Restock Orders
+                recordCommand(CommandKind::Restocks);
+                system.displayRestockOrders();
+                break;
+            case 31:  // Issue Restock Orders
+                recordCommand(CommandKind::IssueRestocks);
+                std::cout << "Issued " << system.issueRestockOrders() << " restock orders\n";
+                break;
+            case 32: {  // Receive Stock
+                int itemId, quantity;
+                std::cout << "Enter item ID: ";
+                std::cin >> itemId;
+                std::cout << "Enter quantity received: ";
+                std::cin >> quantity;
+                recordCommand(CommandKind::Receive, {std::to_string(itemId), std::to_string(quantity)});
+                displayReceiveResult(system.receiveStock(itemId, quantity));
+                break;
+            }
+            case 33: {  // Receive Shipment
+                std::string text;
+                std::vector<OrderLine> parsed;
+                std::cout << "Enter lines as itemId:quantity separated by spaces: ";
+                std::getline(std::cin, text);
+                if (!WarehouseSystem::parseOrderLines(text, parsed)) {
+                    std::cout << "Invalid shipment lines!\n";
+                    break;
+                }
+                std::vector<RestockLine> lines;
+                for (const auto& line : parsed) {
+                    lines.push_back({line.getItemId(), line.getQuantity()});
+                }
+                recordCommand(CommandKind::Shipment, {WarehouseSystem::formatOrderLines(parsed)});
+                displayReceiveResult(system.receiveShipment(lines));
+                break;
+            }
+            case 34: {  // Item Locations
+                int itemId;
+                std::cout << "Enter item ID: ";
+                std::cin >> itemId;
+                recordCommand(CommandKind::Locations, {std::to_string(itemId)});
+                system.displayItemLocations(itemId);
+                break;
+            }
+            case 35: {  // Receive Stock at Location
+                int itemId, quantity;
+                std::string location;
+                std::cout << "Enter item ID: ";
+                std::cin >> itemId;
+                clearInputBuffer();
+                std::cout << "Enter location as Warehouse/Zone/Bin: ";
+                std::getline(std::cin, location);
+                std::cout << "Enter quantity received: ";
+                std::cin >> quantity;
+                recordCommand(CommandKind::ReceiveAt, {std::to_string(itemId), location, std::to_string(quantity)});
+                displayReceiveResult(system.receiveStockAt(itemId, location, quantity));
+                break;
+            }
+            case 36: {  // Move Stock to Location
+                int itemId, quantity;
+                std::string from, to;
+                std::cout << "Enter item ID: ";
+                std::cin >> itemId;
+                clearInputBuffer();
+                std::cout << "Enter location to move from (empty for unlocated stock): ";
+                std::getline(std::cin, from);
+                std::cout << "Enter location to move to: ";
+                std::getline(std::cin, to);
+                std::cout << "Enter quantity: ";
+                std::cin >> quantity;
+                recordCommand(CommandKind::MoveStock, {std::to_string(itemId), from, to, std::to_string(quantity)});
+                displayMoveResult(system.moveStock(itemId, from, to, quantity));
+                break;
+            }
+            case 37: {  // Set Allocation Policy
+                std::string name, origin;
+                std::cout << "Enter policy (Nearest, FifoLot or FewestPicks): ";
+                std::getline(std::cin, name);
+                std::cout << "Enter location picking starts from (empty for none): ";
+                std::getline(std::cin, origin);
+                AllocationPolicy policy;
+                if (!parseAllocationPolicy(name, policy)) {
+                    std::cout << "Unknown allocation policy!\n";
+                    break;
+                }
+                recordCommand(CommandKind::Policy, {allocationPolicyName(policy), origin});
+                setAllocationPolicy(system, policy, origin);
+                break;
+            }
             case 0:
                 std::cout << "Thank you for using the Warehouse Management System!\n";
                 break;
@@ -0,0 +1,496 @@
+#include "query.h"
+#include "warehouse.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+// The nearest value above or below, for strict comparisons
+int stepFrom(int value, bool up) {
+    if (up) {
+        return value == std::numeric_limits<int>::max() ? value : value + 1;
+    }
+    return value == std::numeric_limits<int>::min() ? value : value - 1;
+}
+
+double stepFrom(double value, bool up) {
+    return std::nextafter(value, up ? std::numeric_limits<double>::infinity()
+                                    : -std::numeric_limits<double>::infinity());
+}
+
+// Narrow [low, high] by one comparison; "a..b" after '=' is a range
+template <typename T>
+bool applyBound(std::string_view op, std::string_view value, T& low, T& high) {
+    T bound;
+    if (op == "=") {
+        auto dots = value.find("..");
+        if (dots != std::string_view::npos) {
+            T upper;
+            if (!parseNumber(value.substr(0, dots), bound) ||
+                !parseNumber(value.substr(dots + 2), upper)) {
+                return false;
+            }
+            low = std::max(low, bound);
+            high = std::min(high, upper);
+            return true;
+        }
+        if (!parseNumber(value, bound)) {
+            return false;
+        }
+        low = std::max(low, bound);
+        high = std::min(high, bound);
+        return true;
+    }
+    if (!parseNumber(value, bound)) {
+        return false;
+    }
+    if (op == "<") {
+        high = std::min(high, stepFrom(bound, false));
+    } else if (op == "<=") {
+        high = std::min(high, bound);
+    } else if (op == ">") {
+        low = std::max(low, stepFrom(bound, true));
+    } else {
+        low = std::max(low, bound);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string ItemQuery::parse(std::string_view text, ItemQuery& query) {
+    query = ItemQuery();
+    std::size_t pos = 0;
+    while (true) {
+        pos = text.find_first_not_of(" \t", pos);
+        if (pos == std::string_view::npos) {
+            return "";
+        }
+        std::size_t end = std::min(text.find_first_of(" \t", pos), text.size());
+        std::string_view term = text.substr(pos, end - pos);
+        pos = end;
+
+        if (term == "lowstock") {
+            query.lowStockOnly = true;
+            continue;
+        }
+        std::size_t opStart = term.find_first_of("<>=");
+        if (opStart == std::string_view::npos || opStart == 0) {
+            return "expected field=value, field<value or field>value in '" + std::string(term) + "'";
+        }
+        std::size_t opEnd = opStart + 1;
+        if (term[opStart] != '=' && opEnd < term.size() && term[opEnd] == '=') {
+            opEnd++;
+        }
+        std::string_view field = term.substr(0, opStart);
+        std::string_view op = term.substr(opStart, opEnd - opStart);
+        std::string_view value = term.substr(opEnd);
+        if (value.empty()) {
+            return "missing value in '" + std::string(term) + "'";
+        }
+
+        bool ok = true;
+        if (field == "quantity") {
+            ok = applyBound(op, value, query.minQuantity, query.maxQuantity);
+        } else if (field == "price") {
+            ok = applyBound(op, value, query.minPrice, query.maxPrice);
+        } else if (op != "=") {
+            return std::string(field) + " only takes '='";
+        } else if (field == "category") {
+            query.category = value;
+        } else if (field == "name") {
+            query.namePrefix = value;
+        } else if (field == "limit") {
+            ok = parseNumber(value, query.limit);
+        } else if (field == "sort") {
+            query.descending = value.front() == '-';
+            std::string_view key = value.substr(query.descending ? 1 : 0);
+            if (key == "id") query.sortBy = QuerySort::Id;
+            else if (key == "name") query.sortBy = QuerySort::Name;
+            else if (key == "quantity") query.sortBy = QuerySort::Quantity;
+            else if (key == "price") query.sortBy = QuerySort::Price;
+            else return "sort key must be id, name, quantity or price";
+        } else {
+            return "unknown field '" + std::string(field) + "'";
+        }
+        if (!ok) {
+            return "invalid number in '" + std::string(term) + "'";
+        }
+    }
+}
+
+bool ItemQuery::matchesName(std::string_view name) const {
+    return name.size() >= namePrefix.size() &&
+           std::equal(namePrefix.begin(), namePrefix.end(), name.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) ==
+                      std::tolower(static_cast<unsigned char>(b));
+           });
+}
+
+std::uint32_t ItemColumns::codeFor(const std::string& category) {
+    auto entry = categoryCodeOf.find(category);
+    if (entry != categoryCodeOf.end()) {
+        return entry->second;
+    }
+    // "Tools/Hand" is below "Tools", as in the category tree
+    std::size_t slash = category.rfind('/');
+    std::uint32_t parent = slash == std::string::npos ? kNoCategory : codeFor(category.substr(0, slash));
+    auto code = static_cast<std::uint32_t>(categoryNames.size());
+    categoryCodeOf.emplace(category, code);
+    categoryNames.push_back(category);
+    idsByCategory.emplace_back();
+    subtreeTotals.emplace_back();
+    parentCodes.push_back(parent);
+    childCodes.emplace_back();
+    auto& siblings = parent == kNoCategory ? topLevelCodes : childCodes[parent];
+    siblings.insert(std::upper_bound(siblings.begin(), siblings.end(), code,
+                                     [this](std::uint32_t a, std::uint32_t b) {
+                                         return categoryNames[a] < categoryNames[b];
+                                     }),
+                    code);
+    return code;
+}
+
+void ItemColumns::addToCategory(std::uint32_t code, int id) {
+    auto& categoryIds = idsByCategory[code];
+    // IDs mostly arrive in increasing order, from the file or nextId
+    if (categoryIds.empty() || categoryIds.back() < id) {
+        categoryIds.push_back(id);
+    } else {
+        categoryIds.insert(std::lower_bound(categoryIds.begin(), categoryIds.end(), id), id);
+    }
+}
+
+void ItemColumns::removeFromCategory(std::uint32_t code, int id) {
+    auto& categoryIds = idsByCategory[code];
+    auto it = std::lower_bound(categoryIds.begin(), categoryIds.end(), id);
+    if (it != categoryIds.end() && *it == id) {
+        categoryIds.erase(it);
+    }
+}
+
+void ItemColumns::addRowTotals(std::uint32_t row) {
+    StockTotals totals = rowTotals(row);
+    overallTotals.add(totals);
+    for (std::uint32_t code = categoryCodes[row]; code != kNoCategory; code = parentCodes[code]) {
+        subtreeTotals[code].add(totals);
+    }
+}
+
+void ItemColumns::removeRowTotals(std::uint32_t row) {
+    StockTotals totals = rowTotals(row);
+    overallTotals.subtract(totals);
+    for (std::uint32_t code = categoryCodes[row]; code != kNoCategory; code = parentCodes[code]) {
+        subtreeTotals[code].subtract(totals);
+    }
+}
+
+void ItemColumns::upsert(const InventoryItem& item) {
+    auto [entry, added] = rowOf.try_emplace(item.getId(), static_cast<std::uint32_t>(ids.size()));
+    if (added) {
+        std::uint32_t code = codeFor(item.getCategory());
+        ids.push_back(item.getId());
+        quantities.push_back(item.getQuantity());
+        minStockLevels.push_back(item.getMinStockLevel());
+        prices.push_back(item.getPrice());
+        categoryCodes.push_back(code);
+        items.push_back(&item);
+        addToCategory(code, item.getId());
+        quantityIndex.insert(item.getQuantity(), item.getId());
+        priceIndex.insert(item.getPrice(), item.getId());
+        addRowTotals(entry->second);
+        return;
+    }
+    std::uint32_t row = entry->second;
+    removeRowTotals(row);
+    if (quantities[row] != item.getQuantity()) {
+        quantityIndex.update(quantities[row], item.getQuantity(), item.getId());
+        quantities[row] = item.getQuantity();
+    }
+    if (prices[row] != item.getPrice()) {
+        priceIndex.update(prices[row], item.getPrice(), item.getId());
+        prices[row] = item.getPrice();
+    }
+    minStockLevels[row] = item.getMinStockLevel();
+    items[row] = &item;
+    if (categoryNames[categoryCodes[row]] != item.getCategory()) {
+        std::uint32_t code = codeFor(item.getCategory());
+        removeFromCategory(categoryCodes[row], item.getId());
+        addToCategory(code, item.getId());
+        categoryCodes[row] = code;
+    }
+    addRowTotals(row);
+}
+
+void ItemColumns::erase(int id) {
+    auto entry = rowOf.find(id);
+    if (entry == rowOf.end()) {
+        return;
+    }
+    std::uint32_t row = entry->second;
+    removeRowTotals(row);
+    removeFromCategory(categoryCodes[row], id);
+    quantityIndex.erase(quantities[row], id);
+    priceIndex.erase(prices[row], id);
+    rowOf.erase(entry);
+
+    std::size_t last = ids.size() - 1;
+    if (row != last) {
+        ids[row] = ids[last];
+        quantities[row] = quantities[last];
+        minStockLevels[row] = minStockLevels[last];
+        prices[row] = prices[last];
+        categoryCodes[row] = categoryCodes[last];
+        items[row] = items[last];
+        rowOf[ids[row]] = row;
+    }
+    ids.pop_back();
+    quantities.pop_back();
+    minStockLevels.pop_back();
+    prices.pop_back();
+    categoryCodes.pop_back();
+    items.pop_back();
+}
+
+void ItemColumns::updateQuantity(const InventoryItem& item) {
+    std::uint32_t row = findRow(item.getId());
+    if (row < ids.size() && quantities[row] != item.getQuantity()) {
+        removeRowTotals(row);
+        quantityIndex.update(quantities[row], item.getQuantity(), item.getId());
+        quantities[row] = item.getQuantity();
+        addRowTotals(row);
+    }
+}
+
+void ItemColumns::clear() {
+    ids.clear();
+    quantities.clear();
+    minStockLevels.clear();
+    prices.clear();
+    categoryCodes.clear();
+    items.clear();
+    rowOf.clear();
+    categoryNames.clear();
+    categoryCodeOf.clear();
+    idsByCategory.clear();
+    parentCodes.clear();
+    childCodes.clear();
+    topLevelCodes.clear();
+    overallTotals = StockTotals();
+    subtreeTotals.clear();
+    quantityIndex.clear();
+    priceIndex.clear();
+}
+
+std::vector<std::uint8_t> ItemColumns::categoryMask(std::string_view category) const {
+    std::vector<std::uint8_t> mask(categoryNames.size());
+    for (std::size_t code = 0; code < categoryNames.size(); code++) {
+        const std::string& name = categoryNames[code];
+        mask[code] = name.starts_with(category) &&
+                     (name.size() == category.size() || name[category.size()] == '/');
+    }
+    return mask;
+}
+
+std::size_t ItemColumns::countInCategories(const std::vector<std::uint8_t>& mask) const {
+    std::size_t count = 0;
+    for (std::size_t code = 0; code < mask.size(); code++) {
+        if (mask[code]) {
+            count += idsByCategory[code].size();
+        }
+    }
+    return count;
+}
+
+void ItemColumns::idsInCategories(const std::vector<std::uint8_t>& mask,
+                                  std::vector<int>& result) const {
+    for (std::size_t code = 0; code < mask.size(); code++) {
+        if (!mask[code]) {
+            continue;
+        }
+        auto middle = static_cast<std::ptrdiff_t>(result.size());
+        result.insert(result.end(), idsByCategory[code].begin(), idsByCategory[code].end());
+        std::inplace_merge(result.begin(), result.begin() + middle, result.end());
+    }
+}
+
+bool ItemColumns::matches(std::uint32_t row, const ItemQuery& query,
+                          const std::vector<std::uint8_t>& mask) const {
+    int quantity = quantities[row];
+    double price = prices[row];
+    return quantity >= query.minQuantity && quantity <= query.maxQuantity &&
+           price >= query.minPrice && price <= query.maxPrice &&
+           (!query.lowStockOnly || quantity <= minStockLevels[row]) &&
+           (mask.empty() || mask[categoryCodes[row]]);
+}
+
+void ItemColumns::scan(const ItemQuery& query, const std::vector<std::uint8_t>& mask,
+                       std::vector<std::uint32_t>& rows) const {
+    // Rows are filtered a block at a time: the numeric filters are combined
+    // without branches into one flag per row, which the compiler evaluates
+    // several rows per instruction, then the passing rows are packed.
+    constexpr std::size_t kBlock = 1024;
+    std::uint8_t keep[kBlock];
+    const int minQuantity = query.minQuantity;
+    const int maxQuantity = query.maxQuantity;
+    const double minPrice = query.minPrice;
+    const double maxPrice = query.maxPrice;
+    const bool anyStock = !query.lowStockOnly;
+
+    for (std::size_t start = 0; start < ids.size(); start += kBlock) {
+        const std::size_t count = std::min(kBlock, ids.size() - start);
+        const int* quantity = quantities.data() + start;
+        const int* minStock = minStockLevels.data() + start;
+        const double* price = prices.data() + start;
+        for (std::size_t i = 0; i < count; i++) {
+            keep[i] = (quantity[i] >= minQuantity) & (quantity[i] <= maxQuantity) &
+                      (price[i] >= minPrice) & (price[i] <= maxPrice) &
+                      (anyStock | (quantity[i] <= minStock[i]));
+        }
+        if (!mask.empty()) {
+            const std::uint32_t* code = categoryCodes.data() + start;
+            for (std::size_t i = 0; i < count; i++) {
+                keep[i] &= mask[code[i]];
+            }
+        }
+
+        std::size_t found = rows.size();
+        rows.resize(found + count);
+        for (std::size_t i = 0; i < count; i++) {
+            rows[found] = static_cast<std::uint32_t>(start + i);
+            found += keep[i];
+        }
+        rows.resize(found);
+    }
+}
+
+void ItemColumns::addTotals(std::size_t begin, std::size_t end, RowSums* sums) const {
+    // As in scan(), the per-row arithmetic runs over a block at a time so
+    // the compiler can vectorize it. Rows are then summed in registers
+    // while their category stays the same, since adding every row straight
+    // into its category's sums would make neighbouring rows of one
+    // category wait on each other's additions.
+    constexpr std::size_t kBlock = 1024;
+    double value[kBlock];
+    std::uint8_t low[kBlock];
+    for (std::size_t start = begin; start < end; start += kBlock) {
+        const std::size_t count = std::min(kBlock, end - start);
+        const int* quantity = quantities.data() + start;
+        const int* minStock = minStockLevels.data() + start;
+        const double* price = prices.data() + start;
+        for (std::size_t i = 0; i < count; i++) {
+            value[i] = quantity[i] * price[i];
+            low[i] = quantity[i] <= minStock[i];
+        }
+        const std::uint32_t* code = categoryCodes.data() + start;
+        std::uint32_t current = code[0];
+        RowSums run;
+        for (std::size_t i = 0; i < count; i++) {
+            if (code[i] != current) {
+                sums[current].add(run);
+                run = RowSums();
+                current = code[i];
+            }
+            run.quantity += quantity[i];
+            run.value += value[i];
+            run.lowStock += low[i];
+        }
+        sums[current].add(run);
+    }
+}
+
+std::vector<StockTotals> ItemColumns::totalsByCategory(unsigned threadCount) const {
+    // Below this many rows per thread, starting a thread costs more than it saves
+    constexpr std::size_t kMinRowsPerThread = 1 << 16;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(
+        std::clamp<std::size_t>(ids.size() / kMinRowsPerThread, 1, threadCount));
+
+    // Each thread sums a contiguous slice of rows into its own sums, which
+    // are added together in thread order at the end
+    std::vector<std::vector<RowSums>> partial(threadCount, std::vector<RowSums>(categoryNames.size()));
+    auto slice = [this, threadCount](unsigned index) {
+        return ids.size() * index / threadCount;
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back([this, &partial, &slice, i]() {
+            addTotals(slice(i), slice(i + 1), partial[i].data());
+        });
+    }
+    addTotals(0, slice(1), partial[0].data());
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<StockTotals> totals(categoryNames.size());
+    for (std::size_t code = 0; code < totals.size(); code++) {
+        RowSums sums;
+        for (const auto& part : partial) {
+            sums.add(part[code]);
+        }
+        totals[code].items = idsByCategory[code].size();
+        totals[code].quantity = sums.quantity;
+        totals[code].value = sums.value;
+        totals[code].lowStock = static_cast<std::size_t>(sums.lowStock);
+    }
+    return totals;
+}
+
+void ItemColumns::rollUpCategories(std::vector<StockTotals>& totals) const {
+    for (std::size_t code = totals.size(); code-- > 0;) {
+        if (parentCodes[code] != kNoCategory) {
+            totals[parentCodes[code]].add(totals[code]);
+        }
+    }
+}
+
+std::vector<std::uint32_t> ItemColumns::categoriesInTreeOrder() const {
+    std::vector<std::uint32_t> order;
+    order.reserve(categoryNames.size());
+    std::vector<std::uint32_t> pending(topLevelCodes.rbegin(), topLevelCodes.rend());
+    while (!pending.empty()) {
+        std::uint32_t code = pending.back();
+        pending.pop_back();
+        order.push_back(code);
+        pending.insert(pending.end(), childCodes[code].rbegin(), childCodes[code].rend());
+    }
+    return order;
+}
+
+StockDrift ItemColumns::checkTotals(unsigned threadCount) {
+    std::vector<StockTotals> recount = totalsByCategory(threadCount);
+    StockTotals overall;
+    for (const auto& category : recount) {
+        overall.add(category);
+    }
+    rollUpCategories(recount);
+
+    StockDrift drift;
+    auto compare = [&drift](const StockTotals& running, const StockTotals& exact) {
+        if (running.items != exact.items || running.quantity != exact.quantity ||
+            running.lowStock != exact.lowStock) {
+            drift.mismatchedCounts++;
+        }
+        drift.maxValueError = std::max(drift.maxValueError, std::fabs(running.value - exact.value));
+    };
+    compare(overallTotals, overall);
+    for (std::size_t code = 0; code < recount.size(); code++) {
+        compare(subtreeTotals[code], recount[code]);
+    }
+    overallTotals = overall;
+    subtreeTotals = std::move(recount);
+    return drift;
+}
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class InventoryItem;
+
+enum class QuerySort { Id, Name, Quantity, Price };
+
+// Filter, order and limit of an ad-hoc inventory report. Every filter
+// left at its default matches all items.
+struct ItemQuery {
+    std::string category;    // Items in this category or any category below it
+    std::string namePrefix;  // Compared ignoring case
+    int minQuantity = std::numeric_limits<int>::min();
+    int maxQuantity = std::numeric_limits<int>::max();
+    double minPrice = -std::numeric_limits<double>::infinity();
+    double maxPrice = std::numeric_limits<double>::infinity();
+    bool lowStockOnly = false;
+    QuerySort sortBy = QuerySort::Id;
+    bool descending = false;
+    std::size_t limit = 0;  // 0 returns every match
+
+    // Parse space-separated terms, e.g.
+    //     category=Tools quantity<5 price=50..100 name=so lowstock sort=-price limit=20
+    // Quantity and price take =, <, <=, > and >= or an inclusive a..b range;
+    // sort takes id, name, quantity or price, with '-' for descending.
+    // Returns an error message, or an empty string on success.
+    static std::string parse(std::string_view text, ItemQuery& query);
+
+    // Check the name prefix, ignoring case
+    bool matchesName(std::string_view name) const;
+};
+
+// Ways the query planner can find candidate items
+enum class QueryAccess { Scan, Category, NamePrefix, QuantityRange, PriceRange };
+
+inline const char* queryAccessName(QueryAccess access) {
+    switch (access) {
+        case QueryAccess::Scan: return "column scan";
+        case QueryAccess::Category: return "category index";
+        case QueryAccess::NamePrefix: return "name index";
+        case QueryAccess::QuantityRange: return "quantity index";
+        case QueryAccess::PriceRange: return "price index";
+    }
+    return "";
+}
+
+struct QueryPlan {
+    QueryAccess access = QueryAccess::Scan;
+    std::size_t candidates = 0;  // Items the access path hands to the filters (estimate)
+};
+
+// Stock totals over a group of items
+struct StockTotals {
+    std::size_t items = 0;
+    long long quantity = 0;
+    double value = 0;          // Sum of quantity times price
+    std::size_t lowStock = 0;  // Items at or below their minimum stock level
+
+    void add(const StockTotals& other) {
+        items += other.items;
+        quantity += other.quantity;
+        value += other.value;
+        lowStock += other.lowStock;
+    }
+
+    void subtract(const StockTotals& other) {
+        items -= other.items;
+        quantity -= other.quantity;
+        value -= other.value;
+        lowStock -= other.lowStock;
+    }
+
+    double lowStockRatio() const {
+        return items == 0 ? 0.0 : static_cast<double>(lowStock) / static_cast<double>(items);
+    }
+};
+
+// How far running stock totals had drifted from a full recount
+struct StockDrift {
+    std::size_t mismatchedCounts = 0;  // Totals whose item, unit or low-stock counts differed
+    double maxValueError = 0;          // Largest difference in stock value
+};
+
+// Item IDs ordered by a key, for range lookups. Entries are kept sorted
+// by (key, ID) in blocks of at most kMaxBlock, with the first entry of
+// every block in a separate array: a lookup binary-searches that array,
+// then one block. Inserting or erasing moves at most one block's entries,
+// so a key that changes often stays cheap to maintain, and a range of k
+// entries is read in O(log n + k).
+template <typename Key>
+class RangeIndex {
+private:
+    struct Entry {
+        Key key;
+        int id;
+
+        bool operator<(const Entry& other) const {
+            return key < other.key || (key == other.key && id < other.id);
+        }
+    };
+
+    static constexpr std::size_t kMaxBlock = 512;
+
+    std::vector<std::vector<Entry>> blocks;
+    std::vector<Entry> firstEntries;  // blocks[i].front(), for each block
+    std::size_t entryCount = 0;
+
+    // The block an entry belongs in: the last one starting at or before it
+    std::size_t blockFor(const Entry& entry) const {
+        auto it = std::upper_bound(firstEntries.begin(), firstEntries.end(), entry);
+        return it == firstEntries.begin() ? 0 : static_cast<std::size_t>(it - firstEntries.begin()) - 1;
+    }
+
+    // Block and position of the first entry with a key of at least low
+    std::pair<std::size_t, std::size_t> lowerBound(Key low) const {
+        Entry probe{low, std::numeric_limits<int>::min()};
+        std::size_t block = blockFor(probe);
+        if (block < blocks.size()) {
+            const auto& entries = blocks[block];
+            auto it = std::lower_bound(entries.begin(), entries.end(), probe);
+            return {block, static_cast<std::size_t>(it - entries.begin())};
+        }
+        return {block, 0};
+    }
+
+public:
+    void insert(Key key, int id) {
+        Entry entry{key, id};
+        if (blocks.empty()) {
+            blocks.emplace_back(1, entry);
+            firstEntries.push_back(entry);
+            entryCount++;
+            return;
+        }
+        std::size_t block = blockFor(entry);
+        auto& entries = blocks[block];
+        entries.insert(std::upper_bound(entries.begin(), entries.end(), entry), entry);
+        firstEntries[block] = entries.front();
+        entryCount++;
+        if (entries.size() > kMaxBlock) {
+            std::vector<Entry> upper(entries.begin() + kMaxBlock / 2, entries.end());
+            entries.resize(kMaxBlock / 2);
+            firstEntries.insert(firstEntries.begin() + static_cast<std::ptrdiff_t>(block) + 1, upper.front());
+            blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(block) + 1, std::move(upper));
+        }
+    }
+
+    void erase(Key key, int id) {
+        Entry entry{key, id};
+        std::size_t block = blockFor(entry);
+        if (block >= blocks.size()) {
+            return;
+        }
+        auto& entries = blocks[block];
+        auto it = std::lower_bound(entries.begin(), entries.end(), entry);
+        if (it == entries.end() || it->key != key || it->id != id) {
+            return;
+        }
+        entries.erase(it);
+        entryCount--;
+        if (entries.empty()) {
+            blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(block));
+            firstEntries.erase(firstEntries.begin() + static_cast<std::ptrdiff_t>(block));
+        } else {
+            firstEntries[block] = entries.front();
+        }
+    }
+
+    // Move an entry to a new key. Stock usually changes by a little, so
+    // when the entry stays in its block it is rotated into place there.
+    void update(Key oldKey, Key newKey, int id) {
+        Entry from{oldKey, id};
+        Entry to{newKey, id};
+        std::size_t block = blockFor(from);
+        bool staysInBlock = block < blocks.size() && (block == 0 || !(to < firstEntries[block])) &&
+                            (block + 1 == blocks.size() || to < firstEntries[block + 1]);
+        if (!staysInBlock) {
+            erase(oldKey, id);
+            insert(newKey, id);
+            return;
+        }
+        auto& entries = blocks[block];
+        auto it = std::lower_bound(entries.begin(), entries.end(), from);
+        if (it == entries.end() || it->key != oldKey || it->id != id) {
+            insert(newKey, id);
+            return;
+        }
+        if (to < from) {
+            auto target = std::upper_bound(entries.begin(), it, to);
+            std::rotate(target, it, it + 1);
+            *target = to;
+        } else {
+            auto target = std::lower_bound(it + 1, entries.end(), to);
+            std::rotate(it, it + 1, target);
+            *(target - 1) = to;
+        }
+        firstEntries[block] = entries.front();
+    }
+
+    void clear() {
+        blocks.clear();
+        firstEntries.clear();
+        entryCount = 0;
+    }
+
+    std::size_t size() const { return entryCount; }
+
+    // Entries with a key in [low, high], counted no further than limit, so
+    // the planner can stop once an index is no better than another
+    std::size_t count(Key low, Key high, std::size_t limit) const {
+        if (low > high) {
+            return 0;
+        }
+        auto [block, pos] = lowerBound(low);
+        std::size_t total = 0;
+        for (; block < blocks.size() && total < limit; block++, pos = 0) {
+            const auto& entries = blocks[block];
+            if (entries.back().key <= high) {
+                total += entries.size() - pos;
+                continue;
+            }
+            Entry end{high, std::numeric_limits<int>::max()};
+            total += static_cast<std::size_t>(
+                std::upper_bound(entries.begin() + static_cast<std::ptrdiff_t>(pos), entries.end(), end) -
+                (entries.begin() + static_cast<std::ptrdiff_t>(pos)));
+            break;
+        }
+        return std::min(total, limit);
+    }
+
+    // Append the IDs with a key in [low, high], in key order
+    void idsInRange(Key low, Key high, std::vector<int>& ids) const {
+        if (low > high) {
+            return;
+        }
+        auto [block, pos] = lowerBound(low);
+        for (; block < blocks.size(); block++, pos = 0) {
+            const auto& entries = blocks[block];
+            for (; pos < entries.size(); pos++) {
+                if (entries[pos].key > high) {
+                    return;
+                }
+                ids.push_back(entries[pos].id);
+            }
+        }
+    }
+};
+
+// The fields reports filter on, stored column by column with one row per
+// item, so a scan streams through a few dense arrays instead of chasing
+// map nodes. Rows are in no particular order: removing an item moves the
+// last row into its place. Items are referenced by pointer, so they must
+// not move while indexed (std::map nodes never do).
+//
+// Each category also keeps the sorted IDs of its items, and quantities
+// and prices are kept in range indexes; the planner uses all three.
+class ItemColumns {
+private:
+    std::vector<int> ids;
+    std::vector<int> quantities;
+    std::vector<int> minStockLevels;
+    std::vector<double> prices;
+    std::vector<std::uint32_t> categoryCodes;
+    std::vector<const InventoryItem*> items;
+    std::unordered_map<int, std::uint32_t> rowOf;
+
+    // Every category and every category above it has a code; a parent's
+    // code is always below its subcategories' codes
+    std::vector<std::string> categoryNames;  // By code
+    std::unordered_map<std::string, std::uint32_t> categoryCodeOf;
+    std::vector<std::vector<int>> idsByCategory;
+    std::vector<std::uint32_t> parentCodes;                // kNoCategory at the top level
+    std::vector<std::vector<std::uint32_t>> childCodes;  // Sorted by name
+    std::vector<std::uint32_t> topLevelCodes;            // Sorted by name
+
+    // Running stock totals of every item, and of each category with the
+    // categories below it, changed by each row as it is added, updated or
+    // removed
+    StockTotals overallTotals;
+    std::vector<StockTotals> subtreeTotals;  // By code
+
+    StockTotals rowTotals(std::uint32_t row) const {
+        return {1, quantities[row], quantities[row] * prices[row],
+                quantities[row] <= minStockLevels[row] ? 1u : 0u};
+    }
+    void addRowTotals(std::uint32_t row);
+    void removeRowTotals(std::uint32_t row);
+    RangeIndex<int> quantityIndex;
+    RangeIndex<double> priceIndex;
+
+    std::uint32_t codeFor(const std::string& category);
+
+    // Sums over some rows of one category; the item count is known already
+    struct RowSums {
+        long long quantity = 0;
+        double value = 0;
+        long long lowStock = 0;
+
+        void add(const RowSums& other) {
+            quantity += other.quantity;
+            value += other.value;
+            lowStock += other.lowStock;
+        }
+    };
+
+    // Add rows [begin, end) to sums, which has one entry per category code
+    void addTotals(std::size_t begin, std::size_t end, RowSums* sums) const;
+    void addToCategory(std::uint32_t code, int id);
+    void removeFromCategory(std::uint32_t code, int id);
+
+public:
+    static constexpr std::uint32_t kNoCategory = std::numeric_limits<std::uint32_t>::max();
+
+    // Index item, or re-read its fields if it is indexed already
+    void upsert(const InventoryItem& item);
+
+    void erase(int id);
+
+    // Re-read the quantity of an indexed item after it changed
+    void updateQuantity(const InventoryItem& item);
+
+    void clear();
+
+    std::size_t size() const { return ids.size(); }
+
+    const InventoryItem& item(std::uint32_t row) const { return *items[row]; }
+    int quantity(std::uint32_t row) const { return quantities[row]; }
+    double price(std::uint32_t row) const { return prices[row]; }
+
+    // Row of an item, or size() if it is not indexed
+    std::uint32_t findRow(int id) const {
+        auto entry = rowOf.find(id);
+        return entry != rowOf.end() ? entry->second : static_cast<std::uint32_t>(ids.size());
+    }
+
+    // One flag per category code, set for category and every category
+    // below it ("Tools" covers "Tools/Hand" but not "Toolsets")
+    std::vector<std::uint8_t> categoryMask(std::string_view category) const;
+
+    // Items in the categories set in mask, and their IDs in sorted order
+    std::size_t countInCategories(const std::vector<std::uint8_t>& mask) const;
+    void idsInCategories(const std::vector<std::uint8_t>& mask, std::vector<int>& result) const;
+
+    const std::string& categoryName(std::uint32_t code) const { return categoryNames[code]; }
+
+    // Code of a category, or kNoCategory if no item was ever in it
+    std::uint32_t findCategory(const std::string& category) const {
+        auto entry = categoryCodeOf.find(category);
+        return entry != categoryCodeOf.end() ? entry->second : kNoCategory;
+    }
+
+    // Category codes depth first, each parent followed by its subcategories
+    // and siblings in name order
+    std::vector<std::uint32_t> categoriesInTreeOrder() const;
+
+    // Stock totals of the items directly in each category, by category
+    // code. The rows are split between up to threadCount threads (0 for one
+    // per hardware thread); small tables are summed on the calling thread.
+    std::vector<StockTotals> totalsByCategory(unsigned threadCount) const;
+
+    // Add the totals of every category to the category above it, so each
+    // one covers its whole subtree
+    void rollUpCategories(std::vector<StockTotals>& totals) const;
+
+    // Running totals of every item, and of a category and the categories
+    // below it, without reading any rows
+    const StockTotals& runningTotals() const { return overallTotals; }
+    const StockTotals& runningTotals(std::uint32_t code) const { return subtreeTotals[code]; }
+
+    // Recount the running totals from the rows and replace them with the
+    // recount. Integer counts only differ if a change bypassed the columns;
+    // stock values also collect rounding error from repeated updates.
+    StockDrift checkTotals(unsigned threadCount);
+
+    const RangeIndex<int>& byQuantity() const { return quantityIndex; }
+    const RangeIndex<double>& byPrice() const { return priceIndex; }
+
+    // Check the quantity, price, low-stock and category filters of query
+    // against one row. An empty mask accepts every category.
+    bool matches(std::uint32_t row, const ItemQuery& query,
+                 const std::vector<std::uint8_t>& mask) const;
+
+    // Append the rows passing those filters, in row order
+    void scan(const ItemQuery& query, const std::vector<std::uint8_t>& mask,
+              std::vector<std::uint32_t>& rows) const;
+};
@@ -0,0 +1,394 @@
+#include "commands.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+// Workload replayer for WarehouseSystem
+//
+// Usage: replay TRACE --inventory CSV [--repeat N]
+//        replay --generate TRACE --inventory CSV [--ops N] [--items N]
+//               [--seed S] [--mix find=70,order=12,...]
+//
+// A trace holds one command per line in the comma-separated syntax of
+// commands.h, which is what `project --record FILE` writes. Traces are
+// parsed and run by the same code as the CLI's batch mode, so every
+// command the CLI records can be replayed, for example:
+//     find,12
+//     search,soap
+//     query,category=C1 price<50 sort=-quantity limit=10
+//     order,12,3
+//     multiorder,12:3 40:1
+//     process
+//     category,Tools
+//     sort,name
+//     status,7,Shipped
+//     amend,7,2,12
+//     receiveat,12,East/A/01,40
+//     movestock,12,East/A/01,West/B/02,5
+// Every pass loads a scratch copy of the inventory file with auto-save off
+// and output discarded, so the same trace always does the same work. Each
+// pass prints a fingerprint of the lookups, order queue and final stock;
+// passes that disagree make the replay fail.
+//
+// Built with -DWAREHOUSE_PGO=GENERATE, replaying a recorded trace is the
+// training run for the profile-guided build (see the pgo-train target).
+
+struct ReplayConfig {
+    std::string tracePath;
+    std::string inventoryPath;
+    int repeat = 1;
+    bool generate = false;
+    std::size_t ops = 50000;
+    int items = 10000;
+    unsigned seed = 42;
+    std::string mix = "find=70,order=12,process=12,lowstock=2,category=2,sort=1,history=1";
+};
+
+// Stream buffer that drops everything written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Redirects std::cout to a NullBuffer for the lifetime of the object
+class SilenceOutput {
+private:
+    NullBuffer buffer;
+    std::streambuf* previous;
+
+public:
+    SilenceOutput() : previous(std::cout.rdbuf(&buffer)) {}
+    ~SilenceOutput() { std::cout.rdbuf(previous); }
+};
+
+bool readTrace(const std::string& path, std::vector<Command>& commands) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open trace file: " << path << "\n";
+        return false;
+    }
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!isCommandLine(line)) {
+            continue;
+        }
+        Command command;
+        std::string error = parseCommand(line, command);
+        if (error.empty() && !commandSpec(command.kind).recorded) {
+            error = "'" + commandSpec(command.kind).name + "' cannot be replayed";
+        }
+        if (!error.empty()) {
+            std::cerr << path << ":" << lineNumber << ": " << error << "\n";
+            return false;
+        }
+        commands.push_back(std::move(command));
+    }
+    return true;
+}
+
+// FNV-1a over the bytes of each value
+class Fingerprint {
+private:
+    std::uint64_t hash = 14695981039346656037ull;
+
+public:
+    void add(std::uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 1099511628211ull;
+        }
+    }
+    std::uint64_t value() const { return hash; }
+};
+
+struct ReplayResult {
+    double seconds = 0;
+    std::uint64_t fingerprint = 0;
+    std::array<std::size_t, kCommandKindCount> counts{};
+};
+
+ReplayResult replayTrace(const std::vector<Command>& commands, const std::string& inventoryPath,
+                         const std::string& scratchPath) {
+    std::filesystem::copy_file(inventoryPath, scratchPath,
+                               std::filesystem::copy_options::overwrite_existing);
+    // Every pass starts with no orders, received stock or locations
+    std::filesystem::remove(WarehouseSystem::orderLogPathFor(scratchPath));
+    std::filesystem::remove(WarehouseSystem::stockLogPathFor(scratchPath));
+    std::filesystem::remove(WarehouseSystem::locationsPathFor(scratchPath));
+    ReplayResult result;
+    Fingerprint fingerprint;
+    SilenceOutput silence;
+    WarehouseSystem system(scratchPath);
+    system.setAutoSave(false);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& command : commands) {
+        result.counts[static_cast<std::size_t>(command.kind)]++;
+        auto outcome = executeCommand(system, command);
+        for (std::size_t i = 0; i < outcome.observedCount; i++) {
+            fingerprint.add(outcome.observed[i]);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const auto& item : system.getAllItems()) {
+        fingerprint.add(static_cast<std::uint64_t>(item.getId()));
+        fingerprint.add(static_cast<std::uint64_t>(item.getQuantity()));
+    }
+    result.fingerprint = fingerprint.value();
+    return result;
+}
+
+// Commands --generate can write; the others only come from recorded traces
+bool isGeneratedCommand(CommandKind kind) {
+    switch (kind) {
+        case CommandKind::Add:
+        case CommandKind::Update:
+        case CommandKind::Remove:
+        case CommandKind::Status:
+        case CommandKind::ReceiveAt:
+        case CommandKind::MoveStock:
+        case CommandKind::Policy:
+            return false;
+        default:
+            return commandSpec(kind).recorded;
+    }
+}
+
+// Parse "find=70,order=12,..." into weights indexed by CommandKind
+bool parseMix(const std::string& text, std::array<int, kCommandKindCount>& weights) {
+    weights.fill(0);
+    std::stringstream ss(text);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        auto equals = entry.find('=');
+        if (equals == std::string::npos) {
+            std::cerr << "Mix entries must look like name=weight: " << entry << "\n";
+            return false;
+        }
+        std::string name = entry.substr(0, equals);
+        int weight = std::max(0, std::atoi(entry.c_str() + equals + 1));
+        auto spec = findCommandSpec(name);
+        if (!spec || !isGeneratedCommand(spec->kind)) {
+            std::cerr << "Unknown command in mix: " << name << "\n";
+            return false;
+        }
+        weights[static_cast<std::size_t>(spec->kind)] += weight;
+    }
+    return true;
+}
+
+// Write a synthetic inventory and a trace drawn from the configured mix
+bool generateWorkload(const ReplayConfig& config) {
+    std::array<int, kCommandKindCount> weights;
+    if (!parseMix(config.mix, weights)) {
+        return false;
+    }
+    std::mt19937 random(config.seed);
+
+    std::vector<std::string> categories;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            std::string top = std::string("C") + std::to_string(i);
+            categories.push_back(top + "/" + top + "." + std::to_string(j));
+        }
+    }
+    std::uniform_int_distribution<std::size_t> category(0, categories.size() - 1);
+
+    std::ofstream inventory(config.inventoryPath);
+    if (!inventory) {
+        std::cerr << "Cannot write inventory file: " << config.inventoryPath << "\n";
+        return false;
+    }
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<int> quantity(0, 1000);
+    std::uniform_int_distribution<int> minStock(0, 50);
+    std::uniform_real_distribution<double> price(0.5, 500.0);
+    inventory << "ID,Name,Category,Quantity,Price,MinStockLevel\n";
+    std::vector<std::string> names;  // Search queries are cut from these
+    for (int id = 1; id <= config.items; id++) {
+        std::string name(10, 'a');
+        for (auto& c : name) {
+            c = static_cast<char>('a' + letter(random));
+        }
+        name[0] = static_cast<char>(name[0] - 'a' + 'A');
+        inventory << id << "," << name << "," << categories[category(random)] << ","
+                  << quantity(random) << "," << std::fixed << std::setprecision(2)
+                  << price(random) << "," << minStock(random) << "\n";
+        names.push_back(std::move(name));
+    }
+
+    std::ofstream trace(config.tracePath);
+    if (!trace) {
+        std::cerr << "Cannot write trace file: " << config.tracePath << "\n";
+        return false;
+    }
+    std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> id(1, config.items);
+    std::uniform_int_distribution<int> orderQuantity(1, 20);
+    int ordersPlaced = 0;
+    trace << "# Generated with seed " << config.seed << ", mix " << config.mix << "\n";
+    for (std::size_t i = 0; i < config.ops; i++) {
+        auto command = static_cast<CommandKind>(pick(random));
+        bool needsOrder = command == CommandKind::Cancel || command == CommandKind::Amend ||
+                          command == CommandKind::GetOrder;
+        if (needsOrder && ordersPlaced == 0) {
+            command = CommandKind::Order;
+        }
+        trace << commandSpec(command).name;
+        if (command == CommandKind::Find || command == CommandKind::ItemOrders ||
+            command == CommandKind::Locations) {
+            trace << "," << id(random);
+        } else if (command == CommandKind::Search) {
+            const std::string& name = names[static_cast<std::size_t>(id(random) - 1)];
+            std::size_t length = std::uniform_int_distribution<std::size_t>(3, name.size())(random);
+            std::size_t start = std::uniform_int_distribution<std::size_t>(0, name.size() - length)(random);
+            trace << "," << name.substr(start, length);
+        } else if (command == CommandKind::Query) {
+            // One query for each access path the planner can pick
+            int low = std::uniform_int_distribution<int>(1, 400)(random);
+            switch (std::uniform_int_distribution<int>(0, 2)(random)) {
+                case 0:
+                    trace << ",category=" << categories[category(random)].substr(0, 2) << " price="
+                          << low << ".." << low + 50 << " sort=-quantity limit=10";
+                    break;
+                case 1:
+                    trace << ",quantity<" << low / 8 << " lowstock sort=price limit=10";
+                    break;
+                default:
+                    trace << ",name=" << names[static_cast<std::size_t>(id(random) - 1)].substr(0, 2)
+                          << " quantity>" << low;
+                    break;
+            }
+        } else if (command == CommandKind::Order) {
+            trace << "," << id(random) << "," << orderQuantity(random);
+            ordersPlaced++;
+        } else if (command == CommandKind::Receive) {
+            trace << "," << id(random) << "," << 10 * orderQuantity(random);
+        } else if (command == CommandKind::MultiOrder || command == CommandKind::Shipment) {
+            int lineCount = std::uniform_int_distribution<int>(2, 10)(random);
+            for (int line = 0; line < lineCount; line++) {
+                trace << (line == 0 ? "," : " ") << id(random) << ":" << orderQuantity(random);
+            }
+            ordersPlaced += command == CommandKind::MultiOrder;
+        } else if (needsOrder) {
+            trace << "," << std::uniform_int_distribution<int>(1, ordersPlaced)(random);
+            if (command == CommandKind::Amend) {
+                trace << "," << orderQuantity(random);
+            }
+        } else if (command == CommandKind::Category) {
+            trace << "," << categories[category(random)];
+        } else if (command == CommandKind::Orders) {
+            trace << ",Backordered";
+        } else if (command == CommandKind::Sort) {
+            trace << (random() % 2 ? ",quantity" : ",name");
+        }
+        trace << "\n";
+    }
+    std::cout << "Wrote " << config.items << " items to " << config.inventoryPath
+              << " and " << config.ops << " commands to " << config.tracePath << "\n";
+    return true;
+}
+
+bool parseArguments(int argc, char* argv[], ReplayConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag.rfind("--", 0) != 0) {
+            config.tracePath = flag;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (flag == "--generate") {
+            config.generate = true;
+            config.tracePath = value;
+        }
+        else if (flag == "--inventory") config.inventoryPath = value;
+        else if (flag == "--repeat") config.repeat = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--ops") config.ops = static_cast<std::size_t>(std::max(1, std::atoi(value.c_str())));
+        else if (flag == "--items") config.items = std::max(1, std::atoi(value.c_str()));
+        else if (flag == "--seed") config.seed = static_cast<unsigned>(std::atoi(value.c_str()));
+        else if (flag == "--mix") config.mix = value;
+        else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    if (config.tracePath.empty() || config.inventoryPath.empty()) {
+        std::cerr << "Usage: replay TRACE --inventory CSV [--repeat N]\n"
+                  << "       replay --generate TRACE --inventory CSV [--ops N] [--items N]"
+                  << " [--seed S] [--mix find=70,order=12,...]\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ReplayConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        return 1;
+    }
+    if (config.generate) {
+        return generateWorkload(config) ? 0 : 1;
+    }
+
+    std::vector<Command> commands;
+    if (!readTrace(config.tracePath, commands)) {
+        return 1;
+    }
+    if (!std::filesystem::exists(config.inventoryPath)) {
+        std::cerr << "Cannot open inventory file: " << config.inventoryPath << "\n";
+        return 1;
+    }
+    auto scratchPath = (std::filesystem::temp_directory_path() / "warehouse_replay.csv").string();
+
+    std::uint64_t expected = 0;
+    bool consistent = true;
+    for (int pass = 1; pass <= config.repeat; pass++) {
+        auto result = replayTrace(commands, config.inventoryPath, scratchPath);
+        if (pass == 1) {
+            expected = result.fingerprint;
+            std::cout << "Replaying " << commands.size() << " commands:";
+            for (std::size_t i = 0; i < kCommandKindCount; i++) {
+                if (result.counts[i] > 0) {
+                    std::cout << " " << commandSpec(static_cast<CommandKind>(i)).name
+                              << "=" << result.counts[i];
+                }
+            }
+            std::cout << "\n";
+        }
+        std::cout << "Pass " << pass << ": " << std::fixed << std::setprecision(3)
+                  << result.seconds << " s, " << std::setprecision(0)
+                  << (result.seconds > 0 ? commands.size() / result.seconds : 0.0)
+                  << " commands/s, fingerprint " << std::hex << std::setw(16)
+                  << std::setfill('0') << result.fingerprint << std::dec << std::setfill(' ') << "\n";
+        if (result.fingerprint != expected) {
+            consistent = false;
+        }
+    }
+
+    std::remove(scratchPath.c_str());
+    std::remove(WarehouseSystem::orderLogPathFor(scratchPath).c_str());
+    std::remove(WarehouseSystem::stockLogPathFor(scratchPath).c_str());
+    std::remove(WarehouseSystem::locationsPathFor(scratchPath).c_str());
+    if (!consistent) {
+        std::cerr << "Passes produced different results; the replay is not deterministic\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "replenishment.h"
+
+#include <algorithm>
+#include <iterator>
+
+bool ReplenishmentQueue::request(int itemId, const std::string& category, int quantity,
+                                 std::time_t now) {
+    auto [entry, added] = requests.try_emplace(itemId, nullptr);
+    if (!added) {
+        return false;
+    }
+    auto draft = drafts.try_emplace(category).first;
+    draft->second.category = category;
+    draft->second.lines.push_back({itemId, quantity});
+    entry->second = &draft->second;
+    if (draft->second.lines.size() >= maxLinesPerOrder) {
+        issue(draft, now);
+    }
+    return true;
+}
+
+void ReplenishmentQueue::settle(int itemId) {
+    auto entry = requests.find(itemId);
+    if (entry == requests.end()) {
+        return;
+    }
+    if (RestockOrder* draft = entry->second) {
+        auto& lines = draft->lines;
+        lines.erase(std::find_if(lines.begin(), lines.end(),
+                                 [itemId](const RestockLine& line) { return line.itemId == itemId; }));
+        if (lines.empty()) {
+            std::string category = draft->category;  // The key must outlive the erase
+            drafts.erase(category);
+        }
+    }
+    requests.erase(entry);
+}
+
+int ReplenishmentQueue::receive(int itemId, int quantity) {
+    int received = 0;
+    bool stillInbound = false;
+    auto byItem = [](const RestockLine& line, int id) { return line.itemId < id; };
+    for (auto order = inbound.begin(); order != inbound.end();) {
+        auto& lines = order->lines;
+        auto line = std::lower_bound(lines.begin(), lines.end(), itemId, byItem);
+        if (line != lines.end() && line->itemId == itemId) {
+            int taken = std::min(line->quantity, quantity - received);
+            received += taken;
+            line->quantity -= taken;
+            if (line->quantity > 0) {
+                stillInbound = true;
+            } else {
+                lines.erase(line);
+            }
+        }
+        order = lines.empty() ? inbound.erase(order) : std::next(order);
+    }
+    auto entry = requests.find(itemId);
+    if (!stillInbound && entry != requests.end() && entry->second == nullptr) {
+        requests.erase(entry);
+    }
+    return received;
+}
+
+void ReplenishmentQueue::issue(std::unordered_map<std::string, RestockOrder>::iterator draft,
+                               std::time_t now) {
+    RestockOrder& order = inbound.emplace_back(std::move(draft->second));
+    drafts.erase(draft);
+    order.restockId = nextRestockId++;
+    order.issuedTime = now;
+    std::sort(order.lines.begin(), order.lines.end(),
+              [](const RestockLine& a, const RestockLine& b) { return a.itemId < b.itemId; });
+    for (const auto& line : order.lines) {
+        requests[line.itemId] = nullptr;
+    }
+}
+
+std::size_t ReplenishmentQueue::issueAll(std::time_t now) {
+    std::vector<std::string> categories;
+    categories.reserve(drafts.size());
+    for (const auto& [category, draft] : drafts) {
+        categories.push_back(category);
+    }
+    std::sort(categories.begin(), categories.end());
+    for (const auto& category : categories) {
+        issue(drafts.find(category), now);
+    }
+    return categories.size();
+}
+
+std::vector<RestockOrder> ReplenishmentQueue::getDrafts() const {
+    std::vector<RestockOrder> result;
+    result.reserve(drafts.size());
+    for (const auto& [category, draft] : drafts) {
+        result.push_back(draft);
+    }
+    std::sort(result.begin(), result.end(), [](const RestockOrder& a, const RestockOrder& b) {
+        return a.category < b.category;
+    });
+    return result;
+}
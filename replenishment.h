@@ -0,0 +1,83 @@
+#pragma once
+
+#include "location.h"
+
+#include <cstddef>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RestockLine {
+    int itemId;
+    int quantity;
+    LocationId location = kNoLocation;  // Bin the stock is put away in, if any
+};
+
+// Stock to buy from the supplier of one category. Items of a category
+// are bought together, so each category has at most one draft at a time.
+struct RestockOrder {
+    int restockId = 0;         // 0 while the order is a draft
+    std::string category;
+    std::time_t issuedTime = 0;
+    std::vector<RestockLine> lines;  // Sorted by item ID once issued
+};
+
+// Restock orders raised as items run low. Each item has at most one
+// request out: asking again while one is drafted or issued changes
+// nothing, and the request only goes away when the item is no longer
+// low on stock, is removed, or has its issued stock delivered in full.
+// Requests gather in a draft per category, which is issued to the
+// inbound queue once it holds maxLinesPerOrder lines or when every draft
+// is issued at once. Issued orders leave the queue as they are received.
+class ReplenishmentQueue {
+private:
+    std::size_t maxLinesPerOrder;
+    int nextRestockId = 1;
+    std::unordered_map<std::string, RestockOrder> drafts;  // By category
+    std::deque<RestockOrder> inbound;                      // Issued, oldest first
+    // Items with a request out, and the draft holding it (nullptr once issued)
+    std::unordered_map<int, RestockOrder*> requests;
+
+    void issue(std::unordered_map<std::string, RestockOrder>::iterator draft, std::time_t now);
+
+public:
+    explicit ReplenishmentQueue(std::size_t maxLinesPerOrder = 50)
+        : maxLinesPerOrder(maxLinesPerOrder) {}
+
+    // Ask for quantity units of an item for its category's draft. Returns
+    // false if the item already has a request out. A draft that fills up
+    // is issued on the spot.
+    bool request(int itemId, const std::string& category, int quantity, std::time_t now);
+
+    // Drop the request of an item that no longer needs one. A drafted line
+    // is taken out of its draft; an issued order stays in the inbound
+    // queue until it is received, but the item may ask again.
+    void settle(int itemId);
+
+    // Take delivered units of an item off its issued lines, oldest order
+    // first. A line delivered in full is closed, and an order with every
+    // line closed is dropped. Once nothing is left inbound for the item,
+    // an issued request goes away too. Returns the units that were on
+    // order; the rest of the delivery was not asked for.
+    int receive(int itemId, int quantity);
+
+    // Issue every draft, in category order. Returns the number issued.
+    std::size_t issueAll(std::time_t now);
+
+    bool hasRequest(int itemId) const { return requests.count(itemId) != 0; }
+
+    // Whether the item's request is still in a draft
+    bool isDrafted(int itemId) const {
+        auto entry = requests.find(itemId);
+        return entry != requests.end() && entry->second != nullptr;
+    }
+
+    // Drafts in category order
+    std::vector<RestockOrder> getDrafts() const;
+    std::size_t getDraftCount() const { return drafts.size(); }
+
+    // Issued orders, oldest first
+    const std::deque<RestockOrder>& getInbound() const { return inbound; }
+};
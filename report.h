@@ -0,0 +1,197 @@
+#pragma once
+
+#include "warehouse.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Item reports
+//
+// A report is a type: its columns, the items it keeps and the order it
+// lists them in are all template arguments, so each report compiles to
+// its own loop over the inventory with the filter, comparator and column
+// formatting inlined, and defining another report costs nothing at run
+// time. For example
+//     using LowStockReport = report::Report<
+//         report::Fields<report::Column<"ID", &InventoryItem::getId>,
+//                        report::Column<"Min Stock", &InventoryItem::getMinStockLevel>>,
+//         report::LowStock>;
+//     LowStockReport::write(std::cout, inventory, "Low Stock Items:\n");
+namespace report {
+
+// Column label usable as a template argument
+template <std::size_t N>
+struct Label {
+    char text[N];
+
+    constexpr Label(const char (&label)[N]) { std::copy(label, label + N, text); }
+
+    constexpr std::string_view view() const { return std::string_view(text, N - 1); }
+};
+
+inline void appendValue(std::string& out, std::string_view value) { out.append(value); }
+
+inline void appendValue(std::string& out, int value) {
+    char buffer[16];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+// Prices, with two decimals as in the inventory file
+inline void appendValue(std::string& out, double value) {
+    char buffer[320];  // Room for any double in fixed notation
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                     std::chars_format::fixed, 2).ptr);
+}
+
+// One field of an item: a label, the getter that reads it and, in tables,
+// the width it is right-aligned to
+template <Label Name, auto Getter, std::size_t Width = 0>
+struct Column {
+    static constexpr std::string_view name = Name.view();
+    static constexpr std::size_t width = Width;
+
+    static void append(std::string& out, const InventoryItem& item) {
+        appendValue(out, (item.*Getter)());
+    }
+};
+
+// Pad what was appended since start on the left to width characters
+inline void alignRight(std::string& out, std::size_t start, std::size_t width) {
+    std::size_t length = out.size() - start;
+    if (length < width) {
+        out.insert(start, width - length, ' ');
+    }
+}
+
+// Columns separated by " | " under a header row and a rule
+template <typename... Columns>
+struct Table {
+    static void header(std::string& out) {
+        bool first = true;
+        ((out.append(first ? "" : " | "), first = false,
+          out.append(Columns::width > Columns::name.size() ? Columns::width - Columns::name.size() : 0, ' '),
+          out.append(Columns::name)),
+         ...);
+        out += '\n';
+        out.append(80, '-');
+        out += '\n';
+    }
+
+    static void row(std::string& out, const InventoryItem& item) {
+        bool first = true;
+        ((out.append(first ? "" : " | "), first = false,
+          appendAligned<Columns>(out, item)),
+         ...);
+        out += '\n';
+    }
+
+private:
+    template <typename Column>
+    static void appendAligned(std::string& out, const InventoryItem& item) {
+        std::size_t start = out.size();
+        Column::append(out, item);
+        alignRight(out, start, Column::width);
+    }
+};
+
+// One line per item of "Label: value" pairs separated by commas
+template <typename... Columns>
+struct Fields {
+    static void header(std::string&) {}
+
+    static void row(std::string& out, const InventoryItem& item) {
+        bool first = true;
+        ((out.append(first ? "" : ", "), first = false,
+          out.append(Columns::name), out.append(": "), Columns::append(out, item)),
+         ...);
+        out += '\n';
+    }
+};
+
+// Filters
+struct AnyItem {
+    bool operator()(const InventoryItem&) const { return true; }
+};
+
+struct LowStock {
+    bool operator()(const InventoryItem& item) const { return item.isLowStock(); }
+};
+
+struct InCategory {
+    std::string_view category;
+
+    bool operator()(const InventoryItem& item) const { return item.getCategory() == category; }
+};
+
+// Orders. ById is the inventory's own order and needs no sorting; the
+// others break ties by ID.
+struct ById {};
+
+struct ByName {
+    bool operator()(const InventoryItem* a, const InventoryItem* b) const {
+        int order = a->getName().compare(b->getName());
+        return order != 0 ? order < 0 : a->getId() < b->getId();
+    }
+};
+
+struct ByQuantity {
+    bool operator()(const InventoryItem* a, const InventoryItem* b) const {
+        return a->getQuantity() != b->getQuantity() ? a->getQuantity() < b->getQuantity()
+                                                    : a->getId() < b->getId();
+    }
+};
+
+template <typename Layout, typename Filter = AnyItem, typename Order = ById>
+struct Report {
+    // Write heading, the layout's header and a row for every item passing
+    // filter, or nothing if none does. Rows are formatted into a buffer
+    // that is written out in large pieces. Returns the number of rows.
+    static std::size_t write(std::ostream& out, const std::map<int, InventoryItem>& items,
+                             std::string_view heading, const Filter& filter = {}) {
+        constexpr std::size_t kFlushSize = 64 * 1024;
+        std::string buffer;
+        std::size_t rows = 0;
+        auto emit = [&](const InventoryItem& item) {
+            if (rows++ == 0) {
+                buffer.append(heading);
+                Layout::header(buffer);
+            }
+            Layout::row(buffer, item);
+            if (buffer.size() >= kFlushSize) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        };
+
+        if constexpr (std::is_same_v<Order, ById>) {
+            for (const auto& [id, item] : items) {
+                if (filter(item)) {
+                    emit(item);
+                }
+            }
+        } else {
+            // Only the items that pass are sorted, by pointer
+            std::vector<const InventoryItem*> selected;
+            for (const auto& [id, item] : items) {
+                if (filter(item)) {
+                    selected.push_back(&item);
+                }
+            }
+            std::sort(selected.begin(), selected.end(), Order());
+            for (const auto* item : selected) {
+                emit(*item);
+            }
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        return rows;
+    }
+};
+
+}  // namespace report
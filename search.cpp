@@ -0,0 +1,498 @@
+#include "search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace {
+
+const char kStartMarker = '\x01';
+const char kEndMarker = '\x02';
+const std::size_t kGramLength = 4;
+
+// Fewest edits turning pattern into some substring of text, counting a
+// swap of neighbouring characters as one edit
+int substringDistance(std::string_view pattern, std::string_view text, std::vector<int>& columns) {
+    const std::size_t rows = pattern.size() + 1;
+    columns.resize(3 * rows);
+    int* beforePrevious = columns.data();
+    int* previous = beforePrevious + rows;
+    int* current = previous + rows;
+    for (std::size_t i = 0; i < rows; i++) {
+        previous[i] = static_cast<int>(i);
+    }
+    int best = previous[rows - 1];
+    for (std::size_t j = 0; j < text.size(); j++) {
+        current[0] = 0;
+        for (std::size_t i = 1; i < rows; i++) {
+            int value = std::min({previous[i] + 1, current[i - 1] + 1,
+                                  previous[i - 1] + (pattern[i - 1] != text[j] ? 1 : 0)});
+            if (i > 1 && j > 0 && pattern[i - 1] == text[j - 1] && pattern[i - 2] == text[j]) {
+                value = std::min(value, beforePrevious[i - 2] + 1);
+            }
+            current[i] = value;
+        }
+        best = std::min(best, current[rows - 1]);
+        std::swap(beforePrevious, previous);
+        std::swap(previous, current);
+    }
+    return best;
+}
+
+// First position in [first, last) not less than id, probing 1, 2, 4, ...
+// elements ahead before the binary search, so short hops stay cheap
+template <typename Iterator>
+Iterator seek(Iterator first, Iterator last, int id) {
+    std::ptrdiff_t step = 1;
+    while (step < last - first && first[step] < id) {
+        first += step;
+        step *= 2;
+    }
+    return std::lower_bound(first, first + std::min(step, last - first), id);
+}
+
+// Up to four bytes packed big-endian, so shorter grams never collide with
+// full ones
+std::uint32_t packGram(std::string_view text) {
+    std::uint32_t gram = 0;
+    for (char c : text) {
+        gram = gram << 8 | static_cast<unsigned char>(c);
+    }
+    return gram;
+}
+
+void prefetch(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+std::string anchored(std::string_view text, bool withEnd) {
+    std::string padded(1, kStartMarker);
+    padded += text;
+    if (withEnd) {
+        padded += kEndMarker;
+    }
+    return padded;
+}
+
+}  // namespace
+
+std::string NameIndex::normalize(std::string_view name) {
+    std::string key(name);
+    for (auto& c : key) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+void NameIndex::gramsOf(std::string_view text, std::vector<Gram>& grams) {
+    grams.clear();
+    if (text.size() < kGramLength) {
+        if (!text.empty()) {
+            grams.push_back(packGram(text));
+        }
+        return;
+    }
+    for (std::size_t i = 0; i + kGramLength <= text.size(); i++) {
+        Gram gram = packGram(text.substr(i, kGramLength));
+        if (gram != 0) {  // Only four NUL characters pack to the free slot marker
+            grams.push_back(gram);
+        }
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+void NameIndex::nameGrams(const std::string& name, std::vector<Gram>& grams) {
+    std::string padded = anchored(name, true);
+    gramsOf(padded, grams);
+    for (std::size_t length = 2; length < kGramLength && length <= name.size() + 1; length++) {
+        grams.push_back(packGram(std::string_view(padded).substr(0, length)));
+    }
+}
+
+std::size_t NameIndex::homeSlot(Gram gram) const {
+    return static_cast<std::size_t>((gram * 0x9E3779B97F4A7C15ull) >> (64 - slotBits));
+}
+
+std::size_t NameIndex::findSlot(Gram gram) const {
+    if (slots.empty()) {
+        return 0;
+    }
+    for (std::size_t i = homeSlot(gram);; i = (i + 1) & (slots.size() - 1)) {
+        if (slots[i].gram == gram) {
+            return i;
+        }
+        if (slots[i].gram == 0) {
+            return slots.size();
+        }
+    }
+}
+
+const NameIndex::Postings* NameIndex::findPostings(Gram gram) const {
+    std::size_t i = findSlot(gram);
+    if (i == slots.size() || slots[i].ids.empty()) {
+        return nullptr;
+    }
+    return &slots[i].ids;
+}
+
+void NameIndex::reserveSlots(std::size_t extra) {
+    // Keep the table at most half full so probe runs stay short
+    if ((usedSlots + extra) * 2 <= slots.size()) {
+        return;
+    }
+    std::pmr::vector<GramSlot> previous(&pool);
+    previous.swap(slots);
+    slotBits = std::max(slotBits + 1, 10);
+    while ((std::size_t(1) << slotBits) < (usedSlots + extra) * 2) {
+        slotBits++;
+    }
+    slots.resize(std::size_t(1) << slotBits);
+    for (auto& slot : previous) {
+        if (slot.gram == 0) {
+            continue;
+        }
+        std::size_t i = homeSlot(slot.gram);
+        while (slots[i].gram != 0) {
+            i = (i + 1) & (slots.size() - 1);
+        }
+        slots[i].gram = slot.gram;
+        slots[i].ids = std::move(slot.ids);
+    }
+}
+
+void NameIndex::indexName(int id, const std::string& name) {
+    for (char c : name) {
+        seenBytes[static_cast<unsigned char>(c)] = true;
+    }
+    std::vector<Gram> grams;
+    nameGrams(name, grams);
+    reserveSlots(grams.size());
+
+    // The grams of a name are spread over the whole table. Fetching all of
+    // their slots, then the ends of their lists, before writing any lets
+    // the cache misses overlap instead of queueing one after another.
+    for (Gram gram : grams) {
+        prefetch(&slots[homeSlot(gram)]);
+    }
+    std::vector<Postings*> lists;
+    for (Gram gram : grams) {
+        std::size_t i = homeSlot(gram);
+        while (slots[i].gram != 0 && slots[i].gram != gram) {
+            i = (i + 1) & (slots.size() - 1);
+        }
+        if (slots[i].gram == 0) {
+            slots[i].gram = gram;
+            usedSlots++;
+        }
+        Postings& ids = slots[i].ids;
+        if (!ids.empty()) {
+            prefetch(&ids.back());
+        }
+        lists.push_back(&ids);
+    }
+
+    for (Postings* ids : lists) {
+        // IDs mostly arrive in increasing order, from the file or nextId
+        if (ids->empty() || ids->back() < id) {
+            ids->push_back(id);
+        } else {
+            auto it = std::lower_bound(ids->begin(), ids->end(), id);
+            if (*it != id) {
+                ids->insert(it, id);
+            }
+        }
+    }
+}
+
+void NameIndex::unindexName(int id, const std::string& name) {
+    std::vector<Gram> grams;
+    nameGrams(name, grams);
+    for (Gram gram : grams) {
+        std::size_t i = findSlot(gram);
+        if (i == slots.size()) {
+            continue;
+        }
+        Postings& ids = slots[i].ids;
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id) {
+            ids.erase(it);
+        }
+        if (ids.empty()) {
+            ids.shrink_to_fit();
+        }
+    }
+}
+
+void NameIndex::insert(int id, std::string_view name) {
+    std::string key = normalize(name);
+    auto [entry, added] = names.try_emplace(id);
+    if (!added) {
+        if (entry->second == key) {
+            return;
+        }
+        unindexName(id, entry->second);
+    }
+    indexName(id, key);
+    entry->second = std::move(key);
+}
+
+void NameIndex::erase(int id) {
+    auto entry = names.find(id);
+    if (entry == names.end()) {
+        return;
+    }
+    unindexName(id, entry->second);
+    names.erase(entry);
+}
+
+void NameIndex::clear() {
+    names.clear();
+    slots.clear();
+    slotBits = 0;
+    usedSlots = 0;
+    seenBytes.fill(false);
+}
+
+template <typename Visit>
+void NameIndex::forEachCommon(const std::vector<Gram>& grams, Visit visit) const {
+    std::vector<const Postings*> lists;
+    for (Gram gram : grams) {
+        const Postings* ids = findPostings(gram);
+        if (!ids) {
+            return;
+        }
+        lists.push_back(ids);
+    }
+    if (lists.empty()) {
+        return;
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+    if (lists.size() == 1) {
+        for (int id : *lists[0]) {
+            if (!visit(id, names.find(id)->second)) {
+                return;
+            }
+        }
+        return;
+    }
+
+    // Leapfrog join: each list in turn skips ahead to the current target,
+    // and a larger ID found there becomes the new target
+    std::vector<Postings::const_iterator> cursors;
+    for (const Postings* ids : lists) {
+        cursors.push_back(ids->begin());
+    }
+    int target = *cursors[0];
+    std::size_t agreed = 1;
+    std::size_t current = 0;
+    while (true) {
+        current = (current + 1) % lists.size();
+        auto& cursor = cursors[current];
+        cursor = seek(cursor, lists[current]->end(), target);
+        if (cursor == lists[current]->end()) {
+            return;
+        }
+        if (*cursor != target) {
+            target = *cursor;
+            agreed = 1;
+            continue;
+        }
+        if (++agreed < lists.size()) {
+            continue;
+        }
+        if (!visit(target, names.find(target)->second)) {
+            return;
+        }
+        if (++cursor == lists[current]->end()) {
+            return;
+        }
+        target = *cursor;
+        agreed = 1;
+    }
+}
+
+void NameIndex::fuzzyByVariants(const std::string& query, std::vector<FuzzyMatch>& matches) const {
+    std::vector<std::pair<int, const std::string*>> candidates;
+    std::vector<Gram> grams;
+    auto addContaining = [&](std::string_view text) {
+        if (text.size() < kGramLength) {
+            return;
+        }
+        gramsOf(text, grams);
+        forEachCommon(grams, [&candidates, text](int id, const std::string& name) {
+            if (name.find(text) != std::string::npos) {
+                candidates.emplace_back(id, &name);
+            }
+            return true;
+        });
+    };
+
+    // An edit at least a gram away from one end leaves that end intact, so
+    // names containing the first or last characters of the query cover it.
+    // Only edits close to both ends need their variants looked up.
+    const std::size_t length = query.size();
+    std::string_view text(query);
+    addContaining(text.substr(0, kGramLength));
+    addContaining(text.substr(length - kGramLength));
+    auto nearBothEnds = [length](std::size_t before, std::size_t changed) {
+        return before < kGramLength && length - before - changed < kGramLength;
+    };
+    std::string variant;
+    for (std::size_t i = 0; i < length; i++) {
+        if (nearBothEnds(i, 1)) {
+            variant = query;
+            variant.erase(i, 1);
+            addContaining(variant);
+        }
+        if (i + 1 < length && query[i] != query[i + 1] && nearBothEnds(i, 2)) {
+            variant = query;
+            std::swap(variant[i], variant[i + 1]);
+            addContaining(variant);
+        }
+    }
+    for (std::size_t byte = 0; byte < seenBytes.size(); byte++) {
+        if (!seenBytes[byte]) {
+            continue;
+        }
+        char c = static_cast<char>(byte);
+        for (std::size_t i = 0; i < length; i++) {
+            if (query[i] != c && nearBothEnds(i, 1)) {
+                variant = query;
+                variant[i] = c;
+                addContaining(variant);
+            }
+            // Letters added at either end leave the query itself in the name
+            if (i > 0 && nearBothEnds(i, 0)) {
+                variant = query;
+                variant.insert(i, 1, c);
+                addContaining(variant);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<int> columns;
+    for (const auto& [id, name] : candidates) {
+        if (substringDistance(query, *name, columns) <= 1) {
+            matches.push_back({1, id});
+        }
+    }
+}
+
+void NameIndex::fuzzyByPieces(const std::string& query, std::vector<FuzzyMatch>& matches) const {
+    const std::size_t maxEdits = query.size() >= 3 * kGramLength + 2 ? 2 : 1;
+    const std::size_t pieceLength = (query.size() - maxEdits) / (maxEdits + 1);
+    std::string_view text(query);
+
+    std::vector<std::pair<int, const std::string*>> candidates;
+    std::vector<Gram> grams;
+    for (std::size_t i = 0; i <= maxEdits; i++) {
+        std::size_t start = i * (pieceLength + 1);
+        gramsOf(text.substr(start, i == maxEdits ? text.npos : pieceLength), grams);
+        forEachCommon(grams, [&candidates](int id, const std::string& name) {
+            candidates.emplace_back(id, &name);
+            return true;
+        });
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<int> columns;
+    for (const auto& [id, name] : candidates) {
+        auto edits = static_cast<std::size_t>(substringDistance(query, *name, columns));
+        if (edits <= maxEdits) {
+            matches.push_back({edits, id});
+        }
+    }
+    std::stable_sort(matches.begin(), matches.end(),
+                     [](const FuzzyMatch& a, const FuzzyMatch& b) { return a.edits < b.edits; });
+}
+
+std::vector<NameSearchResult> NameIndex::search(std::string_view query, std::size_t limit) const {
+    std::vector<NameSearchResult> results;
+    std::string key = normalize(query);
+    if (key.empty() || limit == 0) {
+        return results;
+    }
+    std::vector<Gram> grams;
+    auto collect = [&results, limit](NameMatch match, auto accept) {
+        return [&results, limit, match, accept](int id, const std::string& name) {
+            if (accept(name)) {
+                results.push_back({id, match});
+            }
+            return results.size() < limit;
+        };
+    };
+
+    gramsOf(anchored(key, true), grams);
+    forEachCommon(grams, collect(NameMatch::Exact, [&key](const std::string& name) {
+        return name == key;
+    }));
+    if (results.size() >= limit) {
+        return results;
+    }
+
+    gramsOf(anchored(key, false), grams);
+    forEachCommon(grams, collect(NameMatch::Prefix, [&key](const std::string& name) {
+        return name.size() != key.size() && name.starts_with(key);
+    }));
+    if (results.size() >= limit || key.size() < kGramLength) {
+        return results;
+    }
+
+    gramsOf(key, grams);
+    forEachCommon(grams, collect(NameMatch::Substring, [&key](const std::string& name) {
+        return !name.starts_with(key) && name.find(key) != std::string::npos;
+    }));
+    if (!results.empty()) {
+        return results;
+    }
+
+    std::vector<FuzzyMatch> matches;
+    if (key.size() <= 2 * kGramLength) {
+        fuzzyByVariants(key, matches);
+    } else {
+        fuzzyByPieces(key, matches);
+    }
+    for (std::size_t i = 0; i < matches.size() && i < limit; i++) {
+        results.push_back({matches[i].id, NameMatch::Fuzzy});
+    }
+    return results;
+}
+
+void NameIndex::idsWithPrefix(std::string_view prefix, std::vector<int>& ids) const {
+    std::string key = normalize(prefix);
+    if (key.empty()) {
+        return;
+    }
+    std::vector<Gram> grams;
+    gramsOf(anchored(key, false), grams);
+    forEachCommon(grams, [&ids, &key](int id, const std::string& name) {
+        if (name.starts_with(key)) {
+            ids.push_back(id);
+        }
+        return true;
+    });
+}
+
+std::size_t NameIndex::estimatePrefix(std::string_view prefix) const {
+    std::string key = normalize(prefix);
+    if (key.empty()) {
+        return names.size();
+    }
+    std::vector<Gram> grams;
+    gramsOf(anchored(key, false), grams);
+    std::size_t shortest = names.size();
+    for (Gram gram : grams) {
+        const Postings* ids = findPostings(gram);
+        shortest = std::min(shortest, ids ? ids->size() : 0);
+    }
+    return shortest;
+}
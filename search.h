@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// How an item name matched a search query, best first
+enum class NameMatch { Exact, Prefix, Substring, Fuzzy };
+
+inline const char* nameMatchName(NameMatch match) {
+    switch (match) {
+        case NameMatch::Exact: return "Exact";
+        case NameMatch::Prefix: return "Prefix";
+        case NameMatch::Substring: return "Substring";
+        case NameMatch::Fuzzy: return "Fuzzy";
+    }
+    return "Unknown";
+}
+
+struct NameSearchResult {
+    int itemId;
+    NameMatch match;
+};
+
+// Case-insensitive index over item names.
+//
+// Each name is split into overlapping 4-grams between a start and an end
+// marker, so "Soap" is indexed as "^soa", "soap" and "oap$", plus "^s" and
+// "^so" for short prefixes. Every gram maps to the sorted IDs of the names
+// containing it. A query walks the intersection of its grams' ID lists,
+// shortest list first, and checks each candidate's name: anchored grams
+// find exact names and prefixes, plain ones substrings. Fuzzy matches are
+// found the same way, from misspelled variants or pieces of the query.
+class NameIndex {
+private:
+    using Gram = std::uint32_t;
+    using Postings = std::pmr::vector<int>;
+
+    // Sorted IDs per gram in an open-addressing table probed linearly.
+    // Gram 0 marks a free slot; a slot whose list empties keeps its gram.
+    // The list lives in the memory resource of the table.
+    struct GramSlot {
+        using allocator_type = std::pmr::polymorphic_allocator<int>;
+
+        Gram gram = 0;
+        Postings ids;
+
+        explicit GramSlot(const allocator_type& allocator = {}) : ids(allocator) {}
+
+        GramSlot(const GramSlot& other, const allocator_type& allocator)
+            : gram(other.gram), ids(other.ids, allocator) {}
+
+        GramSlot(GramSlot&& other, const allocator_type& allocator)
+            : gram(other.gram), ids(std::move(other.ids), allocator) {}
+
+        GramSlot(const GramSlot&) = default;
+        GramSlot(GramSlot&&) = default;
+        GramSlot& operator=(const GramSlot&) = default;
+        GramSlot& operator=(GramSlot&&) = default;
+    };
+
+    // Hundreds of thousands of short lists are allocated, grown and freed
+    // together, so they come from one pool rather than the global heap
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::unordered_map<int, std::string> names{&pool};  // Lowercased names by ID
+    std::pmr::vector<GramSlot> slots{&pool};
+    int slotBits = 0;
+    std::size_t usedSlots = 0;
+    std::array<bool, 256> seenBytes{};           // Characters used in any name so far
+
+    static std::string normalize(std::string_view name);
+
+    // Sorted, distinct 4-grams of text, or text itself if it is shorter
+    static void gramsOf(std::string_view text, std::vector<Gram>& grams);
+
+    // Grams a name is indexed under
+    static void nameGrams(const std::string& name, std::vector<Gram>& grams);
+
+    std::size_t homeSlot(Gram gram) const;
+
+    // Slot holding gram, or slots.size() if it has none
+    std::size_t findSlot(Gram gram) const;
+
+    // IDs of names containing gram, or nullptr if there are none
+    const Postings* findPostings(Gram gram) const;
+
+    // Grow the table so that extra more grams fit without a rehash
+    void reserveSlots(std::size_t extra);
+
+    void indexName(int id, const std::string& name);
+    void unindexName(int id, const std::string& name);
+
+    // Call visit(id, name) for every ID found in the lists of all grams, in
+    // ID order, until it returns false
+    template <typename Visit>
+    void forEachCommon(const std::vector<Gram>& grams, Visit visit) const;
+
+    struct FuzzyMatch {
+        std::size_t edits;
+        int id;
+    };
+
+    // Short queries look up every variant one edit away. Longer ones are cut
+    // into pieces, one more than the edits allowed, with a character left
+    // between them; one piece survives the edits, so only names containing a
+    // piece are compared with the query.
+    void fuzzyByVariants(const std::string& query, std::vector<FuzzyMatch>& matches) const;
+    void fuzzyByPieces(const std::string& query, std::vector<FuzzyMatch>& matches) const;
+
+public:
+    // Index name under id, replacing any name indexed for it before
+    void insert(int id, std::string_view name);
+
+    void erase(int id);
+
+    void clear();
+
+    // Make room for count names without rehashing
+    void reserve(std::size_t count) { names.reserve(count); }
+
+    std::size_t size() const { return names.size(); }
+
+    // Up to limit matches for query in ID order: exact names, then names
+    // starting with the query, then names containing it. Substring matches
+    // need a query of at least 4 characters. If nothing matches, names
+    // within one edit of a query of 4 or more characters (a letter changed,
+    // missing, added or swapped with the next) are returned in ID order, or
+    // within two edits from 14 characters, closest first. A 4-character
+    // query is not checked for a missing letter.
+    std::vector<NameSearchResult> search(std::string_view query, std::size_t limit) const;
+
+    // IDs of every name starting with prefix, ignoring case, in ID order
+    void idsWithPrefix(std::string_view prefix, std::vector<int>& ids) const;
+
+    // Upper bound on the names starting with prefix: the length of the
+    // shortest ID list idsWithPrefix() would read
+    std::size_t estimatePrefix(std::string_view prefix) const;
+};
@@ -0,0 +1,659 @@
+#include "server.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+
+static volatile std::sig_atomic_t serverStopRequested = 0;
+
+static void requestServerStop(int) { serverStopRequested = 1; }
+
+// State shared by all event loop threads. Lookups take the lock shared,
+// everything that changes the inventory or the order queue takes it
+// exclusively. The CSV file is written by a periodic flush, not per request.
+struct ServerState {
+    WarehouseSystem& system;
+    std::shared_mutex lock;
+    std::atomic<bool> dirty;
+
+    explicit ServerState(WarehouseSystem& system) : system(system), dirty(false) {}
+};
+
+// Execute one request and append its reply frame to out
+static void handleServerRequest(ServerState& state, std::uint32_t requestId, Opcode opcode,
+                                ProtocolReader& payload, std::string& out) {
+    ProtocolWriter writer(out);
+    auto reply = [&](ReplyStatus status) {
+        return writer.beginFrame(requestId, static_cast<std::uint8_t>(status));
+    };
+
+    switch (opcode) {
+        case Opcode::Find: {
+            int id = payload.getI32();
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::shared_lock<std::shared_mutex> guard(state.lock);
+            const auto& system = state.system;
+            auto item = system.findItem(id);
+            std::size_t frame = reply(item ? ReplyStatus::Ok : ReplyStatus::NotFound);
+            if (item) writer.putItem(*item);
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::Search: {
+            std::string query = payload.getString();
+            std::uint16_t limit = std::min(payload.getU16(), kMaxSearchResults);
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::shared_lock<std::shared_mutex> guard(state.lock);
+            const auto& system = state.system;
+            auto results = system.searchItems(query, limit);
+            std::size_t frame = reply(ReplyStatus::Ok);
+            writer.putU16(static_cast<std::uint16_t>(results.size()));
+            for (const auto& result : results) {
+                writer.putU8(static_cast<std::uint8_t>(result.match));
+                writer.putItem(*system.findItem(result.itemId));
+            }
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::Query: {
+            std::string text = payload.getString();
+            if (!payload.ok() || !payload.atEnd()) break;
+            ItemQuery query;
+            if (!ItemQuery::parse(text, query).empty()) {
+                writer.endFrame(reply(ReplyStatus::Invalid));
+                return;
+            }
+            if (query.limit == 0 || query.limit > kMaxQueryResults) {
+                query.limit = kMaxQueryResults;
+            }
+            std::shared_lock<std::shared_mutex> guard(state.lock);
+            auto result = state.system.queryItems(query);
+            std::size_t frame = reply(ReplyStatus::Ok);
+            writer.putU32(static_cast<std::uint32_t>(result.matched));
+            writer.putU16(static_cast<std::uint16_t>(result.items.size()));
+            for (const auto& item : result.items) {
+                writer.putItem(item);
+            }
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::StockTotals: {
+            std::string category = payload.getString();
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::shared_lock<std::shared_mutex> guard(state.lock);
+            const auto& system = state.system;
+            StockTotals totals = category.empty() ? system.getStockTotals() : system.getStockTotals(category);
+            std::size_t frame = reply(ReplyStatus::Ok);
+            writer.putU64(totals.items);
+            writer.putU64(static_cast<std::uint64_t>(totals.quantity));
+            writer.putDouble(totals.value);
+            writer.putU64(totals.lowStock);
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::Add:
+        case Opcode::Update: {
+            int id = opcode == Opcode::Update ? payload.getI32() : 0;
+            InventoryItem item = payload.getItem(id);
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            ReplyStatus status = ReplyStatus::Ok;
+            if (opcode == Opcode::Add) {
+                item.setId(state.system.getNextId());
+                if (WarehouseSystem::isValidItem(item)) {
+                    state.system.addItem(item);
+                } else {
+                    status = ReplyStatus::Invalid;
+                }
+            } else if (!WarehouseSystem::isValidItem(item)) {
+                status = ReplyStatus::Invalid;
+            } else if (!state.system.updateItem(item)) {
+                status = ReplyStatus::NotFound;
+            }
+            if (status == ReplyStatus::Ok) state.dirty = true;
+            std::size_t frame = reply(status);
+            if (status == ReplyStatus::Ok && opcode == Opcode::Add) writer.putI32(item.getId());
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::Remove: {
+            int id = payload.getI32();
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            bool removed = state.system.removeItem(id);
+            if (removed) state.dirty = true;
+            writer.endFrame(reply(removed ? ReplyStatus::Ok : ReplyStatus::NotFound));
+            return;
+        }
+        case Opcode::CreateOrder: {
+            std::vector<OrderLine> lines;
+            do {
+                int itemId = payload.getI32();
+                int quantity = payload.getI32();
+                lines.emplace_back(itemId, quantity);
+            } while (payload.ok() && !payload.atEnd());
+            if (!payload.ok()) break;
+            // Every line is checked and reserved under one exclusive lock,
+            // so a multi-line order is allocated all at once or not at all
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            int orderId = state.system.placeOrder(lines);
+            // The order is in the order log's buffer, which only saves flush
+            if (orderId) state.dirty = true;
+            std::size_t frame = reply(orderId ? ReplyStatus::Ok : ReplyStatus::Invalid);
+            if (orderId) writer.putI32(orderId);
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::ReceiveStock: {
+            std::vector<RestockLine> lines;
+            do {
+                int itemId = payload.getI32();
+                int quantity = payload.getI32();
+                lines.push_back({itemId, quantity});
+            } while (payload.ok() && !payload.atEnd());
+            if (!payload.ok()) break;
+            // The whole shipment is checked and applied under one exclusive lock
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            auto result = state.system.receiveShipment(lines);
+            if (result.received) state.dirty = true;
+            std::size_t frame = reply(result.received ? ReplyStatus::Ok : ReplyStatus::Invalid);
+            if (result.received) writer.putU32(static_cast<std::uint32_t>(result.ordersReserved));
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::ProcessOrders: {
+            std::uint32_t limit = payload.getU32();
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            // Stop after one pass over the queue so short orders are not retried forever
+            std::uint32_t processed = 0, shortOfStock = 0;
+            bool changed = false;
+            std::size_t pending = state.system.getPendingOrderCount();
+            for (std::uint32_t i = 0; i < limit && i < pending; i++) {
+                auto result = state.system.fulfillNextOrder();
+                if (result == WarehouseSystem::OrderResult::Processed) processed++;
+                if (result == WarehouseSystem::OrderResult::InsufficientStock) shortOfStock++;
+                // Orders short on stock are backordered and those for removed
+                // items cancelled, which is logged as well
+                if (result != WarehouseSystem::OrderResult::NoOrders) changed = true;
+            }
+            if (changed) state.dirty = true;
+            std::size_t frame = reply(ReplyStatus::Ok);
+            writer.putU32(processed);
+            writer.putU32(shortOfStock);
+            writer.putU32(static_cast<std::uint32_t>(state.system.getPendingOrderCount()));
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::GetOrder: {
+            int orderId = payload.getI32();
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::shared_lock<std::shared_mutex> guard(state.lock);
+            auto order = state.system.findOrder(orderId);
+            std::size_t frame = reply(order ? ReplyStatus::Ok : ReplyStatus::NotFound);
+            if (order) {
+                writer.putI32(order->getItemId());
+                writer.putI32(order->getQuantity());
+                writer.putU8(static_cast<std::uint8_t>(order->getStatus()));
+                for (const auto& line : order->getLines().subspan(1)) {
+                    writer.putI32(line.getItemId());
+                    writer.putI32(line.getQuantity());
+                }
+            }
+            writer.endFrame(frame);
+            return;
+        }
+        case Opcode::CancelOrder:
+        case Opcode::AmendOrder: {
+            int orderId = payload.getI32();
+            int itemId = 0;
+            int quantity = opcode == Opcode::AmendOrder ? payload.getI32() : 0;
+            if (opcode == Opcode::AmendOrder && payload.ok() && !payload.atEnd()) {
+                itemId = quantity;
+                quantity = payload.getI32();
+            }
+            if (!payload.ok() || !payload.atEnd()) break;
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            ReplyStatus status = ReplyStatus::Ok;
+            if (!state.system.findOrder(orderId)) {
+                status = ReplyStatus::NotFound;
+            } else if (opcode == Opcode::CancelOrder ? !state.system.cancelOrder(orderId)
+                       : itemId ? !state.system.amendOrder(orderId, itemId, quantity)
+                                : !state.system.amendOrder(orderId, quantity)) {
+                status = ReplyStatus::Invalid;
+            }
+            if (status == ReplyStatus::Ok) state.dirty = true;
+            writer.endFrame(reply(status));
+            return;
+        }
+    }
+    writer.endFrame(reply(ReplyStatus::BadRequest));
+}
+
+struct ServerConnection {
+    int fd;
+    std::string input;
+    std::string output;
+    std::size_t outputOffset = 0;
+    bool writeWatched = false;
+};
+
+// One event loop per thread. Each loop has its own SO_REUSEPORT listening
+// socket, so the kernel spreads new connections across threads and a
+// connection never migrates between them.
+class ServerEventLoop {
+private:
+    ServerState& state;
+    int listenFd;
+    int epollFd;
+    std::map<int, ServerConnection> connections;
+    bool flushesFile;
+
+    static const std::size_t kOutputHighWater = 4 * 1024 * 1024;
+
+    void watch(ServerConnection& connection, bool write) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | (write ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.writeWatched = write;
+    }
+
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;  // EAGAIN, or another loop took it
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLRDHUP;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            connections[fd].fd = fd;
+        }
+    }
+
+    // Execute every complete frame in the input buffer. Returns false if the
+    // client sent a frame that cannot be parsed.
+    bool processInput(ServerConnection& connection) {
+        std::size_t offset = 0;
+        while (connection.output.size() < kOutputHighWater &&
+               connection.input.size() - offset >= 4) {
+            ProtocolReader header(connection.input.data() + offset, 4);
+            std::uint32_t length = header.getU32();
+            if (length < kFrameHeaderSize - 4 || length > kMaxFrameSize) {
+                return false;
+            }
+            if (connection.input.size() - offset < 4 + length) {
+                break;
+            }
+            ProtocolReader frame(connection.input.data() + offset + 4, length);
+            std::uint32_t requestId = frame.getU32();
+            auto opcode = static_cast<Opcode>(frame.getU8());
+            handleServerRequest(state, requestId, opcode, frame, connection.output);
+            offset += 4 + length;
+        }
+        connection.input.erase(0, offset);
+        return true;
+    }
+
+    // Write as much pending output as the socket takes. Returns false on error.
+    bool flushOutput(ServerConnection& connection) {
+        while (connection.outputOffset < connection.output.size()) {
+            ssize_t written = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                                     connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                return false;
+            }
+            connection.outputOffset += static_cast<std::size_t>(written);
+        }
+        if (connection.outputOffset == connection.output.size()) {
+            connection.output.clear();
+            connection.outputOffset = 0;
+        }
+        bool pending = !connection.output.empty();
+        if (pending != connection.writeWatched) {
+            watch(connection, pending);
+        }
+        return true;
+    }
+
+    void handleEvent(int fd, std::uint32_t events) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) {
+            return;
+        }
+        ServerConnection& connection = it->second;
+
+        bool open = true;
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            char buffer[64 * 1024];
+            while (true) {
+                ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.input.append(buffer, static_cast<std::size_t>(received));
+                    continue;
+                }
+                if (received < 0 && errno == EINTR) continue;
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    open = false;
+                }
+                break;
+            }
+        }
+        if (!processInput(connection) || !flushOutput(connection)) {
+            closeConnection(fd);
+            return;
+        }
+        // Input held back by a full output buffer can run once it drains
+        if (!connection.input.empty() && connection.output.empty()) {
+            if (!processInput(connection) || !flushOutput(connection)) {
+                closeConnection(fd);
+                return;
+            }
+        }
+        if (!open && connection.output.empty()) {
+            closeConnection(fd);
+        }
+    }
+
+    // Save as AsyncWarehouse::saveAsync() does: snapshot the files and flush
+    // the logs under the exclusive lock, write the files without holding it,
+    // then take it again so the stock log keeps only what came in since
+    void saveSnapshot() {
+        auto snapshot = [this]() {
+            std::unique_lock<std::shared_mutex> guard(state.lock);
+            auto taken = state.system.snapshotCsv();
+            state.system.flushLogs();
+            return taken;
+        }();
+        std::ofstream file(state.system.getFilename());
+        file.write(snapshot.text.data(), static_cast<std::streamsize>(snapshot.text.size()));
+        file.close();
+        if (!file) {
+            state.dirty = true;  // Try again at the next flush
+            return;
+        }
+        if (!snapshot.locationsText.empty()) {
+            std::ofstream locationsFile(state.system.getLocationsPath());
+            locationsFile << snapshot.locationsText;
+        }
+        std::unique_lock<std::shared_mutex> guard(state.lock);
+        state.system.csvSaved(snapshot);
+    }
+
+public:
+    ServerEventLoop(ServerState& state, int listenFd, bool flushesFile)
+        : state(state), listenFd(listenFd), epollFd(epoll_create1(EPOLL_CLOEXEC)),
+          flushesFile(flushesFile) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    }
+
+    ~ServerEventLoop() {
+        for (auto& [fd, connection] : connections) {
+            ::close(fd);
+        }
+        ::close(epollFd);
+        ::close(listenFd);
+    }
+
+    void run(int flushIntervalSeconds) {
+        epoll_event events[256];
+        auto lastFlush = std::chrono::steady_clock::now();
+        while (!serverStopRequested) {
+            int ready = epoll_wait(epollFd, events, 256, 200);
+            for (int i = 0; i < ready; i++) {
+                if (events[i].data.fd == listenFd) {
+                    acceptConnections();
+                } else {
+                    handleEvent(events[i].data.fd, events[i].events);
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (flushesFile && now - lastFlush >= std::chrono::seconds(flushIntervalSeconds)) {
+                lastFlush = now;
+                if (state.dirty.exchange(false)) {
+                    saveSnapshot();
+                }
+            }
+        }
+    }
+};
+
+static int openListenSocket(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int runServer(WarehouseSystem& system, int port, unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    ServerState state(system);
+    system.setAutoSave(false);
+
+    std::vector<std::unique_ptr<ServerEventLoop>> loops;
+    for (unsigned i = 0; i < threadCount; i++) {
+        int listenFd = openListenSocket(port);
+        if (listenFd < 0) {
+            std::cerr << "Cannot listen on port " << port << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+        loops.push_back(std::make_unique<ServerEventLoop>(state, listenFd, i == 0));
+    }
+
+    std::signal(SIGINT, requestServerStop);
+    std::signal(SIGTERM, requestServerStop);
+    std::cout << "Serving on port " << port << " with " << threadCount << " threads\n" << std::flush;
+
+    const int flushIntervalSeconds = 1;
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back([&loops, i, flushIntervalSeconds]() { loops[i]->run(flushIntervalSeconds); });
+    }
+    loops[0]->run(flushIntervalSeconds);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    system.save();
+    std::cout << "Server stopped.\n";
+    return 0;
+}
+
+struct LoadgenResult {
+    std::vector<std::uint32_t> latenciesMicros;
+    std::size_t errors = 0;
+    bool connected = false;
+};
+
+static int connectTo(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (auto address = addresses; address; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+static void runLoadgenConnection(const LoadgenOptions& options, unsigned seed, LoadgenResult& result) {
+    int fd = connectTo(options.host, options.port);
+    if (fd < 0) {
+        return;
+    }
+    result.connected = true;
+    result.latenciesMicros.reserve(options.requestsPerConnection);
+
+    using Clock = std::chrono::steady_clock;
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> itemIds(1, std::max(1, options.items));
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<Clock::time_point> sentAt(options.requestsPerConnection);
+
+    std::string output, input;
+    char buffer[64 * 1024];
+    unsigned sent = 0, received = 0;
+    while (received < options.requestsPerConnection) {
+        output.clear();
+        ProtocolWriter writer(output);
+        auto now = Clock::now();
+        while (sent < options.requestsPerConnection && sent - received < options.depth) {
+            int roll = percent(random);
+            Opcode opcode = roll < 90 ? Opcode::Find : (roll < 98 ? Opcode::CreateOrder
+                                                                   : Opcode::ProcessOrders);
+            std::size_t frame = writer.beginFrame(sent, static_cast<std::uint8_t>(opcode));
+            if (opcode == Opcode::Find) {
+                writer.putI32(itemIds(random));
+            } else if (opcode == Opcode::CreateOrder) {
+                writer.putI32(itemIds(random));
+                writer.putI32(1);
+            } else {
+                writer.putU32(16);
+            }
+            writer.endFrame(frame);
+            sentAt[sent++] = now;
+        }
+        if (!output.empty() && ::send(fd, output.data(), output.size(), MSG_NOSIGNAL) !=
+                                   static_cast<ssize_t>(output.size())) {
+            break;
+        }
+
+        ssize_t count = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+            break;
+        }
+        input.append(buffer, static_cast<std::size_t>(count));
+        now = Clock::now();
+
+        std::size_t offset = 0;
+        while (input.size() - offset >= 4) {
+            ProtocolReader header(input.data() + offset, 4);
+            std::uint32_t length = header.getU32();
+            if (input.size() - offset < 4 + length) break;
+            ProtocolReader frame(input.data() + offset + 4, length);
+            std::uint32_t requestId = frame.getU32();
+            auto status = static_cast<ReplyStatus>(frame.getU8());
+            if (status != ReplyStatus::Ok && status != ReplyStatus::NotFound) {
+                result.errors++;
+            }
+            if (requestId < sent) {
+                auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - sentAt[requestId]).count();
+                result.latenciesMicros.push_back(static_cast<std::uint32_t>(micros));
+            }
+            received++;
+            offset += 4 + length;
+        }
+        input.erase(0, offset);
+    }
+    ::close(fd);
+}
+
+int runLoadgen(const LoadgenOptions& options) {
+    std::vector<LoadgenResult> results(options.connections);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < options.connections; i++) {
+        threads.emplace_back(runLoadgenConnection, std::cref(options), 12345 + i, std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::uint32_t> latencies;
+    std::size_t errors = 0;
+    for (const auto& result : results) {
+        if (!result.connected) {
+            std::cerr << "Cannot connect to " << options.host << ":" << options.port << "\n";
+            return 1;
+        }
+        latencies.insert(latencies.end(), result.latenciesMicros.begin(), result.latenciesMicros.end());
+        errors += result.errors;
+    }
+    if (latencies.empty()) {
+        std::cerr << "No replies received\n";
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+
+    std::cout << "Requests:    " << latencies.size() << " (" << errors << " errors)\n"
+              << "Connections: " << options.connections << ", pipeline depth " << options.depth << "\n"
+              << "Elapsed:     " << std::fixed << std::setprecision(3) << elapsed << " s\n"
+              << "Throughput:  " << std::setprecision(0) << latencies.size() / elapsed << " requests/s\n"
+              << "Latency us:  p50 " << percentile(0.50) << ", p90 " << percentile(0.90)
+              << ", p99 " << percentile(0.99) << ", p99.9 " << percentile(0.999)
+              << ", max " << latencies.back() << "\n";
+    return 0;
+}
+
+#endif  // __linux__
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "warehouse.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Network server
+//
+// Every frame starts with a big-endian u32 length counting the bytes that
+// follow it, then a u32 request ID echoed back in the reply:
+//     request: length, requestId, u8 opcode, payload
+//     reply:   length, requestId, u8 status, payload
+// Strings are a u16 length followed by the bytes, prices are IEEE doubles
+// sent as u64. Clients may pipeline any number of requests; replies on a
+// connection come back in request order.
+
+// Multi-line orders: CreateOrder takes further itemId/quantity pairs after
+// the first, GetOrder replies with the remaining lines after the status,
+// and AmendOrder takes an i32 itemId before the quantity to pick a line.
+enum class Opcode : std::uint8_t {
+    Find = 1,           // i32 id                        -> item
+    Add = 2,            // item without id               -> i32 new id
+    Update = 3,         // item                          -> (empty)
+    Remove = 4,         // i32 id                        -> (empty)
+    CreateOrder = 5,    // i32 itemId, i32 quantity      -> i32 order id
+    ProcessOrders = 6,  // u32 max orders                -> u32 processed, u32 short, u32 pending
+    GetOrder = 7,       // i32 order id                  -> i32 itemId, i32 quantity, u8 status
+    CancelOrder = 8,    // i32 order id                  -> (empty)
+    AmendOrder = 9,     // i32 order id, i32 quantity    -> (empty)
+    Search = 10,        // string query, u16 limit       -> u16 count, count x (u8 match, item)
+    Query = 11,         // string filters                -> u32 matched, u16 count, count x item
+    StockTotals = 12,   // string category ("" for all)  -> u64 items, i64 units, f64 value, u64 low stock
+    ReceiveStock = 13,  // i32 itemId, i32 quantity, ... -> u32 backorders reserved
+};
+
+const std::uint16_t kMaxSearchResults = 100;  // Larger search limits are capped
+const std::uint16_t kMaxQueryResults = 100;   // Queries return at most this many items
+
+enum class ReplyStatus : std::uint8_t { Ok = 0, NotFound = 1, Invalid = 2, BadRequest = 3 };
+
+const std::uint32_t kFrameHeaderSize = 9;       // length + request ID + opcode/status
+const std::uint32_t kMaxFrameSize = 64 * 1024;  // Larger frames close the connection
+
+class ProtocolWriter {
+private:
+    std::string& out;
+
+public:
+    explicit ProtocolWriter(std::string& out) : out(out) {}
+
+    void putU8(std::uint8_t value) { out += static_cast<char>(value); }
+    void putU16(std::uint16_t value) {
+        out += static_cast<char>(value >> 8);
+        out += static_cast<char>(value);
+    }
+    void putU32(std::uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out += static_cast<char>(value >> shift);
+        }
+    }
+    void putI32(std::int32_t value) { putU32(static_cast<std::uint32_t>(value)); }
+    void putU64(std::uint64_t value) {
+        putU32(static_cast<std::uint32_t>(value >> 32));
+        putU32(static_cast<std::uint32_t>(value));
+    }
+    void putDouble(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putU32(static_cast<std::uint32_t>(bits >> 32));
+        putU32(static_cast<std::uint32_t>(bits));
+    }
+    void putString(const std::string& value) {
+        std::size_t length = std::min<std::size_t>(value.size(), 0xFFFF);
+        putU16(static_cast<std::uint16_t>(length));
+        out.append(value, 0, length);
+    }
+    void putItem(const InventoryItem& item, bool withId = true) {
+        if (withId) putI32(item.getId());
+        putString(item.getName());
+        putString(item.getCategory());
+        putI32(item.getQuantity());
+        putDouble(item.getPrice());
+        putI32(item.getMinStockLevel());
+    }
+
+    // Start a frame and return its offset so endFrame() can patch the length
+    std::size_t beginFrame(std::uint32_t requestId, std::uint8_t code) {
+        std::size_t start = out.size();
+        putU32(0);
+        putU32(requestId);
+        putU8(code);
+        return start;
+    }
+    void endFrame(std::size_t start) {
+        std::uint32_t length = static_cast<std::uint32_t>(out.size() - start - 4);
+        for (int i = 0; i < 4; i++) {
+            out[start + i] = static_cast<char>(length >> (24 - 8 * i));
+        }
+    }
+};
+
+class ProtocolReader {
+private:
+    const unsigned char* pos;
+    const unsigned char* end;
+    bool valid;
+
+public:
+    ProtocolReader(const char* data, std::size_t size)
+        : pos(reinterpret_cast<const unsigned char*>(data)),
+          end(reinterpret_cast<const unsigned char*>(data) + size), valid(true) {}
+
+    // False once any read ran past the end of the buffer
+    bool ok() const { return valid; }
+    bool atEnd() const { return pos == end; }
+
+    std::uint8_t getU8() {
+        if (end - pos < 1) { valid = false; return 0; }
+        return *pos++;
+    }
+    std::uint16_t getU16() {
+        if (end - pos < 2) { valid = false; return 0; }
+        std::uint16_t value = static_cast<std::uint16_t>((pos[0] << 8) | pos[1]);
+        pos += 2;
+        return value;
+    }
+    std::uint32_t getU32() {
+        if (end - pos < 4) { valid = false; return 0; }
+        std::uint32_t value = (std::uint32_t(pos[0]) << 24) | (std::uint32_t(pos[1]) << 16) |
+                              (std::uint32_t(pos[2]) << 8) | std::uint32_t(pos[3]);
+        pos += 4;
+        return value;
+    }
+    std::int32_t getI32() { return static_cast<std::int32_t>(getU32()); }
+    std::uint64_t getU64() {
+        std::uint64_t value = std::uint64_t(getU32()) << 32;
+        return value | getU32();
+    }
+    double getDouble() {
+        std::uint64_t bits = std::uint64_t(getU32()) << 32;
+        bits |= getU32();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    std::string getString() {
+        std::size_t length = getU16();
+        if (static_cast<std::size_t>(end - pos) < length) { valid = false; return ""; }
+        std::string value(reinterpret_cast<const char*>(pos), length);
+        pos += length;
+        return value;
+    }
+    InventoryItem getItem(int id) {
+        std::string name = getString();
+        std::string category = getString();
+        int quantity = getI32();
+        double price = getDouble();
+        int minStockLevel = getI32();
+        return InventoryItem(id, name, category, quantity, price, minStockLevel);
+    }
+};
+
+#ifdef __linux__
+
+// Serve until SIGINT or SIGTERM, then save the inventory once more.
+// A threadCount of 0 starts one event loop per core.
+int runServer(WarehouseSystem& system, int port, unsigned threadCount);
+
+// Load generator
+//
+// Each connection runs on its own thread and keeps up to `depth` requests in
+// flight. The mix is 90% find, 8% create order and 2% process orders over
+// item IDs 1..items. Latencies are measured from send to reply per request.
+
+struct LoadgenOptions {
+    std::string host = "127.0.0.1";
+    int port = 9090;
+    unsigned connections = 4;
+    unsigned requestsPerConnection = 100000;
+    unsigned depth = 16;
+    int items = 1000;
+};
+
+// Drive a running server and print throughput and latency percentiles
+int runLoadgen(const LoadgenOptions& options);
+
+#endif  // __linux__
@@ -0,0 +1,139 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Stock rollups and running totals
+
+TEST(stockReportLeavesCoutFormattingAlone) {
+    ScratchInventory file("report_format");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry/Grains", 10, 2.50, 2));
+    auto flags = std::cout.flags();
+    auto precision = std::cout.precision();
+    system.displayStockReport();
+    system.displayReorderRecommendations();
+    CHECK(std::cout.flags() == flags);
+    CHECK(std::cout.precision() == precision);
+}
+
+static bool sameTotals(const StockTotals& a, const StockTotals& b) {
+    return a.items == b.items && a.quantity == b.quantity && a.lowStock == b.lowStock &&
+           std::fabs(a.value - b.value) < 1e-6 * std::max(1.0, std::fabs(b.value));
+}
+
+static bool sameReport(const WarehouseSystem::StockReport& a, const WarehouseSystem::StockReport& b) {
+    if (!sameTotals(a.total, b.total) || a.categories.size() != b.categories.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.categories.size(); i++) {
+        if (a.categories[i].category != b.categories[i].category ||
+            !sameTotals(a.categories[i].totals, b.categories[i].totals)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(stockRollsUpTheCategoryTree) {
+    ScratchInventory file("rollup");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Saw", "Tools/Hand", 4, 12.00, 5));
+    system.addItem(InventoryItem(2, "Drill", "Tools/Power", 2, 80.00, 1));
+    system.addItem(InventoryItem(3, "Tape", "Tools", 10, 3.00, 0));
+    system.addItem(InventoryItem(4, "Rake", "Garden", 6, 8.50, 6));
+    system.addItem(InventoryItem(5, "Misc", "", 1, 1.00, 0));
+
+    auto report = system.aggregateStock(1);
+    CHECK(report.total.items == 5);
+    CHECK(report.total.quantity == 23);
+    CHECK(std::fabs(report.total.value - 290.0) < 1e-9);
+    CHECK(report.total.lowStock == 2);
+
+    // Parents come before their subcategories, and items without a
+    // category only count towards the total
+    std::vector<std::string> categories;
+    for (const auto& entry : report.categories) {
+        categories.push_back(entry.category);
+    }
+    REQUIRE(categories.size() == 4);
+    auto tools = std::find(categories.begin(), categories.end(), "Tools");
+    REQUIRE(tools != categories.end());
+    CHECK(std::find(categories.begin(), tools, "Tools/Hand") == tools);
+    CHECK(std::find(categories.begin(), tools, "Tools/Power") == tools);
+
+    auto toolIndex = static_cast<std::size_t>(tools - categories.begin());
+    const StockTotals& toolTotals = report.categories[toolIndex].totals;
+    CHECK(toolTotals.items == 3);
+    CHECK(toolTotals.quantity == 16);
+    CHECK(std::fabs(toolTotals.value - 238.0) < 1e-9);
+    CHECK(toolTotals.lowStock == 1);
+}
+
+TEST(parallelAggregationMatchesOneThread) {
+    ScratchInventory file("parallel_rollup");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    // Enough rows for several threads to each take a slice
+    std::mt19937 random(3);
+    const char* categories[] = {"A", "A/B", "A/B/C", "D", "D/E"};
+    for (int id = 1; id <= 200000; id++) {
+        system.addItem(InventoryItem(id, "Item", categories[random() % 5], static_cast<int>(random() % 100),
+                                     static_cast<double>(random() % 5000) / 100.0,
+                                     static_cast<int>(random() % 10)));
+    }
+
+    auto single = system.aggregateStock(1);
+    CHECK(sameReport(system.aggregateStock(3), single));
+    CHECK(sameReport(system.aggregateStock(0), single));
+    CHECK(single.total.items == 200000);
+}
+
+TEST(runningTotalsFollowEveryChange) {
+    ScratchInventory file("running_totals");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    std::mt19937 random(9);
+    const char* categories[] = {"Tools", "Tools/Hand", "Garden", "Garden/Seeds", ""};
+    auto randomItem = [&](int id) {
+        return InventoryItem(id, "Item", categories[random() % 5], static_cast<int>(random() % 30),
+                             static_cast<double>(random() % 2000) / 100.0,
+                             static_cast<int>(random() % 8));
+    };
+    for (int id = 1; id <= 200; id++) {
+        system.addItem(randomItem(id));
+    }
+
+    // Stock moved by receipts, orders, edits and removals, all well short
+    // of the automatic check
+    for (int step = 0; step < 2000; step++) {
+        int id = 1 + static_cast<int>(random() % 220);
+        switch (random() % 5) {
+            case 0: system.receiveStock(id, 1 + static_cast<int>(random() % 10)); break;
+            case 1: system.placeOrder(id, 1 + static_cast<int>(random() % 4)); break;
+            case 2: system.fulfillNextOrder(); break;
+            case 3: system.addItem(randomItem(id)); break;
+            case 4: system.removeItem(id); break;
+        }
+    }
+    REQUIRE(system.getStockChangesSinceCheck() > 0);
+    CHECK(sameReport(system.getStockReport(), system.aggregateStock(1)));
+    CHECK(sameTotals(system.getStockTotals(), system.aggregateStock(1).total));
+
+    StockTotals garden = system.getStockTotals("Garden");
+    StockTotals seeds = system.getStockTotals("Garden/Seeds");
+    for (const auto& entry : system.aggregateStock(1).categories) {
+        if (entry.category == "Garden") CHECK(sameTotals(garden, entry.totals));
+        if (entry.category == "Garden/Seeds") CHECK(sameTotals(seeds, entry.totals));
+    }
+    CHECK(system.getStockTotals("Nowhere").items == 0);
+
+    StockDrift drift = system.verifyStockTotals();
+    CHECK(drift.mismatchedCounts == 0);
+    CHECK(drift.maxValueError < 1e-6);
+    CHECK(system.getStockChangesSinceCheck() == 0);
+    CHECK(system.getLastStockDrift().mismatchedCounts == 0);
+}
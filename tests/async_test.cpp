@@ -0,0 +1,81 @@
+#include "test.h"
+
+#include "async.h"
+
+#include <optional>
+
+// AsyncWarehouse: orders short on stock suspend until stock arrives or
+// the order is cancelled
+
+static Task<> orderInto(AsyncWarehouse& warehouse, std::vector<OrderLine> lines, std::optional<int>& result) {
+    auto order = warehouse.createOrderAsync(std::move(lines));
+    result = co_await std::move(order);
+}
+
+struct AsyncFixture {
+    WarehouseSystem system;
+    Executor executor;
+    BlockingPool pool;
+    AsyncWarehouse warehouse;
+
+    explicit AsyncFixture(const std::string& path) : system(path), warehouse(system, executor, pool) {
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 2, 2.50, 0));
+        system.addItem(InventoryItem(2, "Soap", "Bath", 4, 1.25, 0));
+    }
+
+    // Start an order and run the executor until it finishes or waits for stock
+    void startOrder(std::vector<OrderLine> lines, std::optional<int>& result) {
+        std::size_t waiting = warehouse.getWaitingOrderCount();
+        executor.spawn(orderInto(warehouse, std::move(lines), result));
+        executor.runUntil([&]() { return result || warehouse.getWaitingOrderCount() > waiting; });
+    }
+};
+
+TEST(asyncOrdersWaitForReceivedStock) {
+    ScratchInventory file("async_receive");
+    AsyncFixture fixture(file.getPath());
+    std::optional<int> result;
+    fixture.startOrder({{1, 5}}, result);
+    CHECK(!result);
+    CHECK(fixture.warehouse.getWaitingOrderCount() == 1);
+    CHECK(fixture.system.findOrder(1)->getStatus() == OrderStatus::Backordered);
+
+    CHECK(syncWait(fixture.executor, fixture.warehouse.receiveShipmentAsync({{1, 3}})).received);
+    fixture.executor.runUntil([&]() { return result.has_value(); });
+    CHECK(result == 1);
+    CHECK(fixture.warehouse.getWaitingOrderCount() == 0);
+    CHECK(fixture.system.findOrder(1)->getStatus() == OrderStatus::Reserved);
+    CHECK(fixture.system.findItem(1)->getQuantity() == 0);
+}
+
+TEST(cancellingAWaitingOrderResumesIt) {
+    ScratchInventory file("async_cancel");
+    AsyncFixture fixture(file.getPath());
+    std::optional<int> result;
+    fixture.startOrder({{1, 5}}, result);
+    REQUIRE(fixture.warehouse.getWaitingOrderCount() == 1);
+
+    // No stock for item 1 ever arrives; the cancellation alone wakes the order
+    CHECK(syncWait(fixture.executor, fixture.warehouse.cancelOrderAsync(1)));
+    fixture.executor.runUntil([&]() { return result.has_value(); });
+    CHECK(result == 0);
+    CHECK(fixture.warehouse.getWaitingOrderCount() == 0);
+
+    // A later receipt for the item finds no stale waiter
+    CHECK(syncWait(fixture.executor, fixture.warehouse.receiveShipmentAsync({{1, 10}})).received);
+    CHECK(fixture.system.findItem(1)->getQuantity() == 12);
+}
+
+TEST(removingAnotherLineItemResumesAWaitingOrder) {
+    ScratchInventory file("async_remove");
+    AsyncFixture fixture(file.getPath());
+    std::optional<int> result;
+    fixture.startOrder({{1, 5}, {2, 1}}, result);
+    REQUIRE(fixture.warehouse.getWaitingOrderCount() == 1);
+
+    // The order waits on item 1, but removing item 2 cancels it
+    CHECK(syncWait(fixture.executor, fixture.warehouse.removeItemAsync(2)));
+    fixture.executor.runUntil([&]() { return result.has_value(); });
+    CHECK(result == 0);
+    CHECK(fixture.system.findOrder(1)->getStatus() == OrderStatus::Cancelled);
+}
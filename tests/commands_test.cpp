@@ -0,0 +1,134 @@
+#include "test.h"
+
+#include "commands.h"
+
+#include <sstream>
+
+// Batch commands: one table of specs, one parser for CSV and JSON lines,
+// and the outcome each command reports
+
+static Command parsedCommand(const std::string& line) {
+    Command command;
+    std::string error = parseCommand(line, command);
+    CHECK(error.empty());
+    return command;
+}
+
+TEST(commandSpecsFollowTheKinds) {
+    REQUIRE(commandSpecs().size() == kCommandKindCount);
+    for (std::size_t i = 0; i < kCommandKindCount; i++) {
+        auto kind = static_cast<CommandKind>(i);
+        CHECK(commandSpec(kind).kind == kind);
+        CHECK(findCommandSpec(commandSpec(kind).name) == &commandSpec(kind));
+        CHECK(commandSpec(kind).required <= commandSpec(kind).fields.size());
+    }
+    CHECK(!findCommandSpec("launch"));
+    CHECK(!commandSpec(CommandKind::Save).recorded);
+    CHECK(commandSpec(CommandKind::Order).recorded);
+}
+
+TEST(csvAndJsonLinesParseAlike) {
+    Command csv = parsedCommand("amend,4,7,2");
+    Command json = parsedCommand(R"({"cmd": "amend", "order": 4, "quantity": 7, "item": 2})");
+    CHECK(csv.kind == CommandKind::Amend);
+    CHECK(json.kind == CommandKind::Amend);
+    CHECK(csv.args == json.args);
+    CHECK(json.id == 4);
+    CHECK(json.quantity == 7);
+    CHECK(json.itemId == 2);
+
+    Command order = parsedCommand("multiorder,1:2 3:4");
+    REQUIRE(order.lines.size() == 2);
+    CHECK(order.lines[1].getItemId() == 3);
+    CHECK(order.lines[1].getQuantity() == 4);
+
+    CHECK(parsedCommand("search,soap").limit == 10);
+    CHECK(parsedCommand("process").id == 1);
+
+    CHECK(isCommandLine("list"));
+    CHECK(!isCommandLine("   "));
+    CHECK(!isCommandLine("# list"));
+}
+
+TEST(badCommandLinesAreRejected) {
+    Command command;
+    for (const char* line : {"launch", "find", "find,1,2", "find,one", "search,soap,0", "reorders,-3",
+                             "process,0", "multiorder,1-2", "policy,Random", "sort,price",
+                             "query,colour=red", R"({"cmd": "find")", R"({"cmd": "order", "item": 1})"}) {
+        CHECK(!parseCommand(line, command).empty());
+    }
+}
+
+TEST(commandsReportTheirOutcome) {
+    ScratchInventory file("commands");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+
+    CommandResult result = executeCommand(system, parsedCommand("receive,1,5"));
+    CHECK(result.succeeded());
+    CHECK(system.findItem(1)->getQuantity() == 15);
+
+    result = executeCommand(system, parsedCommand("order,1,4"));
+    CHECK(result.succeeded());
+    CHECK(system.getReservedQuantity(1) == 4);
+
+    CHECK(executeCommand(system, parsedCommand("find,9")).status == CommandStatus::NotFound);
+    CHECK(executeCommand(system, parsedCommand("cancel,9")).status == CommandStatus::NotFound);
+    CHECK(executeCommand(system, parsedCommand("receive,1,-5")).status == CommandStatus::Rejected);
+    CHECK(executeCommand(system, parsedCommand("policy,Nearest,Nowhere")).status == CommandStatus::Rejected);
+
+    // Replays compare the observed values, so the same command on the same
+    // state observes the same
+    CommandResult first = executeCommand(system, parsedCommand("find,1"));
+    CommandResult second = executeCommand(system, parsedCommand("find,1"));
+    CHECK(first.observedCount > 0);
+    CHECK(first.observed == second.observed);
+}
+
+TEST(failedOrdersAreCounted) {
+    ScratchInventory file("command_orders");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+
+    CHECK(executeCommand(system, parsedCommand("order,99,1")).status == CommandStatus::NotFound);
+    CHECK(executeCommand(system, parsedCommand("order,1,0")).status == CommandStatus::Rejected);
+    CHECK(executeCommand(system, parsedCommand("multiorder,1:1 99:1")).status == CommandStatus::NotFound);
+    CHECK(executeCommand(system, parsedCommand("multiorder,1:-1")).status == CommandStatus::Rejected);
+    CHECK(system.getPendingOrderCount() == 0);
+    CHECK(executeCommand(system, parsedCommand("order,1,3")).succeeded());
+
+    // Processing stops at the first empty queue instead of running every round
+    std::ostringstream output;
+    std::streambuf* previous = std::cout.rdbuf(output.rdbuf());
+    CommandResult result = executeCommand(system, parsedCommand("process,50"));
+    std::cout.rdbuf(previous);
+    CHECK(result.succeeded());
+    CHECK(system.getPendingOrderCount() == 0);
+    std::string text = output.str();
+    std::size_t first = text.find("No orders to process!");
+    CHECK(first != std::string::npos);
+    CHECK(text.find("No orders to process!", first + 1) == std::string::npos);
+}
+
+TEST(batchItemsAreValidatedLikeTheServer) {
+    ScratchInventory file("command_items");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+
+    for (const char* line : {"add,Soap,Bath,-1,1.00,0", "add,Soap,Bath,1,-1.00,0",
+                             "add,Soap,Bath,1,1.00,-2", "update,1,Rice,Pantry,-5,2.50,2",
+                             R"({"cmd": "add", "name": "Soap\nDish", "category": "Bath",)"
+                             R"( "quantity": 1, "price": 1.00, "min": 0})"}) {
+        CHECK(executeCommand(system, parsedCommand(line)).status == CommandStatus::Rejected);
+    }
+    CHECK(system.getAllItems().size() == 1);
+    CHECK(system.findItem(1)->getQuantity() == 10);
+    CHECK(executeCommand(system, parsedCommand("add,Soap,Bath,1,1.00,0")).succeeded());
+
+    // Control characters would split a row of the inventory file
+    CHECK(!WarehouseSystem::isValidItem(InventoryItem(2, "Soap\tDish", "Bath", 1, 1.00, 0)));
+    CHECK(!WarehouseSystem::isValidItem(InventoryItem(2, "Soap", "Bath\r", 1, 1.00, 0)));
+}
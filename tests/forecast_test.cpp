@@ -0,0 +1,151 @@
+#include "test.h"
+
+#include "forecast.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Demand forecasts: quiet days folded in closed form against smoothing
+// every day in turn, and the reorder points drawn from them
+
+static const std::time_t kDay = 86400;
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+TEST(quietDaysFoldLikeDailySmoothing) {
+    ForecastSettings settings;
+    settings.smoothing = 0.3;
+    DemandForecaster folded(settings);
+    DemandForecaster daily(settings);
+
+    // Demand on a few scattered days; the daily forecaster also sees every
+    // quiet day in between as a day of no demand
+    std::mt19937 random(17);
+    std::time_t start = 1000 * kDay;
+    std::int64_t day = 0;
+    folded.recordDemand(1, 5, start);
+    daily.recordDemand(1, 5, start);
+    for (int event = 0; event < 200; event++) {
+        std::int64_t next = day + static_cast<std::int64_t>(random() % 12);
+        for (std::int64_t quiet = day + 1; quiet < next; quiet++) {
+            daily.recordDemand(1, 0, start + quiet * kDay);
+        }
+        double units = static_cast<double>(1 + random() % 9);
+        std::time_t when = start + next * kDay + static_cast<std::time_t>(random() % kDay);
+        folded.recordDemand(1, units, when);
+        daily.recordDemand(1, units, when);
+        day = next;
+    }
+
+    for (std::int64_t later : {0, 1, 5, 40}) {
+        std::time_t now = start + (day + later) * kDay;
+        for (std::int64_t quiet = day + 1; quiet < day + later; quiet++) {
+            daily.recordDemand(1, 0, start + quiet * kDay);
+        }
+        ReorderRecommendation fromFolded, fromDaily;
+        REQUIRE(folded.recommend(1, now, fromFolded));
+        REQUIRE(daily.recommend(1, now, fromDaily));
+        CHECK(near(fromFolded.dailyDemand, fromDaily.dailyDemand));
+        CHECK(near(fromFolded.deviation, fromDaily.deviation));
+        CHECK(fromFolded.reorderPoint == fromDaily.reorderPoint);
+        CHECK(fromFolded.reorderQuantity == fromDaily.reorderQuantity);
+    }
+}
+
+TEST(forecastSmoothsFinishedDays) {
+    ForecastSettings settings;
+    settings.smoothing = 0.5;
+    settings.leadTimeDays = 4;
+    settings.coverDays = 10;
+    settings.serviceFactor = 2;
+    DemandForecaster forecaster(settings);
+    std::time_t start = 500 * kDay;
+
+    // Until a day finishes, today's demand stands in for the daily demand
+    forecaster.recordDemand(1, 6, start);
+    forecaster.recordDemand(1, 2, start + 60);
+    ReorderRecommendation result;
+    REQUIRE(forecaster.recommend(1, start + 120, result));
+    CHECK(near(result.dailyDemand, 8));
+    CHECK(result.deviation == 0);
+    CHECK(result.reorderPoint == 32);
+    CHECK(result.reorderQuantity == 80);
+
+    // Day 0 had 8 units and day 1 has 4, with 2 of them returned:
+    //     level = 8 + 0.5 * (2 - 8) = 5, variance = 0.5 * 0.5 * 36 = 9
+    forecaster.recordDemand(1, 4, start + kDay);
+    forecaster.recordDemand(1, -2, start + kDay + 10);
+    REQUIRE(forecaster.recommend(1, start + 2 * kDay, result));
+    CHECK(near(result.dailyDemand, 5));
+    CHECK(near(result.deviation, 3));
+    CHECK(result.reorderPoint == 32);  // 5 * 4 + 2 * 3 * sqrt(4)
+    CHECK(result.reorderQuantity == 50);
+
+    // Late demand counts towards the current day, which now has 12 units
+    forecaster.recordDemand(1, 10, start);
+    REQUIRE(forecaster.recommend(1, start + 2 * kDay, result));
+    CHECK(near(result.dailyDemand, 8 + 0.5 * (12 - 8)));
+
+    CHECK(!forecaster.recommend(2, start, result));
+    forecaster.erase(1);
+    CHECK(!forecaster.recommend(1, start, result));
+    CHECK(forecaster.size() == 0);
+}
+
+TEST(recommendAllCoversEveryItem) {
+    DemandForecaster forecaster;
+    std::time_t start = 2000 * kDay;
+    for (int id = 1; id <= 100; id++) {
+        forecaster.recordDemand(id, id, start);
+        forecaster.recordDemand(id, id, start + kDay);
+    }
+    forecaster.erase(50);
+
+    auto all = forecaster.recommendAll(start + 2 * kDay, 2);
+    CHECK(all.size() == 99);
+    for (const auto& recommendation : all) {
+        ReorderRecommendation single;
+        REQUIRE(forecaster.recommend(recommendation.itemId, start + 2 * kDay, single));
+        CHECK(recommendation.itemId != 50);
+        CHECK(near(recommendation.dailyDemand, recommendation.itemId));
+        CHECK(recommendation.reorderPoint == single.reorderPoint);
+    }
+}
+
+TEST(ordersFeedReorderPoints) {
+    ScratchInventory file("forecast_orders");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 100, 2.50, 0));
+    system.addItem(InventoryItem(2, "Soap", "Bath", 100, 1.25, 0));
+
+    ForecastSettings settings;
+    settings.leadTimeDays = 2;
+    settings.coverDays = 5;
+    settings.serviceFactor = 0;
+    system.setForecastSettings(settings);
+
+    // Stock taken today is today's demand; cancelled orders give it back
+    int kept = system.placeOrder(1, 6);
+    int cancelled = system.placeOrder(1, 4);
+    CHECK(system.setOrderStatus(kept, OrderStatus::Reserved));
+    CHECK(system.setOrderStatus(cancelled, OrderStatus::Reserved));
+    CHECK(system.cancelOrder(cancelled));
+
+    ReorderRecommendation result;
+    REQUIRE(system.getReorderRecommendation(1, result));
+    CHECK(near(result.dailyDemand, 6));
+    CHECK(result.reorderPoint == 12);
+    CHECK(result.reorderQuantity == 30);
+    CHECK(!system.getReorderRecommendation(2, result));
+
+    auto recommendations = system.recommendReorders();
+    REQUIRE(recommendations.size() == 1);
+    CHECK(recommendations[0].itemId == 1);
+    CHECK(system.applyReorderPoints() == 1);
+    CHECK(system.findItem(1)->getMinStockLevel() == 12);
+    CHECK(system.findItem(2)->getMinStockLevel() == 0);
+}
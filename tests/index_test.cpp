@@ -0,0 +1,95 @@
+#include "test.h"
+
+#include "query.h"
+
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
+
+// RangeIndex against a std::set of (key, ID) pairs, through enough entries
+// to split blocks
+
+static std::vector<int> expectedIds(const std::set<std::pair<int, int>>& entries, int low, int high) {
+    std::vector<int> ids;
+    for (auto it = entries.lower_bound({low, std::numeric_limits<int>::min()});
+         it != entries.end() && it->first <= high; ++it) {
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+TEST(rangeIndexMatchesASortedSet) {
+    std::mt19937 random(7);
+    RangeIndex<int> index;
+    std::set<std::pair<int, int>> expected;
+    std::vector<int> keyOf(4000, -1);
+
+    for (int step = 0; step < 20000; step++) {
+        int id = static_cast<int>(random() % keyOf.size());
+        int key = static_cast<int>(random() % 300);
+        int& current = keyOf[static_cast<std::size_t>(id)];
+        switch (random() % 3) {
+            case 0:
+                if (current < 0) {
+                    index.insert(key, id);
+                    expected.insert({key, id});
+                    current = key;
+                }
+                break;
+            case 1:
+                if (current >= 0) {
+                    // Small changes stay in their block, large ones move
+                    int moved = random() % 2 ? current + static_cast<int>(random() % 5) - 2 : key;
+                    index.update(current, moved, id);
+                    expected.erase({current, id});
+                    expected.insert({moved, id});
+                    current = moved;
+                }
+                break;
+            default:
+                if (current >= 0) {
+                    index.erase(current, id);
+                    expected.erase({current, id});
+                    current = -1;
+                }
+                break;
+        }
+    }
+    REQUIRE(index.size() == expected.size());
+    CHECK(expected.size() > 1000);
+
+    for (int probe = 0; probe < 200; probe++) {
+        int low = static_cast<int>(random() % 320) - 10;
+        int high = low + static_cast<int>(random() % 60);
+        auto want = expectedIds(expected, low, high);
+        std::vector<int> got;
+        index.idsInRange(low, high, got);
+        CHECK(got == want);
+        CHECK(index.count(low, high, std::numeric_limits<std::size_t>::max()) == want.size());
+        CHECK(index.count(low, high, 3) == std::min<std::size_t>(want.size(), 3));
+    }
+    std::vector<int> none;
+    index.idsInRange(50, 10, none);
+    CHECK(none.empty());
+}
+
+TEST(rangeIndexHandlesDuplicateKeys) {
+    RangeIndex<double> index;
+    for (int id = 0; id < 2000; id++) {
+        index.insert(1.5, id);
+    }
+    index.insert(0.5, 5000);
+    index.insert(2.5, 5001);
+    CHECK(index.count(1.5, 1.5, 100000) == 2000);
+    index.erase(1.5, 1000);
+    index.erase(1.5, 999999);  // Not there
+    CHECK(index.size() == 2001);
+
+    std::vector<int> ids;
+    index.idsInRange(0.0, 1.5, ids);
+    REQUIRE(ids.size() == 2000);
+    CHECK(ids.front() == 5000);
+    CHECK(ids[1] == 0 && ids.back() == 1999);
+    CHECK(std::find(ids.begin(), ids.end(), 1000) == ids.end());
+}
@@ -0,0 +1,170 @@
+#include "test.h"
+
+// Stock by location and the pick allocation policies
+
+static int pickedFrom(const LocationStock& stock, const std::vector<Pick>& picks, std::size_t i,
+                      const char* path) {
+    return i < picks.size() && stock.getPath(picks[i].location) == path ? picks[i].quantity : 0;
+}
+
+TEST(locationPathsNeedThreeParts) {
+    LocationStock stock;
+    CHECK(stock.intern("East/A/01") == 0);
+    CHECK(stock.intern("East/A/02") == 1);
+    CHECK(stock.intern("East/A/01") == 0);
+    CHECK(stock.intern("East/A") == kNoLocation);
+    CHECK(stock.intern("East//01") == kNoLocation);
+    CHECK(stock.intern("East/A/01/x") == kNoLocation);
+    CHECK(stock.intern("East/A,B/01") == kNoLocation);
+    CHECK(stock.intern("") == kNoLocation);
+    CHECK(stock.find("West/A/01") == kNoLocation);
+    CHECK(stock.getLocationCount() == 2);
+}
+
+TEST(nearestPicksTheOriginZoneThenWarehouse) {
+    LocationStock stock;
+    for (const char* path : {"West/A/01", "East/B/02", "East/A/05", "East/A/01"}) {
+        stock.add(7, stock.intern(path), 5);
+    }
+    LocationId origin = stock.intern("East/A/09");
+    std::vector<Pick> picks;
+    CHECK(stock.take(7, 17, AllocationPolicy::Nearest, origin, picks) == 17);
+    REQUIRE(picks.size() == 4);
+    // Ties within the zone go to the lower location ID
+    CHECK(pickedFrom(stock, picks, 0, "East/A/05") == 5);
+    CHECK(pickedFrom(stock, picks, 1, "East/A/01") == 5);
+    CHECK(pickedFrom(stock, picks, 2, "East/B/02") == 5);
+    CHECK(pickedFrom(stock, picks, 3, "West/A/01") == 2);
+    CHECK(stock.getItemTotal(7) == 3);
+    CHECK(stock.getBins(7).size() == 1);
+
+    // The origin bin itself comes first
+    stock.add(7, stock.intern("West/C/03"), 4);
+    stock.add(7, origin, 4);
+    picks.clear();
+    CHECK(stock.take(7, 4, AllocationPolicy::Nearest, stock.find("West/C/03"), picks) == 4);
+    CHECK(pickedFrom(stock, picks, 0, "West/C/03") == 4);
+}
+
+TEST(fifoLotPicksTheOldestReceiptFirst) {
+    LocationStock stock;
+    LocationId east = stock.intern("East/A/01");
+    LocationId west = stock.intern("West/A/01");
+    LocationId north = stock.intern("North/A/01");
+    stock.add(7, west, 5);
+    stock.add(7, north, 5);
+    stock.add(7, east, 5);
+    stock.add(7, north, 5);  // Joins the bin's older lot
+    std::vector<Pick> picks;
+    CHECK(stock.take(7, 12, AllocationPolicy::FifoLot, east, picks) == 12);
+    REQUIRE(picks.size() == 2);
+    CHECK(pickedFrom(stock, picks, 0, "West/A/01") == 5);
+    CHECK(pickedFrom(stock, picks, 1, "North/A/01") == 7);
+    CHECK(picks[0].lot < picks[1].lot);
+
+    // Stock put back keeps its lot, so it is still picked first
+    stock.add(7, west, 2, picks[0].lot);
+    picks.clear();
+    stock.take(7, 1, AllocationPolicy::FifoLot, kNoLocation, picks);
+    CHECK(pickedFrom(stock, picks, 0, "West/A/01") == 1);
+}
+
+TEST(fewestPicksPrefersOneCoveringBin) {
+    LocationStock stock;
+    stock.add(7, stock.intern("East/A/01"), 3);
+    stock.add(7, stock.intern("East/A/02"), 10);
+    stock.add(7, stock.intern("East/A/03"), 6);
+    std::vector<Pick> picks;
+    CHECK(stock.take(7, 5, AllocationPolicy::FewestPicks, kNoLocation, picks) == 5);
+    REQUIRE(picks.size() == 1);
+    CHECK(pickedFrom(stock, picks, 0, "East/A/03") == 5);
+
+    // Nothing covers it, so the fullest bins go first
+    picks.clear();
+    CHECK(stock.take(7, 20, AllocationPolicy::FewestPicks, kNoLocation, picks) == 14);
+    REQUIRE(picks.size() == 3);
+    CHECK(pickedFrom(stock, picks, 0, "East/A/02") == 10);
+    CHECK(pickedFrom(stock, picks, 1, "East/A/01") == 3);
+    CHECK(pickedFrom(stock, picks, 2, "East/A/03") == 1);
+    CHECK(stock.getBins(7).empty());
+}
+
+TEST(locationTotalsFollowEveryChange) {
+    LocationStock stock;
+    LocationId a = stock.intern("East/A/01");
+    LocationId b = stock.intern("East/B/01");
+    LocationId c = stock.intern("West/A/01");
+    stock.add(1, a, 4);
+    stock.add(2, a, 6);
+    stock.add(1, c, 5);
+    CHECK(stock.getLocationTotal(a) == 10);
+    CHECK(stock.getZoneTotal("East/A") == 10);
+    CHECK(stock.getWarehouseTotal("East") == 10);
+    CHECK(stock.getTotal() == 15);
+
+    CHECK(stock.move(1, a, b, 3));
+    CHECK(!stock.move(1, a, b, 2));
+    CHECK(stock.getQuantity(1, a) == 1);
+    CHECK(stock.getQuantity(1, b) == 3);
+    CHECK(stock.getZoneTotal("East/B") == 3);
+    CHECK(stock.getWarehouseTotal("East") == 10);
+
+    stock.erase(1);
+    CHECK(stock.getItemTotal(1) == 0);
+    CHECK(stock.getTotal() == 6);
+    CHECK(stock.getWarehouseTotal("West") == 0);
+    CHECK(stock.getWarehouseTotal("South") == 0);
+}
+
+TEST(ordersPickFromBinsAndPutCancelledStockBack) {
+    ScratchInventory file("order_picks");
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 0, 2.50, 2));
+        CHECK(system.receiveStockAt(1, "East/A/01", 4).received);
+        CHECK(system.receiveStockAt(1, "West/A/01", 6).received);
+        CHECK(system.receiveStock(1, 2).received);
+        CHECK(system.getUnlocatedQuantity(1) == 2);
+        CHECK(system.setAllocationPolicy(AllocationPolicy::FewestPicks));
+        CHECK(!system.setAllocationPolicy(AllocationPolicy::Nearest, "nowhere"));
+
+        int orderId = system.placeOrder(1, 5);
+        CHECK(system.fulfillOrder(orderId) == WarehouseSystem::OrderResult::Processed);
+        auto picks = system.getOrderPicks(orderId);
+        REQUIRE(picks.size() == 1);
+        CHECK(system.getLocations().getPath(picks[0].location) == "West/A/01");
+        CHECK(system.getLocations().getItemTotal(1) == 5);
+    }
+    // Picks survive a restart, so cancelling still returns the stock to its bin
+    WarehouseSystem system(file.getPath());
+    const LocationStock& stock = system.getLocations();
+    CHECK(system.getOrderPicks(1).size() == 1);
+    CHECK(system.cancelOrder(1));
+    CHECK(system.getOrderPicks(1).empty());
+    CHECK(stock.getQuantity(1, stock.find("West/A/01")) == 6);
+    CHECK(stock.getQuantity(1, stock.find("East/A/01")) == 4);
+    CHECK(system.findItem(1)->getQuantity() == 12);
+}
+
+TEST(rejectedReceiptsAddNoLocation) {
+    ScratchInventory file("rejected_receipts");
+    WarehouseSystem system(file.getPath());
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 0, 2.50, 2));
+    CHECK(!system.receiveStockAt(9, "East/A/01", 4).received);
+    CHECK(!system.receiveStockAt(1, "East/A/01", 0).received);
+    CHECK(!system.receiveStockAt(1, "East/A", 4).received);
+    CHECK(system.getLocations().getLocationCount() == 0);
+    CHECK(!system.moveStock(1, "", "East/A/01", 1));
+}
+
+TEST(pickOriginMustBeAKnownLocation) {
+    ScratchInventory file("pick_origin");
+    WarehouseSystem system(file.getPath());
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 0, 2.50, 2));
+    CHECK(system.receiveStockAt(1, "East/A/01", 4).received);
+    CHECK(!system.setAllocationPolicy(AllocationPolicy::FifoLot, "East/A/09"));
+    CHECK(system.getAllocationPolicy() == AllocationPolicy::Nearest);
+    CHECK(system.getLocations().getLocationCount() == 1);
+    CHECK(system.setAllocationPolicy(AllocationPolicy::FifoLot, "East/A/01"));
+    CHECK(system.getAllocationPolicy() == AllocationPolicy::FifoLot);
+}
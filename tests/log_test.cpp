@@ -0,0 +1,185 @@
+#include "test.h"
+
+#include <fstream>
+
+// Recovery of the order and stock logs
+
+static std::size_t fileSize(const std::string& path) {
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    return error ? 0 : static_cast<std::size_t>(size);
+}
+
+// Order log records are 24 bytes plus 8 per line, after an 8-byte header
+static const std::size_t kHeader = 8;
+static const std::size_t kSingleLineRecord = 32;
+
+static void placeThreeOrders(const std::string& path) {
+    WarehouseSystem system(path);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+    system.placeOrder(1, 1);
+    system.placeOrder(1, 2);
+    system.placeOrder(1, 3);
+}
+
+TEST(orderLogRestoresTheQueue) {
+    ScratchInventory file("order_log");
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+        system.addItem(InventoryItem(2, "Soap", "Bath", 5, 1.25, 1));
+        std::vector<OrderLine> lines{{1, 4}, {2, 1}};
+        int first = system.placeOrder(lines);
+        int second = system.placeOrder(1, 2);
+        system.placeOrder(2, 50);
+        system.setOrderStatus(first, OrderStatus::Reserved);
+        system.amendOrder(second, 3);
+    }
+    WarehouseSystem system(file.getPath());
+    REQUIRE(system.findOrder(3));
+    CHECK(system.findOrder(1)->getStatus() == OrderStatus::Reserved);
+    CHECK(system.findOrder(1)->getLines().size() == 2);
+    CHECK(system.findOrder(2)->getStatus() == OrderStatus::Pending);
+    CHECK(system.findOrder(2)->getQuantity() == 3);
+    CHECK(system.findOrder(3)->getStatus() == OrderStatus::Backordered);
+    CHECK(system.getReservedQuantity(1) == 3);
+    CHECK(system.placeOrder(1, 1) == 4);
+}
+
+TEST(tornOrderLogKeepsCompleteRecords) {
+    ScratchInventory file("torn_order_log");
+    placeThreeOrders(file.getPath());
+    std::string logPath = WarehouseSystem::orderLogPathFor(file.getPath());
+    REQUIRE(fileSize(logPath) == kHeader + 3 * kSingleLineRecord);
+    std::filesystem::resize_file(logPath, kHeader + 3 * kSingleLineRecord - 5);
+
+    {
+        WarehouseSystem system(file.getPath());
+        CHECK(system.findOrder(2));
+        CHECK(!system.findOrder(3));
+        CHECK(system.getReservedQuantity(1) == 3);
+        CHECK(system.placeOrder(1, 4) == 3);
+    }
+    // The torn tail was replaced by a clean log
+    WarehouseSystem system(file.getPath());
+    REQUIRE(system.findOrder(3));
+    CHECK(system.findOrder(3)->getQuantity() == 4);
+    CHECK(system.getReservedQuantity(1) == 7);
+}
+
+TEST(corruptOrderLogKeepsRecordsBeforeTheDamage) {
+    ScratchInventory file("corrupt_order_log");
+    placeThreeOrders(file.getPath());
+    std::string logPath = WarehouseSystem::orderLogPathFor(file.getPath());
+    {
+        // An impossible status in the second record
+        std::fstream log(logPath, std::ios::in | std::ios::out | std::ios::binary);
+        log.seekp(static_cast<std::streamoff>(kHeader + kSingleLineRecord + 8));
+        log.put(static_cast<char>(0x7f));
+    }
+    WarehouseSystem system(file.getPath());
+    CHECK(system.findOrder(1));
+    CHECK(!system.findOrder(2));
+    CHECK(!system.findOrder(3));
+    CHECK(system.getReservedQuantity(1) == 1);
+    CHECK(fileSize(logPath) == kHeader + kSingleLineRecord);
+}
+
+TEST(unknownOrderLogIsReplaced) {
+    ScratchInventory file("unknown_order_log");
+    placeThreeOrders(file.getPath());
+    std::string logPath = WarehouseSystem::orderLogPathFor(file.getPath());
+    {
+        std::ofstream log(logPath, std::ios::binary | std::ios::trunc);
+        log << "not an order log";
+    }
+    WarehouseSystem system(file.getPath());
+    CHECK(!system.findOrder(1));
+    CHECK(system.placeOrder(1, 1) == 1);
+}
+
+TEST(compactedOrderLogKeepsTheQueue) {
+    ScratchInventory file("compaction");
+    std::string logPath = WarehouseSystem::orderLogPathFor(file.getPath());
+    std::size_t before = 0;
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+        for (int i = 0; i < 4; i++) {
+            system.placeOrder(1, 1);
+        }
+        // Order 1 goes through to shipping; the backorder is retried twice
+        system.setOrderStatus(1, OrderStatus::Reserved);
+        system.setOrderStatus(1, OrderStatus::Picked);
+        system.setOrderStatus(1, OrderStatus::Shipped);
+        system.setOrderStatus(3, OrderStatus::Backordered);
+        system.setOrderStatus(2, OrderStatus::Backordered);
+        system.fulfillOrder(3);
+        system.setOrderStatus(3, OrderStatus::Cancelled);
+        before = fileSize(logPath);
+        CHECK(system.compactOrderLog());
+        CHECK(fileSize(logPath) < before);
+    }
+    WarehouseSystem system(file.getPath());
+    CHECK(system.findOrder(1)->getStatus() == OrderStatus::Shipped);
+    CHECK(system.findOrder(2)->getStatus() == OrderStatus::Backordered);
+    CHECK(system.findOrder(3)->getStatus() == OrderStatus::Cancelled);
+    CHECK(system.findOrder(4)->getStatus() == OrderStatus::Pending);
+    CHECK(system.findItem(1)->getQuantity() == 19);
+}
+
+TEST(stockLogReplaysReceiptsWithoutRewritingTheCsv) {
+    ScratchInventory file("stock_log");
+    std::size_t csvSize = 0;
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+        system.addItem(InventoryItem(2, "Soap", "Bath", 5, 1.25, 1));
+        csvSize = fileSize(file.getPath());
+        CHECK(system.receiveStock(1, 7).received);
+        std::vector<RestockLine> shipment{{2, 3}, {1, 1}, {2, 2}};
+        CHECK(system.receiveShipment(shipment).received);
+        std::vector<RestockLine> bad{{1, 5}, {9, 1}};
+        CHECK(!system.receiveShipment(bad).received);
+        CHECK(system.findItem(1)->getQuantity() == 28);
+    }
+    CHECK(fileSize(file.getPath()) == csvSize);
+    WarehouseSystem system(file.getPath());
+    CHECK(system.findItem(1)->getQuantity() == 28);
+    CHECK(system.findItem(2)->getQuantity() == 10);
+}
+
+TEST(tornStockLogKeepsCompleteReceipts) {
+    ScratchInventory file("torn_stock_log");
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+        system.receiveStock(1, 5);
+        system.receiveStock(1, 6);
+    }
+    std::string logPath = WarehouseSystem::stockLogPathFor(file.getPath());
+    std::filesystem::resize_file(logPath, fileSize(logPath) - 3);
+    {
+        WarehouseSystem system(file.getPath());
+        CHECK(system.findItem(1)->getQuantity() == 25);
+    }
+    // The recovered stock went into the CSV file and the log started over
+    WarehouseSystem system(file.getPath());
+    CHECK(system.findItem(1)->getQuantity() == 25);
+}
+
+TEST(stockLogForAnotherCsvIsIgnored) {
+    ScratchInventory file("stale_stock_log");
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 20, 2.50, 2));
+        system.receiveStock(1, 5);
+    }
+    {
+        // The CSV file was edited by hand since the receipt was logged
+        std::ofstream csv(file.getPath(), std::ios::trunc);
+        csv << "ID,Name,Category,Quantity,Price,MinStockLevel\n1,Rice,Pantry,40,2.50,2\n";
+    }
+    WarehouseSystem system(file.getPath());
+    CHECK(system.findItem(1)->getQuantity() == 40);
+}
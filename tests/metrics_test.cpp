@@ -0,0 +1,25 @@
+#include "test.h"
+
+#include "metrics.h"
+
+#include <sstream>
+
+// Operation metrics
+
+TEST(metricsLeaveTheStreamFormattingAlone) {
+    ScratchInventory file("metrics");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+    system.searchItems("rice");
+
+    std::ostringstream out;
+    out << 1.0 / 3 << " ";
+    Metrics::writeText(out);
+    Metrics::writePrometheus(out);
+    out << 1.0 / 3;
+    std::string text = out.str();
+    CHECK(text.starts_with("0.333333 "));
+    CHECK(text.ends_with("\n0.333333"));
+    CHECK(text.find("warehouse_operation_duration_seconds_count") != std::string::npos);
+}
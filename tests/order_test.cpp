@@ -0,0 +1,235 @@
+#include "test.h"
+
+#include <limits>
+
+// Orders: the state machine, promised stock and all-or-nothing reservation
+
+static WarehouseSystem& stockedSystem(WarehouseSystem& system) {
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+    system.addItem(InventoryItem(2, "Soap", "Bath", 4, 1.25, 1));
+    return system;
+}
+
+TEST(orderStateMachineAllowsOnlyValidMoves) {
+    ScratchInventory file("state_machine");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    int orderId = system.placeOrder(1, 3);
+    REQUIRE(orderId != 0);
+    CHECK(system.findOrder(orderId)->getStatus() == OrderStatus::Pending);
+    CHECK(!system.setOrderStatus(orderId, OrderStatus::Picked));
+    CHECK(!system.setOrderStatus(orderId, OrderStatus::Shipped));
+
+    CHECK(system.setOrderStatus(orderId, OrderStatus::Reserved));
+    CHECK(system.findItem(1)->getQuantity() == 7);
+    CHECK(!system.setOrderStatus(orderId, OrderStatus::Pending));
+    CHECK(!system.setOrderStatus(orderId, OrderStatus::Backordered));
+
+    CHECK(system.setOrderStatus(orderId, OrderStatus::Picked));
+    CHECK(!system.cancelOrder(orderId));
+    CHECK(system.setOrderStatus(orderId, OrderStatus::Shipped));
+    CHECK(!system.cancelOrder(orderId));
+    CHECK(!system.setOrderStatus(orderId, OrderStatus::Reserved));
+    CHECK(system.findOrder(orderId)->getStatus() == OrderStatus::Shipped);
+    CHECK(system.findItem(1)->getQuantity() == 7);
+
+    CHECK(!system.setOrderStatus(999, OrderStatus::Cancelled));
+}
+
+TEST(orderListsFollowTheStateMachine) {
+    ScratchInventory file("order_lists");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    int first = system.placeOrder(1, 2);
+    int second = system.placeOrder(1, 2);
+    int backordered = system.placeOrder(2, 50);
+    CHECK(system.getOrderCount(OrderStatus::Pending) == 2);
+    CHECK(system.getOrderCount(OrderStatus::Backordered) == 1);
+    CHECK(system.findOrder(backordered)->getStatus() == OrderStatus::Backordered);
+
+    CHECK(system.fulfillNextOrder() == WarehouseSystem::OrderResult::Processed);
+    CHECK(system.findOrder(first)->getStatus() == OrderStatus::Reserved);
+    CHECK(system.cancelOrder(second));
+
+    auto pending = system.getOrdersByStatus(OrderStatus::Pending);
+    CHECK(pending.empty());
+    auto open = system.getOpenOrdersForItem(1);
+    REQUIRE(open.size() == 1);
+    CHECK(open[0].getOrderId() == first);
+    CHECK(system.getOrderCount(OrderStatus::Cancelled) == 1);
+}
+
+TEST(pendingOrdersPromiseStock) {
+    ScratchInventory file("promises");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    int promised = system.placeOrder(1, 6);
+    CHECK(system.getReservedQuantity(1) == 6);
+    CHECK(system.getAvailableQuantity(1) == 4);
+    CHECK(system.findItem(1)->getQuantity() == 10);
+
+    // Not enough left unpromised, so the next order waits
+    int waiting = system.placeOrder(1, 5);
+    CHECK(system.findOrder(waiting)->getStatus() == OrderStatus::Backordered);
+    CHECK(system.getReservedQuantity(1) == 6);
+
+    CHECK(system.cancelOrder(promised));
+    CHECK(system.getReservedQuantity(1) == 0);
+    CHECK(system.getAvailableQuantity(1) == 10);
+}
+
+TEST(multiLineOrderReservesAllOrNothing) {
+    ScratchInventory file("all_or_nothing");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    std::vector<OrderLine> lines{{1, 3}, {2, 2}};
+    int orderId = system.placeOrder(lines);
+    REQUIRE(orderId != 0);
+    CHECK(system.getReservedQuantity(1) == 3);
+    CHECK(system.getReservedQuantity(2) == 2);
+
+    // The promise falls through once the second item runs short, and the
+    // first line's stock stays where it is
+    InventoryItem soap = *system.findItem(2);
+    soap.setQuantity(1);
+    CHECK(system.updateItem(soap));
+    CHECK(system.fulfillOrder(orderId) == WarehouseSystem::OrderResult::InsufficientStock);
+    CHECK(system.findItem(1)->getQuantity() == 10);
+    CHECK(system.findItem(2)->getQuantity() == 1);
+    CHECK(system.findOrder(orderId)->getStatus() == OrderStatus::Backordered);
+    CHECK(system.getReservedQuantity(1) == 0);
+
+    soap.setQuantity(2);
+    CHECK(system.updateItem(soap));
+    CHECK(system.fulfillOrder(orderId) == WarehouseSystem::OrderResult::Processed);
+    CHECK(system.findItem(1)->getQuantity() == 7);
+    CHECK(system.findItem(2)->getQuantity() == 0);
+}
+
+TEST(failedReservationLeavesNoTrace) {
+    ScratchInventory file("failed_reservation");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    // A draft one line short of being issued
+    for (int id = 1; id < 50; id++) {
+        system.addItem(InventoryItem(id, "Part", "C", 0, 1.00, 1));
+    }
+    system.addItem(InventoryItem(50, "Bolt", "C", 10, 1.00, 2));
+    system.addItem(InventoryItem(51, "Nut", "D", 5, 1.00, 0));
+    std::vector<OrderLine> lines{{50, 9}, {51, 1}};
+    int orderId = system.placeOrder(lines);
+    InventoryItem nut = *system.findItem(51);
+    nut.setQuantity(0);
+    CHECK(system.updateItem(nut));
+
+    std::size_t changes = system.getStockChangesSinceCheck();
+    CHECK(system.fulfillOrder(orderId) == WarehouseSystem::OrderResult::InsufficientStock);
+    CHECK(system.findItem(50)->getQuantity() == 10);
+    CHECK(!system.getReplenishment().hasRequest(50));
+    CHECK(system.getReplenishment().getInbound().empty());
+    CHECK(system.getStockChangesSinceCheck() == changes);
+}
+
+TEST(invalidOrdersAreRejectedWhole) {
+    ScratchInventory file("invalid_orders");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    int max = std::numeric_limits<int>::max();
+    std::vector<OrderLine> overflowing{{1, max}, {1, max}};
+    std::vector<OrderLine> negative{{1, 5}, {1, -3}};
+    std::vector<OrderLine> missingItem{{1, 1}, {9, 1}};
+    CHECK(system.placeOrder(overflowing) == 0);
+    CHECK(system.placeOrder(negative) == 0);
+    CHECK(system.placeOrder(missingItem) == 0);
+    CHECK(system.placeOrder(std::vector<OrderLine>{}) == 0);
+    CHECK(system.getReservedQuantity(1) == 0);
+
+    // Rejected orders do not use up an ID
+    std::vector<OrderLine> duplicates{{1, 2}, {2, 1}, {1, 3}};
+    int orderId = system.placeOrder(duplicates);
+    CHECK(orderId == 1);
+    auto order = system.findOrder(orderId);
+    REQUIRE(order && order->getLines().size() == 2);
+    CHECK(order->findLine(1)->getQuantity() == 5);
+
+    // Lines for different items may each be as large as an int allows
+    std::vector<OrderLine> large{{1, max}, {2, max}};
+    int backordered = system.placeOrder(large);
+    REQUIRE(backordered != 0);
+    CHECK(system.findOrder(backordered)->getTotalQuantity() == 2LL * max);
+}
+
+TEST(amendTakesOrReturnsTheDifference) {
+    ScratchInventory file("amend");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    std::vector<OrderLine> lines{{1, 3}, {2, 2}};
+    int orderId = system.placeOrder(lines);
+    CHECK(!system.amendOrder(orderId, 4));  // Several lines need the item
+    CHECK(system.amendOrder(orderId, 2, 4));
+    CHECK(system.getReservedQuantity(2) == 4);
+    CHECK(!system.amendOrder(orderId, 2, 5));
+    CHECK(!system.amendOrder(orderId, 9, 1));
+
+    CHECK(system.setOrderStatus(orderId, OrderStatus::Reserved));
+    CHECK(system.amendOrder(orderId, 1, 1));
+    CHECK(system.findItem(1)->getQuantity() == 9);
+    CHECK(system.findOrder(orderId)->findLine(1)->getQuantity() == 1);
+}
+
+TEST(receivingStockWakesBackorders) {
+    ScratchInventory file("wake_backorders");
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 0, 2.50, 2));
+        int orderId = system.placeOrder(1, 5);
+        CHECK(system.findOrder(orderId)->getStatus() == OrderStatus::Backordered);
+        auto result = system.receiveStock(1, 8);
+        CHECK(result.received);
+        CHECK(result.ordersReserved == 1);
+        CHECK(system.findOrder(orderId)->getStatus() == OrderStatus::Reserved);
+        CHECK(system.findItem(1)->getQuantity() == 3);
+    }
+    // The reservation was saved once for the whole receipt
+    WarehouseSystem reloaded(file.getPath());
+    REQUIRE(reloaded.findItem(1));
+    CHECK(reloaded.findItem(1)->getQuantity() == 3);
+    CHECK(reloaded.findOrder(1)->getStatus() == OrderStatus::Reserved);
+}
+
+TEST(removingAnItemCancelsItsUnpickedOrders) {
+    ScratchInventory file("remove_item_orders");
+    WarehouseSystem system(file.getPath());
+    stockedSystem(system);
+
+    int pending = system.placeOrder(1, 2);
+    std::vector<OrderLine> lines{{1, 3}, {2, 1}};
+    int reserved = system.placeOrder(lines);
+    int picked = system.placeOrder(1, 1);
+    int backordered = system.placeOrder(1, 50);
+    CHECK(system.setOrderStatus(reserved, OrderStatus::Reserved));
+    CHECK(system.setOrderStatus(picked, OrderStatus::Reserved));
+    CHECK(system.setOrderStatus(picked, OrderStatus::Picked));
+    REQUIRE(system.getReservedQuantity(1) == 2);
+
+    CHECK(system.removeItem(1));
+    CHECK(system.findOrder(pending)->getStatus() == OrderStatus::Cancelled);
+    CHECK(system.findOrder(reserved)->getStatus() == OrderStatus::Cancelled);
+    CHECK(system.findOrder(backordered)->getStatus() == OrderStatus::Cancelled);
+    CHECK(system.findOrder(picked)->getStatus() == OrderStatus::Picked);
+    CHECK(system.getReservedQuantity(1) == 0);
+    CHECK(system.getOrderPicks(reserved).empty());
+    CHECK(system.getPendingOrderCount() == 0);
+    // The other line of the multi-line order got its stock back
+    CHECK(system.findItem(2)->getQuantity() == 4);
+    CHECK(system.getOpenOrdersForItem(1).size() == 1);
+    CHECK(system.setOrderStatus(picked, OrderStatus::Shipped));
+    CHECK(system.getOpenOrdersForItem(1).empty());
+}
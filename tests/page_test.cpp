@@ -0,0 +1,103 @@
+#include "test.h"
+
+// Paginated listings: cursors resume after their last item, also from a token
+
+static std::vector<int> idsOf(const std::vector<InventoryItem>& items) {
+    std::vector<int> ids;
+    for (const auto& item : items) {
+        ids.push_back(item.getId());
+    }
+    return ids;
+}
+
+static void addPageItems(WarehouseSystem& system) {
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Soap", "Bath", 7, 1.25, 0));
+    system.addItem(InventoryItem(2, "Rice", "Pantry", 3, 2.50, 0));
+    system.addItem(InventoryItem(3, "Beans", "Pantry", 3, 1.10, 0));
+    system.addItem(InventoryItem(4, "Towel", "Bath", 1, 6.00, 0));
+    system.addItem(InventoryItem(5, "Flour", "Pantry", 9, 1.80, 0));
+}
+
+TEST(pagesFollowEachSortKey) {
+    ScratchInventory file("page_keys");
+    WarehouseSystem system(file.getPath());
+    addPageItems(system);
+
+    PageCursor byName(SortKey::Name);
+    CHECK(idsOf(system.fetchPage(byName, 2)) == std::vector<int>({3, 5}));
+    CHECK(idsOf(system.fetchPage(byName, 2)) == std::vector<int>({2, 1}));
+    CHECK(!byName.isFinished());
+    CHECK(idsOf(system.fetchPage(byName, 2)) == std::vector<int>({4}));
+    CHECK(byName.isFinished());
+    CHECK(system.fetchPage(byName, 2).empty());
+
+    // Equal quantities fall back to the ID
+    PageCursor byQuantity(SortKey::Quantity);
+    CHECK(idsOf(system.fetchPage(byQuantity, 3)) == std::vector<int>({4, 2, 3}));
+    CHECK(idsOf(system.fetchPage(byQuantity, 3)) == std::vector<int>({1, 5}));
+
+    PageCursor pantry(SortKey::Id, "Pantry");
+    CHECK(idsOf(system.fetchPage(pantry, 5)) == std::vector<int>({2, 3, 5}));
+    CHECK(pantry.isFinished());
+}
+
+TEST(pageTokensRoundTrip) {
+    ScratchInventory file("page_tokens");
+    WarehouseSystem system(file.getPath());
+    addPageItems(system);
+
+    // A category and a name with the token's separator in them
+    system.addItem(InventoryItem(6, "Salt:Fine", "Pantry:Dry", 2, 0.90, 0));
+    system.addItem(InventoryItem(7, "Salt:Coarse", "Pantry:Dry", 2, 0.90, 0));
+    PageCursor cursor(SortKey::Name, "Pantry:Dry");
+    CHECK(idsOf(system.fetchPage(cursor, 1)) == std::vector<int>({7}));
+
+    PageCursor resumed;
+    REQUIRE(PageCursor::fromToken(cursor.toToken(), resumed));
+    CHECK(resumed.getKey() == SortKey::Name);
+    CHECK(resumed.getCategory() == "Pantry:Dry");
+    CHECK(resumed.isStarted());
+    CHECK(!resumed.isFinished());
+    CHECK(resumed.getLastId() == 7);
+    CHECK(resumed.toToken() == cursor.toToken());
+    CHECK(idsOf(system.fetchPage(resumed, 1)) == std::vector<int>({6}));
+
+    // A fresh cursor and a finished one keep their state
+    PageCursor fresh(SortKey::Quantity);
+    REQUIRE(PageCursor::fromToken(fresh.toToken(), resumed));
+    CHECK(!resumed.isStarted());
+    CHECK(idsOf(system.fetchPage(resumed, 1)) == std::vector<int>({4}));
+    system.fetchPage(cursor, 5);
+    REQUIRE(PageCursor::fromToken(cursor.toToken(), resumed));
+    CHECK(resumed.isFinished());
+    CHECK(system.fetchPage(resumed, 5).empty());
+}
+
+TEST(pagesResumeAcrossChanges) {
+    ScratchInventory file("page_changes");
+    WarehouseSystem system(file.getPath());
+    addPageItems(system);
+
+    PageCursor cursor(SortKey::Id);
+    CHECK(idsOf(system.fetchPage(cursor, 2)) == std::vector<int>({1, 2}));
+    std::string token = cursor.toToken();
+    CHECK(system.removeItem(2));
+    CHECK(system.removeItem(3));
+    system.addItem(InventoryItem(8, "Cloth", "Bath", 4, 2.00, 0));
+
+    PageCursor resumed;
+    REQUIRE(PageCursor::fromToken(token, resumed));
+    CHECK(idsOf(system.fetchPage(resumed, 5)) == std::vector<int>({4, 5, 8}));
+}
+
+TEST(malformedPageTokensAreRejected) {
+    PageCursor cursor(SortKey::Name, "Bath");
+    for (const char* token : {"", "0:0:1:2", "9:0:1:2:0:", "-1:0:1:2:0:", "0:x:1:2:0:",
+                              "0:0:one:2:0:", "0:0:1:2:8:Bath"}) {
+        CHECK(!PageCursor::fromToken(token, cursor));
+    }
+    // A rejected token leaves the cursor alone
+    CHECK(cursor.getKey() == SortKey::Name);
+    CHECK(cursor.getCategory() == "Bath");
+}
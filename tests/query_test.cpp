@@ -0,0 +1,213 @@
+#include "test.h"
+
+#include "query.h"
+
+#include <algorithm>
+#include <random>
+
+// Ad-hoc queries: the planner's choice of index, and index results against
+// a plain scan of every item
+
+static std::vector<int> idsOf(const std::vector<InventoryItem>& items) {
+    std::vector<int> ids;
+    for (const auto& item : items) {
+        ids.push_back(item.getId());
+    }
+    return ids;
+}
+
+static ItemQuery parsed(const std::string& text) {
+    ItemQuery query;
+    std::string error = ItemQuery::parse(text, query);
+    CHECK(error.empty());
+    return query;
+}
+
+// IDs of the items query matches, found by checking every item
+static std::vector<int> scanIds(const WarehouseSystem& system, const ItemQuery& query) {
+    std::vector<int> ids;
+    for (const auto& item : system.getAllItems()) {
+        const std::string& category = item.getCategory();
+        bool inCategory = query.category.empty() || category == query.category ||
+                          category.starts_with(query.category + "/");
+        if (inCategory && query.matchesName(item.getName()) &&
+            item.getQuantity() >= query.minQuantity && item.getQuantity() <= query.maxQuantity &&
+            item.getPrice() >= query.minPrice && item.getPrice() <= query.maxPrice &&
+            (!query.lowStockOnly || item.isLowStock())) {
+            ids.push_back(item.getId());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static const char* const kCategories[] = {"Tools", "Tools/Hand", "Tools/Power", "Garden", "Bath", ""};
+static const char* const kNames[] = {"Saw", "Sander", "Soap", "Spade", "Hammer", "Hose", "Towel", "Rake"};
+
+static InventoryItem randomItem(std::mt19937& random, int id) {
+    std::string name = std::string(kNames[random() % std::size(kNames)]) + " " + std::to_string(random() % 100);
+    return InventoryItem(id, name, kCategories[random() % std::size(kCategories)],
+                         static_cast<int>(random() % 60), static_cast<double>(random() % 10000) / 100.0,
+                         static_cast<int>(random() % 10));
+}
+
+static std::string randomQuery(std::mt19937& random) {
+    std::string text;
+    if (random() % 2) {
+        text += std::string(" category=") + kCategories[random() % (std::size(kCategories) - 1)];
+    }
+    if (random() % 3 == 0) {
+        std::string name = kNames[random() % std::size(kNames)];
+        text += " name=" + name.substr(0, 1 + random() % 3);
+    }
+    if (random() % 3 == 0) text += " quantity<" + std::to_string(random() % 60);
+    if (random() % 3 == 0) text += " quantity>=" + std::to_string(random() % 60);
+    if (random() % 3 == 0) {
+        text += " price=" + std::to_string(random() % 50) + ".." + std::to_string(50 + random() % 50);
+    }
+    if (random() % 4 == 0) text += " lowstock";
+    return text;
+}
+
+TEST(plannerPicksTheNarrowestIndex) {
+    ScratchInventory file("query_plan");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    for (int id = 1; id <= 200; id++) {
+        system.addItem(InventoryItem(id, "Part " + std::to_string(id), id <= 10 ? "Tools/Hand" : "Bulk",
+                                     id, 1.00, 0));
+    }
+    system.addItem(InventoryItem(201, "Hammer", "Bulk", 5, 9.00, 0));
+
+    auto result = system.queryItems(parsed(""));
+    CHECK(result.plan.access == QueryAccess::Scan);
+    CHECK(result.matched == 201);
+
+    result = system.queryItems(parsed("category=Tools"));
+    CHECK(result.plan.access == QueryAccess::Category);
+    CHECK(result.plan.candidates == 10);
+    CHECK(result.matched == 10);
+
+    result = system.queryItems(parsed("category=Bulk name=hAm"));
+    CHECK(result.plan.access == QueryAccess::NamePrefix);
+    CHECK(idsOf(result.items) == std::vector<int>({201}));
+
+    // Filters the index does not cover still apply to its candidates
+    result = system.queryItems(parsed("category=Tools name=part"));
+    CHECK(result.plan.access == QueryAccess::Category);
+    CHECK(result.matched == 10);
+    result = system.queryItems(parsed("category=Tools/Hand lowstock"));
+    CHECK(result.matched == 0);
+}
+
+TEST(queriesSortAndLimit) {
+    ScratchInventory file("query_sort");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Saw", "Tools", 4, 12.00, 0));
+    system.addItem(InventoryItem(2, "Rake", "Garden", 9, 8.50, 0));
+    system.addItem(InventoryItem(3, "Hammer", "Tools/Hand", 4, 15.00, 0));
+    system.addItem(InventoryItem(4, "Hose", "Garden", 1, 20.00, 0));
+
+    CHECK(idsOf(system.queryItems(parsed("sort=name")).items) == std::vector<int>({3, 4, 2, 1}));
+    CHECK(idsOf(system.queryItems(parsed("sort=-price limit=2")).items) == std::vector<int>({4, 3}));
+    // Equal quantities keep ID order either way
+    CHECK(idsOf(system.queryItems(parsed("sort=-quantity")).items) == std::vector<int>({2, 1, 3, 4}));
+
+    auto result = system.queryItems(parsed("category=Tools sort=quantity limit=1"));
+    CHECK(result.matched == 2);
+    CHECK(idsOf(result.items) == std::vector<int>({1}));
+}
+
+TEST(queryParseRejectsBadTerms) {
+    ItemQuery query;
+    for (const char* text : {"category", "=Tools", "name<so", "price=", "quantity>x", "limit=-1",
+                             "sort=weight", "colour=red"}) {
+        CHECK(!ItemQuery::parse(text, query).empty());
+    }
+    CHECK(ItemQuery::parse("  quantity<5   price=1.5..2 sort=-price ", query).empty());
+    CHECK(query.maxQuantity == 4);
+    CHECK(query.minPrice == 1.5);
+    CHECK(query.maxPrice == 2.0);
+    CHECK(query.descending);
+}
+
+TEST(indexedQueriesMatchAScan) {
+    ScratchInventory file("query_scan");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    std::mt19937 random(11);
+    for (int id = 1; id <= 600; id++) {
+        system.addItem(randomItem(random, id));
+    }
+
+    for (int round = 0; round < 500; round++) {
+        ItemQuery query = parsed(randomQuery(random));
+        auto result = system.queryItems(query);
+        std::vector<int> expected = scanIds(system, query);
+        CHECK(idsOf(result.items) == expected);
+        CHECK(result.matched == expected.size());
+    }
+}
+
+TEST(plannerUsesRangeIndexesForNarrowRanges) {
+    ScratchInventory file("query_ranges");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    for (int id = 1; id <= 200; id++) {
+        system.addItem(InventoryItem(id, "Part " + std::to_string(id), "Bulk", id, id * 0.5, 0));
+    }
+
+    auto result = system.queryItems(parsed("quantity=20..24"));
+    CHECK(result.plan.access == QueryAccess::QuantityRange);
+    CHECK(result.plan.candidates == 5);
+    CHECK(idsOf(result.items) == std::vector<int>({20, 21, 22, 23, 24}));
+
+    result = system.queryItems(parsed("quantity>150 price<=10"));
+    CHECK(result.plan.access == QueryAccess::PriceRange);
+    CHECK(result.plan.candidates == 20);
+    CHECK(result.matched == 0);
+
+    // Wide ranges are left to a scan
+    result = system.queryItems(parsed("quantity>=1 price>0"));
+    CHECK(result.plan.access == QueryAccess::Scan);
+    CHECK(result.matched == 200);
+}
+
+TEST(rangeIndexesFollowStockChanges) {
+    ScratchInventory file("query_range_changes");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    std::mt19937 random(5);
+    for (int id = 1; id <= 300; id++) {
+        system.addItem(randomItem(random, id));
+    }
+
+    for (int step = 0; step < 400; step++) {
+        int id = 1 + static_cast<int>(random() % 320);
+        switch (random() % 4) {
+            case 0:
+                system.receiveStock(id, 1 + static_cast<int>(random() % 20));
+                break;
+            case 1:
+                if (int orderId = system.placeOrder(id, 1 + static_cast<int>(random() % 5))) {
+                    system.setOrderStatus(orderId, OrderStatus::Reserved);
+                }
+                break;
+            case 2:
+                if (system.findItem(id)) {
+                    system.updateItem(randomItem(random, id));
+                } else {
+                    system.addItem(randomItem(random, id));
+                }
+                break;
+            case 3:
+                system.removeItem(id);
+                break;
+        }
+
+        ItemQuery query = parsed(randomQuery(random));
+        auto result = system.queryItems(query);
+        CHECK(idsOf(result.items) == scanIds(system, query));
+    }
+}
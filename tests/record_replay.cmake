@@ -0,0 +1,38 @@
+# Round trip of `warehouse_cli --record` through warehouse_replay: every
+# command in COMMANDS is run in batch mode and recorded, then the trace is
+# replayed. Run by ctest with CLI, REPLAY, COMMANDS and WORK_DIR set.
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(header "ID,Name,Category,Quantity,Price,MinStockLevel\n")
+file(WRITE ${WORK_DIR}/inventory.csv ${header})
+file(WRITE ${WORK_DIR}/start.csv ${header})
+
+execute_process(
+    COMMAND ${CLI} --record trace.txt --batch ${COMMANDS}
+    WORKING_DIRECTORY ${WORK_DIR}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "warehouse_cli failed (${result}):\n${output}")
+endif()
+
+file(STRINGS ${COMMANDS} commands REGEX "^[^#]")
+file(STRINGS ${WORK_DIR}/trace.txt recorded)
+list(LENGTH commands expected)
+list(LENGTH recorded actual)
+if(NOT expected EQUAL actual)
+    message(FATAL_ERROR "Recorded ${actual} of ${expected} commands:\n${recorded}")
+endif()
+
+execute_process(
+    COMMAND ${REPLAY} trace.txt --inventory start.csv --repeat 2
+    WORKING_DIRECTORY ${WORK_DIR}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "warehouse_replay could not replay the recorded trace (${result}):\n${output}")
+endif()
+message(STATUS ${output})
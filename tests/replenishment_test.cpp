@@ -0,0 +1,95 @@
+#include "test.h"
+
+// Restock requests, drafts and the inbound queue
+
+TEST(receiptsCloseIssuedLinesOldestFirst) {
+    ReplenishmentQueue queue(2);
+    CHECK(queue.request(1, "Pantry", 10, 0));
+    CHECK(queue.request(2, "Pantry", 4, 0));
+    queue.settle(1);
+    CHECK(queue.request(1, "Pantry", 6, 0));
+    CHECK(queue.request(3, "Pantry", 5, 0));
+    REQUIRE(queue.getInbound().size() == 2);
+
+    // Item 1 is on both orders, so its request stays until both arrive
+    CHECK(queue.receive(1, 12) == 12);
+    REQUIRE(queue.getInbound().size() == 2);
+    CHECK(queue.getInbound().front().lines.size() == 1);
+    CHECK(queue.getInbound().back().lines.front().quantity == 4);
+    CHECK(queue.hasRequest(1));
+
+    CHECK(queue.receive(1, 9) == 4);
+    CHECK(!queue.hasRequest(1));
+    CHECK(queue.receive(2, 4) == 4);
+    REQUIRE(queue.getInbound().size() == 1);
+    CHECK(queue.getInbound().front().restockId == 2);
+    CHECK(queue.receive(7, 1) == 0);
+}
+
+TEST(shipmentsDropFullyReceivedRestockOrders) {
+    ScratchInventory file("restock_receipts");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 5, 2.50, 2));
+    system.addItem(InventoryItem(2, "Soap", "Bath", 5, 1.25, 4));
+    InventoryItem rice = *system.findItem(1);
+    rice.setQuantity(1);
+    CHECK(system.updateItem(rice));
+    InventoryItem soap = *system.findItem(2);
+    soap.setQuantity(0);
+    CHECK(system.updateItem(soap));
+    CHECK(system.issueRestockOrders() == 2);
+
+    std::vector<RestockLine> shipment{{1, 3}, {2, 3}};
+    CHECK(system.receiveShipment(shipment).received);
+    const auto& inbound = system.getReplenishment().getInbound();
+    REQUIRE(inbound.size() == 1);
+    CHECK(inbound.front().category == "Bath");
+    CHECK(inbound.front().lines.front().quantity == 5);
+    CHECK(!system.getReplenishment().hasRequest(1));
+
+    // The rest of the soap arrives but leaves it low, so it asks again
+    soap = *system.findItem(2);
+    soap.setMinStockLevel(20);
+    CHECK(system.updateItem(soap));
+    CHECK(system.receiveStock(2, 5).received);
+    CHECK(inbound.empty());
+    CHECK(system.getReplenishment().isDrafted(2));
+}
+
+TEST(recategorizedItemsMoveTheirDraftedRequest) {
+    ScratchInventory file("restock_category");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Rice", "Pantry", 5, 2.50, 2));
+    InventoryItem rice = *system.findItem(1);
+    rice.setQuantity(1);
+    CHECK(system.updateItem(rice));
+    rice.setCategory("Grains");
+    CHECK(system.updateItem(rice));
+
+    auto drafts = system.getReplenishment().getDrafts();
+    REQUIRE(drafts.size() == 1);
+    CHECK(drafts.front().category == "Grains");
+    CHECK(drafts.front().lines.front().itemId == 1);
+}
+
+TEST(bulkUpsertMovesDraftedRequestsToTheNewCategory) {
+    ScratchInventory file("restock_bulk_category");
+    WarehouseSystem system(file.getPath());
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(2, "Soap", "Bath", 5, 1.25, 4));
+    InventoryItem soap = *system.findItem(2);
+    soap.setQuantity(0);
+    CHECK(system.updateItem(soap));
+    REQUIRE(system.getReplenishment().isDrafted(2));
+
+    std::vector<InventoryItem> items{InventoryItem(2, "Soap", "Cleaning", 0, 1.25, 4)};
+    auto result = system.bulkUpsert(items);
+    CHECK(result.updated == 1);
+
+    auto drafts = system.getReplenishment().getDrafts();
+    REQUIRE(drafts.size() == 1);
+    CHECK(drafts.front().category == "Cleaning");
+    CHECK(drafts.front().lines.front().itemId == 2);
+}
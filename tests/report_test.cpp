@@ -0,0 +1,70 @@
+#include "test.h"
+
+#include "report.h"
+
+#include <sstream>
+
+// Compile-time report types: layouts, filters and orders
+
+using report::Column;
+
+using IdColumn = Column<"ID", &InventoryItem::getId, 4>;
+using NameColumn = Column<"Name", &InventoryItem::getName, 6>;
+
+static std::map<int, InventoryItem> reportItems() {
+    std::map<int, InventoryItem> items;
+    for (const auto& item : {InventoryItem(3, "Saw", "Tools", 4, 12.00, 5),
+                             InventoryItem(1, "Rake", "Garden", 9, 8.50, 2),
+                             InventoryItem(2, "Hammer", "Tools", 4, 15.25, 4)}) {
+        items.emplace(item.getId(), item);
+    }
+    return items;
+}
+
+TEST(tableReportAlignsColumns) {
+    using Report = report::Report<report::Table<IdColumn, NameColumn,
+                                                Column<"Price", &InventoryItem::getPrice, 7>>>;
+    std::ostringstream out;
+    CHECK(Report::write(out, reportItems(), "Items:\n") == 3);
+    std::string expected = "Items:\n"
+                           "  ID |   Name |   Price\n" +
+                           std::string(80, '-') + "\n"
+                           "   1 |   Rake |    8.50\n"
+                           "   2 | Hammer |   15.25\n"
+                           "   3 |    Saw |   12.00\n";
+    CHECK(out.str() == expected);
+}
+
+TEST(fieldReportsFilterAndSort) {
+    using LowStockByQuantity = report::Report<
+        report::Fields<Column<"ID", &InventoryItem::getId>, Column<"Stock", &InventoryItem::getQuantity>>,
+        report::LowStock, report::ByQuantity>;
+    std::ostringstream out;
+    CHECK(LowStockByQuantity::write(out, reportItems(), "Low:\n") == 2);
+    // Equal quantities are listed by ID
+    CHECK(out.str() == "Low:\nID: 2, Stock: 4\nID: 3, Stock: 4\n");
+
+    using ToolsByName = report::Report<report::Fields<Column<"Name", &InventoryItem::getName>>,
+                                       report::InCategory, report::ByName>;
+    out.str("");
+    CHECK(ToolsByName::write(out, reportItems(), "", report::InCategory{"Tools"}) == 2);
+    CHECK(out.str() == "Name: Hammer\nName: Saw\n");
+
+    // No heading when nothing passes the filter
+    out.str("");
+    CHECK(ToolsByName::write(out, reportItems(), "Bath:\n", report::InCategory{"Bath"}) == 0);
+    CHECK(out.str().empty());
+}
+
+TEST(largeReportsAreWrittenWhole) {
+    std::map<int, InventoryItem> items;
+    for (int id = 1; id <= 5000; id++) {
+        items.emplace(id, InventoryItem(id, "Item " + std::to_string(id), "Bulk", id, 1.00, 0));
+    }
+    using Report = report::Report<report::Fields<Column<"Name", &InventoryItem::getName>>>;
+    std::ostringstream out;
+    CHECK(Report::write(out, items, "") == 5000);
+    std::string text = out.str();
+    CHECK(std::count(text.begin(), text.end(), '\n') == 5000);
+    CHECK(text.ends_with("Name: Item 5000\n"));
+}
@@ -0,0 +1,84 @@
+#include "test.h"
+
+// Name search: exact names, then prefixes, then substrings, and
+// misspellings only when nothing else matches
+
+static std::vector<int> idsOf(const std::vector<NameSearchResult>& results) {
+    std::vector<int> ids;
+    for (const auto& result : results) {
+        ids.push_back(result.itemId);
+    }
+    return ids;
+}
+
+static void addSearchItems(WarehouseSystem& system) {
+    system.setAutoSave(false);
+    system.addItem(InventoryItem(1, "Hand Soap", "Bath", 5, 1.25, 0));
+    system.addItem(InventoryItem(2, "Soap", "Bath", 5, 1.00, 0));
+    system.addItem(InventoryItem(3, "Soap Dish", "Bath", 5, 4.00, 0));
+    system.addItem(InventoryItem(4, "Rice", "Pantry", 5, 2.50, 0));
+    system.addItem(InventoryItem(5, "SOAPSTONE", "Garden", 5, 9.00, 0));
+}
+
+TEST(searchRanksExactThenPrefixThenSubstring) {
+    ScratchInventory file("search_tiers");
+    WarehouseSystem system(file.getPath());
+    addSearchItems(system);
+
+    auto results = system.searchItems("soap");
+    CHECK(idsOf(results) == std::vector<int>({2, 3, 5, 1}));
+    REQUIRE(results.size() == 4);
+    CHECK(results[0].match == NameMatch::Exact);
+    CHECK(results[1].match == NameMatch::Prefix);
+    CHECK(results[2].match == NameMatch::Prefix);
+    CHECK(results[3].match == NameMatch::Substring);
+
+    // The limit cuts the lower tiers first
+    CHECK(idsOf(system.searchItems("SOAP", 2)) == std::vector<int>({2, 3}));
+
+    // Short queries only match from the start of a name
+    CHECK(idsOf(system.searchItems("ri")) == std::vector<int>({4}));
+    CHECK(system.searchItems("ap").empty());
+}
+
+TEST(searchFallsBackToMisspellings) {
+    ScratchInventory file("search_fuzzy");
+    WarehouseSystem system(file.getPath());
+    addSearchItems(system);
+
+    // One letter changed, added or swapped
+    for (const char* query : {"Riche", "Rica", "Rcie"}) {
+        auto results = system.searchItems(query);
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].itemId == 4);
+        CHECK(results[0].match == NameMatch::Fuzzy);
+    }
+    CHECK(system.searchItems("Rxyz").empty());
+
+    // Long queries allow two edits
+    system.addItem(InventoryItem(6, "Soap Dish Large", "Bath", 5, 6.00, 0));
+    auto results = system.searchItems("Sop Dish Lrage");
+    REQUIRE(results.size() == 1);
+    CHECK(results[0].itemId == 6);
+    CHECK(results[0].match == NameMatch::Fuzzy);
+
+    // Any real match hides the misspellings
+    results = system.searchItems("Soap Dish");
+    CHECK(idsOf(results) == std::vector<int>({3, 6}));
+}
+
+TEST(searchFollowsRenamesAndRemovals) {
+    ScratchInventory file("search_updates");
+    WarehouseSystem system(file.getPath());
+    addSearchItems(system);
+
+    InventoryItem rice = *system.findItem(4);
+    rice.setName("Brown Rice");
+    CHECK(system.updateItem(rice));
+    CHECK(system.searchItems("rice").size() == 1);
+    CHECK(system.searchItems("rice")[0].match == NameMatch::Substring);
+    CHECK(system.searchItems("ri").empty());
+
+    CHECK(system.removeItem(2));
+    CHECK(idsOf(system.searchItems("soap")) == std::vector<int>({3, 5, 1}));
+}
@@ -0,0 +1,198 @@
+#include "test.h"
+
+#include "server.h"
+
+#ifdef __linux__
+
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// The network server, driven over a loopback connection. The server stops
+// on a signal that cannot be undone, so everything runs against one server.
+
+// A port nothing listens on right now
+static int freePort() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    int port = 0;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        port = ntohs(address.sin_port);
+    }
+    ::close(fd);
+    return port;
+}
+
+// Connect to the server, retrying while it starts up
+static int connectToServer(int port) {
+    for (int attempt = 0; attempt < 100; attempt++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(port));
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return -1;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    for (std::size_t sent = 0; sent < data.size();) {
+        ssize_t count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+        sent += static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+static bool receiveAll(int fd, char* data, std::size_t size) {
+    for (std::size_t received = 0; received < size;) {
+        ssize_t count = ::recv(fd, data + received, size - received, 0);
+        if (count <= 0) return false;
+        received += static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+struct Reply {
+    std::uint32_t requestId = 0;
+    ReplyStatus status = ReplyStatus::BadRequest;
+    std::string payload;
+};
+
+static bool receiveReply(int fd, Reply& reply) {
+    char header[4];
+    if (!receiveAll(fd, header, sizeof(header))) return false;
+    std::uint32_t length = ProtocolReader(header, sizeof(header)).getU32();
+    std::string body(length, '\0');
+    if (length < kFrameHeaderSize - 4 || !receiveAll(fd, body.data(), length)) return false;
+    ProtocolReader reader(body.data(), body.size());
+    reply.requestId = reader.getU32();
+    reply.status = static_cast<ReplyStatus>(reader.getU8());
+    reply.payload = body.substr(kFrameHeaderSize - 4);
+    return true;
+}
+
+TEST(serverAnswersPipelinedRequestsInOrder) {
+    ScratchInventory file("server");
+    int port = freePort();
+    REQUIRE(port != 0);
+    {
+        WarehouseSystem system(file.getPath());
+        system.addItem(InventoryItem(1, "Rice", "Pantry", 10, 2.50, 2));
+        system.addItem(InventoryItem(2, "Soap", "Bath", 4, 1.25, 1));
+        std::thread server([&system, port]() { runServer(system, port, 2); });
+
+        int fd = connectToServer(port);
+        if (fd < 0) {
+            std::raise(SIGTERM);
+            server.join();
+        }
+        REQUIRE(fd >= 0);
+
+        // Every request goes out before any reply is read
+        std::string requests;
+        ProtocolWriter writer(requests);
+        std::size_t frame = writer.beginFrame(1, static_cast<std::uint8_t>(Opcode::Find));
+        writer.putI32(1);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(2, static_cast<std::uint8_t>(Opcode::Find));
+        writer.putI32(99);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(3, static_cast<std::uint8_t>(Opcode::Add));
+        writer.putItem(InventoryItem(0, "Towel", "Bath", 3, 6.00, 1), false);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(4, static_cast<std::uint8_t>(Opcode::CreateOrder));
+        writer.putI32(1);
+        writer.putI32(4);
+        writer.putI32(2);
+        writer.putI32(1);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(5, static_cast<std::uint8_t>(Opcode::ProcessOrders));
+        writer.putU32(10);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(6, static_cast<std::uint8_t>(Opcode::GetOrder));
+        writer.putI32(1);
+        writer.endFrame(frame);
+        frame = writer.beginFrame(7, static_cast<std::uint8_t>(Opcode::StockTotals));
+        writer.putString("Bath");
+        writer.endFrame(frame);
+        frame = writer.beginFrame(8, static_cast<std::uint8_t>(Opcode::Find));
+        writer.putU8(0);  // Too short for an ID
+        writer.endFrame(frame);
+        frame = writer.beginFrame(9, 200);
+        writer.endFrame(frame);
+        bool sent = sendAll(fd, requests);
+
+        std::vector<Reply> replies(9);
+        bool received = sent;
+        for (auto& reply : replies) {
+            received = received && receiveReply(fd, reply);
+        }
+        ::close(fd);
+        std::raise(SIGTERM);
+        server.join();
+        REQUIRE(received);
+
+        for (std::size_t i = 0; i < replies.size(); i++) {
+            CHECK(replies[i].requestId == i + 1);
+        }
+        CHECK(replies[0].status == ReplyStatus::Ok);
+        ProtocolReader found(replies[0].payload.data(), replies[0].payload.size());
+        CHECK(found.getI32() == 1);
+        CHECK(found.getItem(1).getName() == "Rice");
+        CHECK(replies[1].status == ReplyStatus::NotFound);
+
+        ProtocolReader added(replies[2].payload.data(), replies[2].payload.size());
+        CHECK(replies[2].status == ReplyStatus::Ok);
+        CHECK(added.getI32() == 3);
+
+        ProtocolReader created(replies[3].payload.data(), replies[3].payload.size());
+        CHECK(replies[3].status == ReplyStatus::Ok);
+        CHECK(created.getI32() == 1);
+
+        ProtocolReader processed(replies[4].payload.data(), replies[4].payload.size());
+        CHECK(processed.getU32() == 1);
+        CHECK(processed.getU32() == 0);
+        CHECK(processed.getU32() == 0);
+
+        // The first line leads the reply, the others follow the status
+        ProtocolReader order(replies[5].payload.data(), replies[5].payload.size());
+        CHECK(order.getI32() == 1);
+        CHECK(order.getI32() == 4);
+        CHECK(order.getU8() == static_cast<std::uint8_t>(OrderStatus::Reserved));
+        CHECK(order.getI32() == 2);
+        CHECK(order.getI32() == 1);
+        CHECK(order.atEnd());
+
+        ProtocolReader totals(replies[6].payload.data(), replies[6].payload.size());
+        CHECK(totals.getU64() == 2);
+        CHECK(totals.getU64() == 6);
+
+        CHECK(replies[7].status == ReplyStatus::BadRequest);
+        CHECK(replies[8].status == ReplyStatus::BadRequest);
+    }
+
+    // The server saved the inventory and the order as it stopped
+    WarehouseSystem reloaded(file.getPath());
+    REQUIRE(reloaded.findItem(3));
+    CHECK(reloaded.findItem(3)->getName() == "Towel");
+    CHECK(reloaded.findItem(1)->getQuantity() == 6);
+    REQUIRE(reloaded.findOrder(1));
+    CHECK(reloaded.findOrder(1)->getStatus() == OrderStatus::Reserved);
+}
+
+#endif  // __linux__
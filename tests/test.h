@@ -0,0 +1,74 @@
+#pragma once
+
+#include "warehouse.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Minimal test harness for warehouse_tests
+//
+// TEST(name) defines and registers a test case. CHECK(condition) records a
+// failure and carries on, so one run reports every broken expectation;
+// REQUIRE(condition) also ends the test case, for checks later ones depend
+// on. Run `warehouse_tests [filter]` to run the cases whose name contains
+// filter.
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& testRegistry();
+
+// Record a failed check. Returns false so REQUIRE can bail out.
+bool reportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistration {
+    TestRegistration(const char* name, void (*run)()) { testRegistry().push_back({name, run}); }
+};
+
+#define TEST(name)                                                  \
+    static void name();                                             \
+    static const TestRegistration name##Registration(#name, name);  \
+    static void name()
+
+#define CHECK(condition) \
+    static_cast<void>((condition) || reportFailure(__FILE__, __LINE__, #condition))
+
+#define REQUIRE(condition)                                   \
+    do {                                                     \
+        if (!(condition)) {                                  \
+            reportFailure(__FILE__, __LINE__, #condition);   \
+            return;                                          \
+        }                                                    \
+    } while (false)
+
+// An inventory file in the temporary directory, removed along with the
+// order log, stock log and locations file next to it when the object is
+// created and again when it goes away
+class ScratchInventory {
+private:
+    std::string path;
+
+    void remove() const {
+        for (const auto& file : {path, WarehouseSystem::orderLogPathFor(path),
+                                  WarehouseSystem::stockLogPathFor(path),
+                                  WarehouseSystem::locationsPathFor(path)}) {
+            std::remove(file.c_str());
+        }
+    }
+
+public:
+    explicit ScratchInventory(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("warehouse_tests_" + name + ".csv")).string()) {
+        remove();
+    }
+    ~ScratchInventory() { remove(); }
+
+    ScratchInventory(const ScratchInventory&) = delete;
+    ScratchInventory& operator=(const ScratchInventory&) = delete;
+
+    const std::string& getPath() const { return path; }
+};
@@ -0,0 +1,47 @@
+#include "test.h"
+
+#include <cstring>
+#include <iostream>
+
+static std::size_t failures = 0;
+
+std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+bool reportFailure(const char* file, int line, const char* expression) {
+    std::cerr << file << ":" << line << ": check failed: " << expression << "\n";
+    failures++;
+    return false;
+}
+
+// Stream buffer that drops everything written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+int main(int argc, char* argv[]) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    std::size_t run = 0, failed = 0;
+    for (const auto& test : testRegistry()) {
+        if (!std::strstr(test.name, filter)) {
+            continue;
+        }
+        // WarehouseSystem reports to std::cout; keep the test log readable
+        NullBuffer silence;
+        std::streambuf* previous = std::cout.rdbuf(&silence);
+        std::size_t before = failures;
+        test.run();
+        std::cout.rdbuf(previous);
+        run++;
+        if (failures != before) {
+            failed++;
+            std::cerr << "FAILED " << test.name << "\n";
+        }
+    }
+    std::cerr << run - failed << " of " << run << " tests passed\n";
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,2121 @@
+#include "warehouse.h"
+#include "report.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <filesystem>
+#include <limits>
+
+std::string Transaction::getFormattedTime() const {
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &timestamp);
+#else
+    localtime_r(&timestamp, &local);
+#endif
+    char buffer[32];
+    std::size_t length = std::strftime(buffer, sizeof(buffer), "%a %b %d %H:%M:%S %Y", &local);
+    return std::string(buffer, length);
+}
+
+std::string Transaction::toString() const {
+    return getFormattedTime() + " - " + transactionActionName(action) + " (Item ID: " +
+           std::to_string(itemId) + ") " + std::string(details);
+}
+
+
+std::string PageCursor::toToken() const {
+    std::string token = std::to_string(static_cast<int>(key)) + ":";
+    token += std::string(finished ? "1" : (started ? "0" : "-")) + ":";
+    token += std::to_string(lastId) + ":" + std::to_string(lastQuantity) + ":";
+    token += std::to_string(category.size()) + ":" + category + lastName;
+    return token;
+}
+
+bool PageCursor::fromToken(const std::string& token, PageCursor& cursor) {
+    std::stringstream ss(token);
+    std::string keyField, stateField, idField, quantityField, lengthField;
+    if (!std::getline(ss, keyField, ':') || !std::getline(ss, stateField, ':') ||
+        !std::getline(ss, idField, ':') || !std::getline(ss, quantityField, ':') ||
+        !std::getline(ss, lengthField, ':')) {
+        return false;
+    }
+
+    try {
+        int keyValue = std::stoi(keyField);
+        std::size_t categoryLength = std::stoul(lengthField);
+        std::string rest;
+        std::getline(ss, rest, '\0');
+        if (keyValue < 0 || keyValue > static_cast<int>(SortKey::Quantity) ||
+            categoryLength > rest.size() ||
+            (stateField != "-" && stateField != "0" && stateField != "1")) {
+            return false;
+        }
+
+        PageCursor parsed(static_cast<SortKey>(keyValue), rest.substr(0, categoryLength));
+        parsed.started = stateField != "-";
+        parsed.finished = stateField == "1";
+        parsed.lastId = std::stoi(idField);
+        parsed.lastQuantity = std::stoi(quantityField);
+        parsed.lastName = rest.substr(categoryLength);
+        cursor = parsed;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+
+// FNV-1a hash of the CSV file's text, which tells the stock log whether
+// the file was saved after the log was started
+static const std::uint64_t kCsvHashSeed = 0xcbf29ce484222325ull;
+
+static std::uint64_t hashText(std::uint64_t hash, std::string_view text) {
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void WarehouseSystem::loadFromFile() {
+    ScopedTimer timer(Operation::LoadFromFile);
+    csvHash = kCsvHashSeed;
+    std::ifstream file(filename);
+    if (!file) {
+        return;  // File doesn't exist yet
+    }
+
+    std::string line;
+    // Skip header line
+    std::getline(file, line);
+    csvHash = hashText(hashText(csvHash, line), "\n");
+    
+    while (std::getline(file, line)) {
+        csvHash = hashText(hashText(csvHash, line), "\n");
+        InventoryItem item;
+        if (!parseCsvLine(line, item)) {
+            continue;  // Skip malformed rows
+        }
+        InventoryItem& stored = inventory[item.getId()];
+        stored = item;
+        nameIndex.insert(item.getId(), item.getName());
+        columns.upsert(stored);
+        nextId = std::max(nextId, item.getId() + 1);
+    }
+}
+
+void WarehouseSystem::saveToFile() const {
+    ScopedTimer timer(Operation::SaveToFile);
+    std::ostringstream text;
+    writeCsv(text);
+    std::string csv = std::move(text).str();
+    std::ofstream file(filename);
+    file.write(csv.data(), static_cast<std::streamsize>(csv.size()));
+    file.close();
+    if (!file) {
+        return;
+    }
+    if (locations.getLocationCount() > 0) {
+        std::ofstream locationsFile(locationsPath);
+        writeLocations(locationsFile);
+    }
+    // The files now hold the received stock, so the stock log starts over
+    csvHash = hashText(kCsvHashSeed, csv);
+    if (stockLogRecords > 0) {
+        resetStockLog();
+    }
+}
+
+void WarehouseSystem::persist() const {
+    if (autoSave) {
+        saveToFile();
+    }
+}
+
+// Order log
+//
+// An 8-byte header followed by little-endian records, each a fixed part
+//     u32 orderId, u32 lineCount, u8 status, 7 zero bytes, i64 orderTime
+// followed by lineCount lines of
+//     u32 itemId, u32 quantity
+// Each record is the state of an order after a change. A record for the
+// next unused order ID creates the order. A later record without lines sets
+// the order's status and moves it to the back of that state's list, so
+// replaying the log rebuilds the queue in the same order; a later record
+// with lines is an amendment, which replaces the quantities and leaves the
+// order where it is.
+//
+// Version 1 logs held single-line orders in fixed 24-byte records with the
+// item ID and quantity where version 2 keeps the line count. They are read
+// and rewritten in the current format.
+
+static const char kOrderLogMagic[8] = {'W', 'M', 'S', 'O', 'R', 'D', '2', '\n'};
+static const char kOrderLogMagicV1[8] = {'W', 'M', 'S', 'O', 'R', 'D', '1', '\n'};
+static const std::size_t kOrderRecordSize = 24;
+static const std::size_t kOrderLineSize = 8;
+static const std::size_t kMinCompactionRecords = 1 << 16;
+static const std::size_t kMinStockCheckChanges = 1 << 16;
+
+static void putLittleEndian(char* out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<char>(value >> (i * 8));
+    }
+}
+
+static std::uint64_t getLittleEndian(const char* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i])) << (i * 8);
+    }
+    return value;
+}
+
+// Encode one record and hand its pieces to write(const char*, std::size_t)
+template <typename Write>
+static void writeOrderRecord(const Order& order, bool withLines, Write write) {
+    char record[kOrderRecordSize] = {};
+    putLittleEndian(record, static_cast<std::uint32_t>(order.getOrderId()), 4);
+    putLittleEndian(record + 4, withLines ? order.getLines().size() : 0, 4);
+    record[8] = static_cast<char>(order.getStatus());
+    putLittleEndian(record + 16, static_cast<std::uint64_t>(order.getOrderTime()), 8);
+    write(record, sizeof(record));
+    if (withLines) {
+        for (const auto& line : order.getLines()) {
+            char encoded[kOrderLineSize];
+            putLittleEndian(encoded, static_cast<std::uint32_t>(line.getItemId()), 4);
+            putLittleEndian(encoded + 4, static_cast<std::uint32_t>(line.getQuantity()), 4);
+            write(encoded, sizeof(encoded));
+        }
+    }
+}
+
+void WarehouseSystem::loadOrderLog() {
+    ScopedTimer timer(Operation::LoadOrderLog);
+    std::vector<char> data;
+    std::ifstream file(orderLogPath, std::ios::binary | std::ios::ate);
+    if (file) {
+        data.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+    }
+
+    auto hasMagic = [&data](const char (&magic)[8]) {
+        return data.size() >= sizeof(magic) && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+    };
+    bool version1 = hasMagic(kOrderLogMagicV1);
+    bool valid = data.empty() || version1 || hasMagic(kOrderLogMagic);
+    std::vector<OrderLine> lines;
+    std::size_t offset = sizeof(kOrderLogMagic);
+    while (valid && offset + kOrderRecordSize <= data.size()) {
+        const char* record = data.data() + offset;
+        int orderId = static_cast<int>(getLittleEndian(record, 4));
+        auto statusCode = static_cast<unsigned char>(record[version1 ? 12 : 8]);
+        auto orderTime = static_cast<std::time_t>(getLittleEndian(record + 16, 8));
+        std::size_t size = kOrderRecordSize;
+        lines.clear();
+        if (version1) {
+            lines.emplace_back(static_cast<int>(getLittleEndian(record + 4, 4)),
+                               static_cast<int>(getLittleEndian(record + 8, 4)));
+        } else {
+            std::size_t lineCount = getLittleEndian(record + 4, 4);
+            if (lineCount > (data.size() - offset - kOrderRecordSize) / kOrderLineSize) {
+                break;  // Torn record
+            }
+            for (std::size_t i = 0; i < lineCount; i++) {
+                const char* line = record + kOrderRecordSize + i * kOrderLineSize;
+                lines.emplace_back(static_cast<int>(getLittleEndian(line, 4)),
+                                   static_cast<int>(getLittleEndian(line + 4, 4)));
+            }
+            size += lineCount * kOrderLineSize;
+        }
+
+        valid = statusCode < kOrderStatusCount;
+        for (std::size_t i = 0; valid && i < lines.size(); i++) {
+            valid = lines[i].quantity > 0 && (i == 0 || lines[i - 1].itemId < lines[i].itemId);
+        }
+        auto status = static_cast<OrderStatus>(statusCode);
+        if (!valid) {
+            break;
+        }
+        // Later version 1 records for an order carry its quantity along with
+        // every move
+        if (Order* order = orderRecord(orderId);
+            version1 && order && order->lines.front().itemId == lines.front().itemId) {
+            order->lines.front().quantity = lines.front().quantity;
+            lines.clear();
+        }
+
+        if (static_cast<std::size_t>(orderId) == orders.size() + 1 && !lines.empty()) {
+            Order& order = orders.emplace_back(orderId);
+            order.orderTime = orderTime;
+            order.lines.assign(lines.begin(), lines.end());
+            linkOrder(ordersByState[static_cast<std::size_t>(OrderStatus::Pending)], order,
+                      StateLinks{});
+            for (const auto& line : order.lines) {
+                linkOrder(openOrdersByItem[line.itemId], order, ItemLinks{line.itemId});
+            }
+            if (status != OrderStatus::Pending) {
+                moveOrder(order, status);
+            }
+        } else if (Order* order = orderRecord(orderId);
+                   order && lines.empty() &&
+                   (isOpenOrderStatus(order->status) || !isOpenOrderStatus(status))) {
+            moveOrder(*order, status);
+        } else if (order && order->status == status && lines.size() == order->lines.size()) {
+            for (std::size_t i = 0; valid && i < lines.size(); i++) {
+                valid = lines[i].itemId == order->lines[i].itemId;
+            }
+            if (!valid) {
+                break;
+            }
+            for (std::size_t i = 0; i < lines.size(); i++) {
+                order->lines[i].quantity = lines[i].quantity;
+            }
+        } else {
+            valid = false;
+            break;
+        }
+        offset += size;
+        orderLogRecords++;
+    }
+    nextOrderId = static_cast<int>(orders.size()) + 1;
+    // Pending orders hold the stock promised to them
+    for (int id = ordersByState[static_cast<std::size_t>(OrderStatus::Pending)].head; id;
+         id = orderRecord(id)->nextInState) {
+        for (const auto& line : orderRecord(id)->lines) {
+            reservedByItem[line.itemId] += line.quantity;
+        }
+    }
+    // Orders that took their stock are the demand history
+    for (const auto& order : orders) {
+        if (order.status == OrderStatus::Reserved || order.status == OrderStatus::Picked ||
+            order.status == OrderStatus::Shipped) {
+            for (const auto& line : order.lines) {
+                if (inventory.count(line.itemId)) {
+                    forecaster.recordDemand(line.itemId, line.quantity, order.orderTime);
+                }
+            }
+        }
+    }
+
+    // A torn final record or a damaged log is replaced by a clean copy of
+    // what could be recovered, as is a log in the old format
+    if (!valid || version1 || offset != std::max(data.size(), sizeof(kOrderLogMagic)) ||
+        orderLogRecords >= std::max(kMinCompactionRecords, 4 * orders.size())) {
+        if (!valid) {
+            std::cout << "Order log " << orderLogPath << " is damaged; recovered "
+                      << orders.size() << " orders\n";
+        }
+        if (compactOrderLog()) {
+            return;
+        }
+    }
+    orderLog.open(orderLogPath, std::ios::binary | std::ios::app);
+    if (data.empty()) {
+        orderLog.write(kOrderLogMagic, sizeof(kOrderLogMagic));
+    }
+}
+
+void WarehouseSystem::logOrder(const Order& order, bool withLines) {
+    writeOrderRecord(order, withLines, [this](const char* bytes, std::size_t size) {
+        orderLog.write(bytes, static_cast<std::streamsize>(size));
+    });
+    if (autoSave) {
+        orderLog.flush();
+    }
+    if (++orderLogRecords >= std::max(kMinCompactionRecords, 4 * orders.size())) {
+        compactOrderLog();
+    }
+}
+
+bool WarehouseSystem::compactOrderLog() {
+    ScopedTimer timer(Operation::CompactOrderLog);
+    std::string tempPath = orderLogPath + ".tmp";
+    std::size_t records = 0;
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        std::vector<char> buffer(sizeof(kOrderLogMagic));
+        std::memcpy(buffer.data(), kOrderLogMagic, sizeof(kOrderLogMagic));
+        auto append = [&](const Order& order, bool withLines) {
+            writeOrderRecord(order, withLines, [&buffer](const char* bytes, std::size_t size) {
+                buffer.insert(buffer.end(), bytes, bytes + size);
+            });
+            records++;
+            if (buffer.size() >= (1 << 20)) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        };
+        // Orders in ID order recreate them. Each state list that is no
+        // longer in ID order (backorders that were retried, orders that
+        // moved on out of turn) is written again in list order.
+        for (const auto& order : orders) {
+            append(order, true);
+        }
+        for (const auto& list : ordersByState) {
+            bool sorted = true;
+            for (int id = list.head; sorted && id; id = orderRecord(id)->nextInState) {
+                int next = orderRecord(id)->nextInState;
+                sorted = !next || next > id;
+            }
+            for (int id = sorted ? 0 : list.head; id; id = orderRecord(id)->nextInState) {
+                append(*orderRecord(id), false);
+            }
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!out.flush()) {
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    orderLog.close();
+    std::error_code error;
+    std::filesystem::rename(tempPath, orderLogPath, error);
+    orderLog.open(orderLogPath, std::ios::binary | std::ios::app);
+    if (error) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    orderLogRecords = records;
+    return true;
+}
+
+void WarehouseSystem::addTransaction(TransactionAction action, int itemId,
+                                     std::initializer_list<std::string_view> details) {
+    transactionHistory.emplace_back(action, itemId, details);
+}
+
+void WarehouseSystem::initializeCategoryTree() {
+    categoryRoot = std::make_shared<CategoryNode>("Root");
+}
+
+std::shared_ptr<CategoryNode> WarehouseSystem::findOrCreateCategory(const std::string& category) {
+    // Split category path (e.g., "Electronics/Phones" -> ["Electronics", "Phones"])
+    std::vector<std::string> path;
+    std::stringstream ss(category);
+    std::string segment;
+    while (std::getline(ss, segment, '/')) {
+        path.push_back(segment);
+    }
+
+    auto current = categoryRoot;
+    for (const auto& name : path) {
+        auto it = std::find_if(current->children.begin(), current->children.end(),
+            [&name](const auto& child) { return child->name == name; });
+        
+        if (it == current->children.end()) {
+            auto newNode = std::make_shared<CategoryNode>(name);
+            current->children.push_back(newNode);
+            current = newNode;
+        } else {
+            current = *it;
+        }
+    }
+    return current;
+}
+
+// Stock log
+//
+// An 8-byte header and the u64 hash of the CSV file the log applies to,
+// followed by little-endian shipment records
+//     u32 lineCount, then lineCount lines of
+//     u32 itemId, u32 quantity, u32 pathLength, then the path of the bin
+//     the stock was put away in (empty for none)
+// A log whose hash does not match the CSV file was started before the file
+// was last saved, so the file already holds its stock and the log is
+// dropped.
+//
+// Version 1 lines had no path. Such logs are applied and then replaced by
+// saving the CSV file.
+
+static const char kStockLogMagic[8] = {'W', 'M', 'S', 'S', 'T', 'K', '2', '\n'};
+static const char kStockLogMagicV1[8] = {'W', 'M', 'S', 'S', 'T', 'K', '1', '\n'};
+static const std::size_t kStockLogHeaderSize = 16;
+static const std::size_t kStockLineSize = 12;
+static const std::size_t kStockLineSizeV1 = 8;
+
+void WarehouseSystem::loadStockLog() {
+    std::vector<char> data;
+    std::ifstream file(stockLogPath, std::ios::binary | std::ios::ate);
+    if (file) {
+        data.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+    }
+
+    auto hasMagic = [&data](const char (&magic)[8]) {
+        return data.size() >= kStockLogHeaderSize && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+    };
+    bool version1 = hasMagic(kStockLogMagicV1);
+    bool current = (version1 || hasMagic(kStockLogMagic)) &&
+                   getLittleEndian(data.data() + 8, 8) == csvHash;
+    std::size_t lineSize = version1 ? kStockLineSizeV1 : kStockLineSize;
+    std::size_t offset = kStockLogHeaderSize;
+    while (current && offset + 4 <= data.size()) {
+        // Check that the whole record is there before applying any of it
+        std::size_t lineCount = getLittleEndian(data.data() + offset, 4);
+        std::size_t end = offset + 4;
+        bool torn = lineCount == 0;
+        for (std::size_t i = 0; i < lineCount && !torn; i++) {
+            torn = data.size() - end < lineSize;
+            if (!torn && !version1) {
+                torn = data.size() - end - lineSize < getLittleEndian(data.data() + end + 8, 4);
+            }
+            if (!torn) {
+                end += lineSize + (version1 ? 0 : getLittleEndian(data.data() + end + 8, 4));
+            }
+        }
+        if (torn) {
+            break;
+        }
+        for (const char* line = data.data() + offset + 4; line != data.data() + end;) {
+            auto item = inventory.find(static_cast<int>(getLittleEndian(line, 4)));
+            long long quantity = static_cast<long long>(getLittleEndian(line + 4, 4));
+            std::size_t pathLength = version1 ? 0 : getLittleEndian(line + 8, 4);
+            std::string_view path(line + lineSize, pathLength);
+            if (item != inventory.end() && quantity <= std::numeric_limits<int>::max() - item->second.getQuantity()) {
+                item->second.setQuantity(item->second.getQuantity() + static_cast<int>(quantity));
+                columns.updateQuantity(item->second);
+                if (!path.empty()) {
+                    locations.add(item->first, locations.intern(path), static_cast<int>(quantity));
+                }
+            }
+            line += lineSize + pathLength;
+        }
+        offset = end;
+        stockLogRecords++;
+    }
+
+    if (current && !version1 && offset == data.size()) {
+        stockLogBase = csvHash;
+        stockLogSize = data.size();
+        stockLog.open(stockLogPath, std::ios::binary | std::ios::app);
+    } else if (stockLogRecords > 0) {
+        // Keep what could be recovered from a torn or old log in the CSV file
+        saveToFile();
+    } else {
+        resetStockLog();
+    }
+}
+
+void WarehouseSystem::resetStockLog() const {
+    stockLog.close();
+    stockLog.open(stockLogPath, std::ios::binary | std::ios::trunc);
+    char header[kStockLogHeaderSize];
+    std::memcpy(header, kStockLogMagic, sizeof(kStockLogMagic));
+    putLittleEndian(header + 8, csvHash, 8);
+    stockLog.write(header, sizeof(header));
+    stockLog.flush();
+    stockLogRecords = 0;
+    stockLogBase = csvHash;
+    stockLogSize = kStockLogHeaderSize;
+    stockLogGeneration++;
+}
+
+void WarehouseSystem::logShipment(std::span<const RestockLine> lines) {
+    if (stockLogBase != csvHash) {
+        resetStockLog();  // The CSV file was saved since the log was started
+    }
+    std::string record(4, '\0');
+    putLittleEndian(record.data(), lines.size(), 4);
+    for (const auto& line : lines) {
+        std::string_view path;
+        if (line.location != kNoLocation) {
+            path = locations.getPath(line.location);
+        }
+        char fixed[kStockLineSize];
+        putLittleEndian(fixed, static_cast<std::uint32_t>(line.itemId), 4);
+        putLittleEndian(fixed + 4, static_cast<std::uint32_t>(line.quantity), 4);
+        putLittleEndian(fixed + 8, path.size(), 4);
+        record.append(fixed, sizeof(fixed));
+        record.append(path);
+    }
+    stockLog.write(record.data(), static_cast<std::streamsize>(record.size()));
+    stockLogSize += record.size();
+    if (autoSave) {
+        stockLog.flush();
+    }
+    if (++stockLogRecords >= std::max(kMinCompactionRecords, 4 * inventory.size())) {
+        saveToFile();
+    }
+}
+
+WarehouseSystem::CsvSnapshot WarehouseSystem::snapshotCsv() const {
+    std::ostringstream text;
+    writeCsv(text);
+    CsvSnapshot snapshot{std::move(text).str(), "", 0, stockLogGeneration, stockLogSize, stockLogRecords};
+    snapshot.hash = hashText(kCsvHashSeed, snapshot.text);
+    if (locations.getLocationCount() > 0) {
+        std::ostringstream locationsText;
+        writeLocations(locationsText);
+        snapshot.locationsText = std::move(locationsText).str();
+    }
+    return snapshot;
+}
+
+void WarehouseSystem::csvSaved(const CsvSnapshot& snapshot) const {
+    if (snapshot.stockLogGeneration != stockLogGeneration || stockLogBase != csvHash) {
+        // The file was saved again since the snapshot, and the snapshot
+        // may have overwritten newer stock
+        saveToFile();
+        return;
+    }
+    // Carry the shipments received since the snapshot over to the new log
+    stockLog.flush();
+    std::string tail;
+    std::ifstream file(stockLogPath, std::ios::binary);
+    if (file && stockLogSize > snapshot.stockLogSize) {
+        tail.resize(stockLogSize - snapshot.stockLogSize);
+        file.seekg(static_cast<std::streamoff>(snapshot.stockLogSize));
+        file.read(tail.data(), static_cast<std::streamsize>(tail.size()));
+        if (!file) {
+            saveToFile();
+            return;
+        }
+    }
+    file.close();
+    std::size_t records = stockLogRecords - snapshot.stockLogRecords;
+    csvHash = snapshot.hash;
+    resetStockLog();
+    stockLog.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+    stockLog.flush();
+    stockLogSize += tail.size();
+    stockLogRecords = records;
+}
+
+// Locations file
+//
+// Text lines of a record kind and comma-separated fields:
+//     L,path                                    the next location, numbered from 0
+//     B,itemId,location,quantity,lot            stock in a bin
+//     P,orderId,itemId,location,quantity,lot    stock an order took from a bin
+// where location is the number of an L line. Malformed lines are skipped.
+
+void WarehouseSystem::writeLocations(std::ostream& out) const {
+    std::string text;
+    auto field = [&text](long long value) {
+        text += ',';
+        text += DecimalText(value);
+    };
+    for (LocationId id = 0; id < locations.getLocationCount(); id++) {
+        text += "L,";
+        text += locations.getPath(id);
+        text += '\n';
+    }
+    locations.forEachBin([&](int itemId, const BinStock& bin) {
+        text += 'B';
+        field(itemId);
+        field(bin.location);
+        field(bin.quantity);
+        field(static_cast<long long>(bin.lot));
+        text += '\n';
+    });
+    for (const auto& [orderId, picks] : picksByOrder) {
+        for (const auto& pick : picks) {
+            text += 'P';
+            field(orderId);
+            field(pick.itemId);
+            field(pick.location);
+            field(pick.quantity);
+            field(static_cast<long long>(pick.lot));
+            text += '\n';
+        }
+    }
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void WarehouseSystem::loadLocations() {
+    std::ifstream file(locationsPath);
+    std::vector<LocationId> idOf;  // Location numbers in the file -> IDs
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.size() > 2 && line.compare(0, 2, "L,") == 0) {
+            idOf.push_back(locations.intern(std::string_view(line).substr(2)));
+            continue;
+        }
+        long long fields[5];
+        std::size_t count = line[0] == 'B' ? 4 : line[0] == 'P' ? 5 : 0;
+        const char* next = line.data() + 1;
+        const char* end = line.data() + line.size();
+        bool valid = count > 0;
+        for (std::size_t i = 0; valid && i < count; i++) {
+            valid = next != end && *next == ',';
+            if (valid) {
+                auto parsed = std::from_chars(next + 1, end, fields[i]);
+                valid = parsed.ec == std::errc() && fields[i] >= 0;
+                next = parsed.ptr;
+            }
+        }
+        if (!valid || next != end) {
+            continue;
+        }
+        // The fields end with location, quantity and lot; the IDs before
+        // them must fit an int
+        long long* tail = fields + count - 3;
+        if (static_cast<std::size_t>(tail[0]) >= idOf.size() || idOf[tail[0]] == kNoLocation ||
+            tail[1] == 0 || tail[1] > std::numeric_limits<int>::max() ||
+            std::any_of(fields, tail, [](long long id) {
+                return id > std::numeric_limits<int>::max();
+            })) {
+            continue;
+        }
+        if (count == 4) {
+            locations.add(static_cast<int>(fields[0]), idOf[tail[0]], static_cast<int>(tail[1]),
+                          static_cast<std::uint64_t>(tail[2]));
+        } else {
+            picksByOrder[static_cast<int>(fields[0])].push_back(
+                {static_cast<int>(fields[1]), idOf[tail[0]], static_cast<int>(tail[1]),
+                 static_cast<std::uint64_t>(tail[2])});
+            locations.noteLot(static_cast<std::uint64_t>(tail[2]));
+        }
+    }
+}
+
+void WarehouseSystem::checkLocations() {
+    std::vector<int> missing;
+    locations.forEachBin([this, &missing](int itemId, const BinStock&) {
+        if (!inventory.count(itemId)) {
+            missing.push_back(itemId);
+        }
+    });
+    for (int itemId : missing) {
+        locations.erase(itemId);
+    }
+    if (locations.getTotal() > 0) {
+        for (const auto& [id, item] : inventory) {
+            fitLocations(item);
+        }
+    }
+    std::erase_if(picksByOrder, [this](const auto& entry) {
+        const Order* order = orderRecord(entry.first);
+        return !order || (order->status != OrderStatus::Reserved && order->status != OrderStatus::Picked);
+    });
+}
+
+void WarehouseSystem::fitLocations(const InventoryItem& item) {
+    int excess = locations.getItemTotal(item.getId()) - std::max(item.getQuantity(), 0);
+    if (excess > 0) {
+        std::vector<Pick> emptied;
+        locations.take(item.getId(), excess, allocationPolicy, pickOrigin, emptied);
+    }
+}
+
+void WarehouseSystem::pickStock(int orderId, int itemId, int quantity) {
+    if (locations.getItemTotal(itemId) == 0) {
+        return;
+    }
+    auto& picks = picksByOrder[orderId];
+    locations.take(itemId, quantity, allocationPolicy, pickOrigin, picks);
+}
+
+void WarehouseSystem::unpickStock(int orderId, int itemId, int quantity) {
+    auto entry = picksByOrder.find(orderId);
+    if (entry == picksByOrder.end()) {
+        return;
+    }
+    auto& picks = entry->second;
+    for (std::size_t i = picks.size(); i-- > 0 && quantity > 0;) {
+        Pick& pick = picks[i];
+        if (pick.itemId != itemId) {
+            continue;
+        }
+        int units = std::min(pick.quantity, quantity);
+        locations.add(itemId, pick.location, units, pick.lot);
+        quantity -= units;
+        if ((pick.quantity -= units) == 0) {
+            picks.erase(picks.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+    }
+    if (picks.empty()) {
+        picksByOrder.erase(entry);
+    }
+}
+
+WarehouseSystem::WarehouseSystem(const std::string& filename) 
+    : filename(filename), nextId(1), transactionHistory(&recordPool), orders(&recordPool),
+      openOrdersByItem(&recordPool), reservedByItem(&recordPool),
+      nextOrderId(1), autoSave(true), orderLogPath(orderLogPathFor(filename)), orderLogRecords(0),
+      stockLogPath(stockLogPathFor(filename)), stockLogRecords(0), csvHash(kCsvHashSeed),
+      stockLogBase(0), stockLogSize(0), stockLogGeneration(0), stockChangesSinceCheck(0),
+      allocationPolicy(AllocationPolicy::Nearest), pickOrigin(kNoLocation),
+      locationsPath(locationsPathFor(filename)) {
+    loadFromFile();
+    loadLocations();
+    loadStockLog();
+    initializeCategoryTree();
+    loadOrderLog();
+    checkLocations();
+}
+
+void WarehouseSystem::addItem(const InventoryItem& item) {
+    auto [entry, added] = inventory.try_emplace(item.getId());
+    bool wasLow = !added && entry->second.isLowStock();
+    InventoryItem& stored = entry->second;
+    stored = item;
+    nameIndex.insert(item.getId(), item.getName());
+    columns.upsert(stored);
+    fitLocations(stored);
+    nextId = item.getId() + 1;
+    
+    // Add item to category tree
+    auto categoryNode = findOrCreateCategory(item.getCategory());
+    categoryNode->itemIds.push_back(item.getId());
+    
+    addTransaction(TransactionAction::Add, item.getId(),
+        {"Added ", item.getName(), " to category ", item.getCategory()});
+    noteStockChanges(1);
+    noteLowStock(stored, wasLow);
+    persist();
+}
+
+bool WarehouseSystem::removeItem(int id) {
+    if (!inventory.count(id)) {
+        return false;
+    }
+    // Cancel the item's open orders while it still exists, so their
+    // promised stock and picks are released; picked orders are past
+    // cancelling and ship without it
+    std::vector<int> cancelled;
+    if (auto entry = openOrdersByItem.find(id); entry != openOrdersByItem.end()) {
+        for (int orderId = entry->second.head; orderId; orderId = orderRecord(orderId)->findLine(id)->nextForItem) {
+            if (orderRecord(orderId)->status != OrderStatus::Picked) {
+                cancelled.push_back(orderId);
+            }
+        }
+    }
+    for (int orderId : cancelled) {
+        setOrderStatus(orderId, OrderStatus::Cancelled);
+    }
+    inventory.erase(id);
+    nameIndex.erase(id);
+    columns.erase(id);
+    forecaster.erase(id);
+    replenishment.settle(id);
+    locations.erase(id);
+    noteStockChanges(1);
+    persist();
+    return true;
+}
+
+bool WarehouseSystem::updateItem(const InventoryItem& item) {
+    auto entry = inventory.find(item.getId());
+    if (entry != inventory.end()) {
+        bool wasLow = entry->second.isLowStock();
+        bool recategorized = entry->second.getCategory() != item.getCategory();
+        entry->second = item;
+        nameIndex.insert(item.getId(), item.getName());
+        columns.upsert(entry->second);
+        fitLocations(entry->second);
+        noteStockChanges(1);
+        noteLowStock(entry->second, wasLow);
+        if (recategorized) {
+            recategorizeRestock(entry->second);
+        }
+        persist();
+        return true;
+    }
+    return false;
+}
+
+InventoryItem* WarehouseSystem::findItem(int id) {
+    ScopedTimer timer(Operation::FindItem);
+    auto it = inventory.find(id);
+    return (it != inventory.end()) ? &it->second : nullptr;
+}
+
+const InventoryItem* WarehouseSystem::findItem(int id) const {
+    ScopedTimer timer(Operation::FindItem);
+    auto it = inventory.find(id);
+    return (it != inventory.end()) ? &it->second : nullptr;
+}
+
+// Reports on the inventory; see report.h
+namespace {
+
+using report::Column;
+using IdColumn = Column<"ID", &InventoryItem::getId>;
+using NameColumn = Column<"Name", &InventoryItem::getName>;
+using CategoryColumn = Column<"Category", &InventoryItem::getCategory>;
+using QuantityColumn = Column<"Quantity", &InventoryItem::getQuantity>;
+
+using ItemTable = report::Table<
+    Column<"ID", &InventoryItem::getId, 5>, Column<"Name", &InventoryItem::getName, 20>,
+    Column<"Category", &InventoryItem::getCategory, 15>, Column<"Quantity", &InventoryItem::getQuantity, 10>,
+    Column<"Price", &InventoryItem::getPrice, 10>, Column<"Min Stock", &InventoryItem::getMinStockLevel, 15>>;
+
+using AllItemsReport = report::Report<ItemTable>;
+using LowStockReport = report::Report<
+    report::Fields<IdColumn, NameColumn, Column<"Current Stock", &InventoryItem::getQuantity>,
+                   Column<"Min Stock", &InventoryItem::getMinStockLevel>>,
+    report::LowStock>;
+using CategoryReport = report::Report<
+    report::Fields<IdColumn, NameColumn, QuantityColumn, Column<"Price", &InventoryItem::getPrice>>,
+    report::InCategory>;
+using NameSortedReport = report::Report<
+    report::Fields<IdColumn, NameColumn, CategoryColumn, QuantityColumn>, report::AnyItem, report::ByName>;
+using QuantitySortedReport = report::Report<
+    report::Fields<IdColumn, NameColumn, QuantityColumn>, report::AnyItem, report::ByQuantity>;
+
+}  // namespace
+
+void WarehouseSystem::displayTableHeader() const {
+    std::string out;
+    ItemTable::header(out);
+    std::cout << out;
+}
+
+void WarehouseSystem::displayTableRow(const InventoryItem& item) const {
+    std::string out;
+    ItemTable::row(out, item);
+    std::cout << out;
+}
+
+void WarehouseSystem::displayAllItems() const {
+    ScopedTimer timer(Operation::DisplayAllItems);
+    if (AllItemsReport::write(std::cout, inventory, "") == 0) {
+        std::cout << "No items in the inventory.\n";
+    }
+}
+
+std::vector<InventoryItem> WarehouseSystem::fetchPage(PageCursor& cursor, std::size_t pageSize) const {
+    ScopedTimer timer(Operation::FetchPage);
+    std::vector<InventoryItem> page;
+    if (cursor.isFinished() || pageSize == 0) {
+        return page;
+    }
+    page.reserve(pageSize);
+
+    if (cursor.getKey() == SortKey::Id) {
+        auto it = cursor.isStarted() ? inventory.upper_bound(cursor.getLastId())
+                                     : inventory.begin();
+        for (; it != inventory.end() && page.size() < pageSize; ++it) {
+            if (cursor.matches(it->second)) {
+                page.push_back(it->second);
+            }
+        }
+    } else {
+        auto compare = [&cursor](const InventoryItem* a, const InventoryItem* b) {
+            return cursor.less(*a, *b);
+        };
+        std::vector<const InventoryItem*> heap;
+        heap.reserve(pageSize);
+        for (const auto& [id, item] : inventory) {
+            if (!cursor.matches(item) || !cursor.isAfter(item)) {
+                continue;
+            }
+            if (heap.size() < pageSize) {
+                heap.push_back(&item);
+                std::push_heap(heap.begin(), heap.end(), compare);
+            } else if (compare(&item, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), compare);
+                heap.back() = &item;
+                std::push_heap(heap.begin(), heap.end(), compare);
+            }
+        }
+        std::sort_heap(heap.begin(), heap.end(), compare);
+        for (const auto* item : heap) {
+            page.push_back(*item);
+        }
+    }
+
+    if (!page.empty()) {
+        cursor.advance(page.back());
+    }
+    if (page.size() < pageSize) {
+        cursor.finish();
+    }
+    return page;
+}
+
+void WarehouseSystem::displayLowStockItems() const {
+    ScopedTimer timer(Operation::DisplayLowStockItems);
+    if (LowStockReport::write(std::cout, inventory, "Low Stock Items:\n") == 0) {
+        std::cout << "No items are low on stock.\n";
+    }
+}
+
+void WarehouseSystem::displayByCategory(const std::string& category) const {
+    ScopedTimer timer(Operation::DisplayByCategory);
+    std::string heading = "Items in category '" + category + "':\n";
+    if (CategoryReport::write(std::cout, inventory, heading, report::InCategory{category}) == 0) {
+        std::cout << "No items found in category: " << category << "\n";
+    }
+}
+
+std::vector<InventoryItem> WarehouseSystem::getAllItems() const {
+    std::vector<InventoryItem> items;
+    for (const auto& [id, item] : inventory) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<NameSearchResult> WarehouseSystem::searchItems(std::string_view query,
+                                                           std::size_t limit) const {
+    ScopedTimer timer(Operation::SearchItems);
+    return nameIndex.search(query, limit);
+}
+
+void WarehouseSystem::displaySearchResults(std::string_view query, std::size_t limit) const {
+    displaySearchResults(query, searchItems(query, limit));
+}
+
+void WarehouseSystem::displaySearchResults(std::string_view query,
+                                           std::span<const NameSearchResult> results) const {
+    if (results.empty()) {
+        std::cout << "No items match '" << query << "'\n";
+        return;
+    }
+    // Fuzzy matches are only returned when nothing else matched
+    if (results.front().match == NameMatch::Fuzzy) {
+        std::cout << "No items match '" << query << "'. Closest names:\n";
+    } else {
+        std::cout << "Items matching '" << query << "':\n";
+    }
+    displayTableHeader();
+    for (const auto& result : results) {
+        displayTableRow(inventory.at(result.itemId));
+    }
+}
+
+WarehouseSystem::QueryResult WarehouseSystem::queryItems(const ItemQuery& query) const {
+    ScopedTimer timer(Operation::QueryItems);
+    QueryResult result;
+    result.plan = {QueryAccess::Scan, columns.size()};
+    std::vector<std::uint8_t> categoryMask;  // Empty accepts every category
+    if (!query.category.empty()) {
+        categoryMask = columns.categoryMask(query.category);
+        std::size_t candidates = columns.countInCategories(categoryMask);
+        if (candidates < result.plan.candidates) {
+            result.plan = {QueryAccess::Category, candidates};
+        }
+    }
+    if (!query.namePrefix.empty()) {
+        std::size_t candidates = nameIndex.estimatePrefix(query.namePrefix);
+        if (candidates < result.plan.candidates) {
+            result.plan = {QueryAccess::NamePrefix, candidates};
+        }
+    }
+    if (query.minQuantity > std::numeric_limits<int>::min() ||
+        query.maxQuantity < std::numeric_limits<int>::max()) {
+        std::size_t candidates = columns.byQuantity().count(query.minQuantity, query.maxQuantity,
+                                                            result.plan.candidates);
+        if (candidates < result.plan.candidates) {
+            result.plan = {QueryAccess::QuantityRange, candidates};
+        }
+    }
+    if (query.minPrice > -std::numeric_limits<double>::infinity() ||
+        query.maxPrice < std::numeric_limits<double>::infinity()) {
+        std::size_t candidates = columns.byPrice().count(query.minPrice, query.maxPrice,
+                                                         result.plan.candidates);
+        if (candidates < result.plan.candidates) {
+            result.plan = {QueryAccess::PriceRange, candidates};
+        }
+    }
+
+    std::vector<std::uint32_t> rows;
+    if (result.plan.access == QueryAccess::Scan) {
+        columns.scan(query, categoryMask, rows);
+    } else {
+        std::vector<int> ids;
+        switch (result.plan.access) {
+            case QueryAccess::Category:
+                columns.idsInCategories(categoryMask, ids);
+                break;
+            case QueryAccess::NamePrefix:
+                nameIndex.idsWithPrefix(query.namePrefix, ids);
+                break;
+            case QueryAccess::QuantityRange:
+                columns.byQuantity().idsInRange(query.minQuantity, query.maxQuantity, ids);
+                break;
+            case QueryAccess::PriceRange:
+                columns.byPrice().idsInRange(query.minPrice, query.maxPrice, ids);
+                break;
+            case QueryAccess::Scan:
+                break;
+        }
+        for (int id : ids) {
+            std::uint32_t row = columns.findRow(id);
+            if (row < columns.size() && columns.matches(row, query, categoryMask)) {
+                rows.push_back(row);
+            }
+        }
+    }
+    if (!query.namePrefix.empty() && result.plan.access != QueryAccess::NamePrefix) {
+        std::erase_if(rows, [this, &query](std::uint32_t row) {
+            return !query.matchesName(columns.item(row).getName());
+        });
+    }
+    result.matched = rows.size();
+
+    // Order by the sort key, then by ID
+    auto sign = [](auto a, auto b) { return (a > b) - (a < b); };
+    auto compare = [this, &query, sign](std::uint32_t a, std::uint32_t b) {
+        const InventoryItem& first = columns.item(a);
+        const InventoryItem& second = columns.item(b);
+        int order = 0;
+        switch (query.sortBy) {
+            case QuerySort::Name: order = first.getName().compare(second.getName()); break;
+            case QuerySort::Quantity: order = sign(columns.quantity(a), columns.quantity(b)); break;
+            case QuerySort::Price: order = sign(columns.price(a), columns.price(b)); break;
+            case QuerySort::Id: order = sign(first.getId(), second.getId()); break;
+        }
+        if (order != 0) {
+            return query.descending ? order > 0 : order < 0;
+        }
+        return first.getId() < second.getId();
+    };
+    std::size_t count = query.limit == 0 ? rows.size() : std::min(query.limit, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(count), rows.end(), compare);
+    result.items.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        result.items.push_back(columns.item(rows[i]));
+    }
+    return result;
+}
+
+void WarehouseSystem::displayQueryResults(const ItemQuery& query) const {
+    displayQueryResults(queryItems(query));
+}
+
+void WarehouseSystem::displayQueryResults(const QueryResult& result) const {
+    std::cout << result.matched << " matching items (" << queryAccessName(result.plan.access)
+              << ", " << result.plan.candidates << " candidates)";
+    if (result.items.size() < result.matched) {
+        std::cout << ", showing " << result.items.size();
+    }
+    std::cout << "\n";
+    if (result.items.empty()) {
+        return;
+    }
+    displayTableHeader();
+    for (const auto& item : result.items) {
+        displayTableRow(item);
+    }
+}
+
+// Report of every category with items, given the totals of each category
+// code with its subcategories
+template <typename TotalsOf>
+static WarehouseSystem::StockReport stockReport(const ItemColumns& columns, const StockTotals& total,
+                                                TotalsOf totalsOf) {
+    WarehouseSystem::StockReport report;
+    report.total = total;
+    for (std::uint32_t code : columns.categoriesInTreeOrder()) {
+        // Items without a category only count towards the total
+        const std::string& category = columns.categoryName(code);
+        const StockTotals& totals = totalsOf(code);
+        if (totals.items > 0 && !category.empty()) {
+            report.categories.push_back({category, totals});
+        }
+    }
+    return report;
+}
+
+WarehouseSystem::StockReport WarehouseSystem::aggregateStock(unsigned threadCount) const {
+    ScopedTimer timer(Operation::AggregateStock);
+    std::vector<StockTotals> totals = columns.totalsByCategory(threadCount);
+    StockTotals total;
+    for (const auto& category : totals) {
+        total.add(category);
+    }
+    columns.rollUpCategories(totals);
+    return stockReport(columns, total, [&totals](std::uint32_t code) -> const StockTotals& {
+        return totals[code];
+    });
+}
+
+StockTotals WarehouseSystem::getStockTotals(const std::string& category) const {
+    std::uint32_t code = columns.findCategory(category);
+    return code != ItemColumns::kNoCategory ? columns.runningTotals(code) : StockTotals();
+}
+
+WarehouseSystem::StockReport WarehouseSystem::getStockReport() const {
+    return stockReport(columns, columns.runningTotals(), [this](std::uint32_t code) -> const StockTotals& {
+        return columns.runningTotals(code);
+    });
+}
+
+StockDrift WarehouseSystem::verifyStockTotals(unsigned threadCount) {
+    ScopedTimer timer(Operation::VerifyStockTotals);
+    lastStockDrift = columns.checkTotals(threadCount);
+    stockChangesSinceCheck = 0;
+    return lastStockDrift;
+}
+
+void WarehouseSystem::noteStockChanges(std::size_t count) {
+    stockChangesSinceCheck += count;
+    if (stockChangesSinceCheck >= std::max(kMinStockCheckChanges, 4 * inventory.size())) {
+        verifyStockTotals();
+    }
+}
+
+void WarehouseSystem::displayStockReport() const {
+    displayStockReport(getStockReport());
+}
+
+void WarehouseSystem::displayStockReport(const StockReport& report) const {
+    // Formatted in a local stream so std::cout keeps its own precision
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2)
+        << "Stock value " << report.total.value << " over " << report.total.items << " items, "
+        << report.total.quantity << " units, " << report.total.lowStock << " low on stock ("
+        << std::setprecision(1) << report.total.lowStockRatio() * 100 << "%)\n";
+    if (!report.categories.empty()) {
+        out << std::left << std::setw(30) << "Category" << std::right << " | "
+            << std::setw(8) << "Items" << " | "
+            << std::setw(12) << "Quantity" << " | "
+            << std::setw(15) << "Value" << " | "
+            << std::setw(9) << "Low Stock" << "\n";
+        out << std::string(86, '-') << "\n";
+    }
+    for (const auto& [category, totals] : report.categories) {
+        // Subcategories are indented under their parent by their last segment
+        auto depth = static_cast<std::size_t>(std::count(category.begin(), category.end(), '/'));
+        std::size_t lastSlash = category.rfind('/');
+        std::string label = std::string(depth * 2, ' ') +
+                            (lastSlash == std::string::npos ? category : category.substr(lastSlash + 1));
+        out << std::left << std::setw(30) << label << std::right << " | "
+            << std::setw(8) << totals.items << " | "
+            << std::setw(12) << totals.quantity << " | "
+            << std::setw(15) << std::setprecision(2) << totals.value << " | "
+            << std::setw(8) << std::setprecision(1) << totals.lowStockRatio() * 100 << "%\n";
+    }
+    std::cout << out.str();
+}
+
+std::vector<ReorderRecommendation> WarehouseSystem::recommendReorders(unsigned threadCount) const {
+    ScopedTimer timer(Operation::RecommendReorders);
+    auto recommendations = forecaster.recommendAll(std::time(nullptr), threadCount);
+    std::sort(recommendations.begin(), recommendations.end(),
+              [](const ReorderRecommendation& a, const ReorderRecommendation& b) {
+                  return a.itemId < b.itemId;
+              });
+    return recommendations;
+}
+
+std::size_t WarehouseSystem::applyReorderPoints(unsigned threadCount) {
+    std::size_t changed = 0;
+    for (const auto& recommendation : forecaster.recommendAll(std::time(nullptr), threadCount)) {
+        auto entry = inventory.find(recommendation.itemId);
+        if (entry != inventory.end() && entry->second.getMinStockLevel() != recommendation.reorderPoint) {
+            bool wasLow = entry->second.isLowStock();
+            entry->second.setMinStockLevel(recommendation.reorderPoint);
+            columns.upsert(entry->second);
+            noteLowStock(entry->second, wasLow);
+            changed++;
+        }
+    }
+    if (changed > 0) {
+        addTransaction(TransactionAction::ReorderPoints, 0,
+            {"Set reorder points of ", DecimalText(static_cast<long long>(changed)), " items"});
+        noteStockChanges(changed);
+        persist();
+    }
+    return changed;
+}
+
+void WarehouseSystem::displayReorderRecommendations(std::size_t limit) const {
+    auto recommendations = recommendReorders();
+    std::vector<std::pair<const InventoryItem*, const ReorderRecommendation*>> due;
+    for (const auto& recommendation : recommendations) {
+        auto entry = inventory.find(recommendation.itemId);
+        if (entry != inventory.end() && entry->second.getQuantity() <= recommendation.reorderPoint) {
+            due.emplace_back(&entry->second, &recommendation);
+        }
+    }
+    std::cout << "Demand forecast for " << recommendations.size() << " items, " << due.size()
+              << " at or below their reorder point\n";
+    if (due.empty()) {
+        return;
+    }
+    std::cout << std::setw(5) << "ID" << " | "
+              << std::left << std::setw(20) << "Name" << std::right << " | "
+              << std::setw(8) << "Stock" << " | "
+              << std::setw(10) << "Per Day" << " | "
+              << std::setw(8) << "Std Dev" << " | "
+              << std::setw(8) << "Reorder" << " | "
+              << std::setw(8) << "Order" << "\n";
+    std::cout << std::string(86, '-') << "\n";
+    std::ostringstream rows;  // Keeps the fixed precision off std::cout
+    rows << std::fixed << std::setprecision(2);
+    for (std::size_t i = 0; i < due.size() && i < limit; i++) {
+        const auto& [item, recommendation] = due[i];
+        rows << std::setw(5) << item->getId() << " | "
+             << std::left << std::setw(20) << item->getName().substr(0, 20) << std::right << " | "
+             << std::setw(8) << item->getQuantity() << " | "
+             << std::setw(10) << recommendation->dailyDemand << " | "
+             << std::setw(8) << recommendation->deviation << " | "
+             << std::setw(8) << recommendation->reorderPoint << " | "
+             << std::setw(8) << recommendation->reorderQuantity << "\n";
+    }
+    std::cout << rows.str();
+    if (due.size() > limit) {
+        std::cout << "... and " << due.size() - limit << " more\n";
+    }
+}
+
+void WarehouseSystem::lowStockChanged(const InventoryItem& item) {
+    if (!item.isLowStock()) {
+        replenishment.settle(item.getId());
+        return;
+    }
+    std::size_t issued = replenishment.getInbound().size();
+    replenishment.request(item.getId(), item.getCategory(), restockQuantity(item), std::time(nullptr));
+    if (replenishment.getInbound().size() != issued) {
+        issueRestock(replenishment.getInbound().back());
+    }
+}
+
+int WarehouseSystem::restockQuantity(const InventoryItem& item) const {
+    ReorderRecommendation recommendation;
+    if (getReorderRecommendation(item.getId(), recommendation) && recommendation.reorderQuantity > 0) {
+        return recommendation.reorderQuantity;
+    }
+    long long shortfall = 2LL * item.getMinStockLevel() - item.getQuantity();
+    return static_cast<int>(std::clamp<long long>(shortfall, 1, std::numeric_limits<int>::max()));
+}
+
+void WarehouseSystem::issueRestock(const RestockOrder& order) {
+    long long units = 0;
+    for (const auto& line : order.lines) {
+        units += line.quantity;
+    }
+    addTransaction(TransactionAction::RestockIssued,
+                   order.lines.size() == 1 ? order.lines.front().itemId : 0,
+        {"Restock order #", DecimalText(order.restockId), " for ", DecimalText(units),
+         " units of ", DecimalText(static_cast<long long>(order.lines.size())), " items in ",
+         order.category.empty() ? std::string_view("no category") : std::string_view(order.category)});
+}
+
+std::size_t WarehouseSystem::issueRestockOrders() {
+    std::size_t issued = replenishment.issueAll(std::time(nullptr));
+    const auto& inbound = replenishment.getInbound();
+    for (std::size_t i = inbound.size() - issued; i < inbound.size(); i++) {
+        issueRestock(inbound[i]);
+    }
+    return issued;
+}
+
+void WarehouseSystem::displayRestockOrders(std::size_t limit) const {
+    auto printOrder = [](const RestockOrder& order) {
+        std::cout << (order.category.empty() ? "(no category)" : order.category) << ":";
+        for (const auto& line : order.lines) {
+            std::cout << " " << line.itemId << "x" << line.quantity;
+        }
+        std::cout << "\n";
+    };
+    auto drafts = replenishment.getDrafts();
+    std::cout << "Draft restock orders: " << drafts.size() << "\n";
+    for (const auto& order : drafts) {
+        std::cout << "  ";
+        printOrder(order);
+    }
+    const auto& inbound = replenishment.getInbound();
+    std::cout << "Issued restock orders: " << inbound.size();
+    if (inbound.size() > limit) {
+        std::cout << ", newest " << limit;
+    }
+    std::cout << "\n";
+    for (std::size_t i = inbound.size() - std::min(limit, inbound.size()); i < inbound.size(); i++) {
+        std::cout << "  #" << inbound[i].restockId << " ";
+        printOrder(inbound[i]);
+    }
+}
+
+void WarehouseSystem::sortByName() const {
+    ScopedTimer timer(Operation::SortByName);
+    NameSortedReport::write(std::cout, inventory, "");
+}
+
+void WarehouseSystem::sortByQuantity() const {
+    ScopedTimer timer(Operation::SortByQuantity);
+    QuantitySortedReport::write(std::cout, inventory, "");
+}
+
+void WarehouseSystem::writeCsv(std::ostream& out) const {
+    out << "ID,Name,Category,Quantity,Price,MinStockLevel\n";
+    
+    for (const auto& [id, item] : inventory) {
+        out << item.getId() << ","
+            << item.getName() << ","
+            << item.getCategory() << ","
+            << item.getQuantity() << ","
+            << std::fixed << std::setprecision(2) << item.getPrice() << ","
+            << item.getMinStockLevel() << "\n";
+    }
+}
+
+bool WarehouseSystem::parseCsvLine(const std::string& line, InventoryItem& item) {
+    std::size_t fieldStart[6];
+    std::size_t fieldEnd[6];
+    std::size_t pos = 0;
+    for (int field = 0; field < 6; field++) {
+        std::size_t comma = line.find(',', pos);
+        if ((comma == std::string::npos) != (field == 5)) {
+            return false;
+        }
+        fieldStart[field] = pos;
+        fieldEnd[field] = comma == std::string::npos ? line.size() : comma;
+        pos = fieldEnd[field] + 1;
+    }
+    if (fieldEnd[5] > fieldStart[5] && line[fieldEnd[5] - 1] == '\r') {
+        fieldEnd[5]--;
+    }
+
+    auto parseNumber = [&line, &fieldStart, &fieldEnd](int field, auto& value) {
+        const char* first = line.data() + fieldStart[field];
+        const char* last = line.data() + fieldEnd[field];
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    };
+
+    int id, quantity, minStockLevel;
+    double price;
+    if (!parseNumber(0, id) || !parseNumber(3, quantity) ||
+        !parseNumber(4, price) || !parseNumber(5, minStockLevel)) {
+        return false;
+    }
+    item = InventoryItem(id, line.substr(fieldStart[1], fieldEnd[1] - fieldStart[1]),
+                         line.substr(fieldStart[2], fieldEnd[2] - fieldStart[2]),
+                         quantity, price, minStockLevel);
+    return true;
+}
+
+// Text that fits in one field of one CSV row
+static bool isCsvField(const std::string& text) {
+    return std::none_of(text.begin(), text.end(), [](char c) {
+        return c == ',' || std::iscntrl(static_cast<unsigned char>(c));
+    });
+}
+
+bool WarehouseSystem::isValidItem(const InventoryItem& item) {
+    return item.getId() > 0 && !item.getName().empty() &&
+           isCsvField(item.getName()) && isCsvField(item.getCategory()) &&
+           item.getQuantity() >= 0 && item.getPrice() >= 0 &&
+           item.getMinStockLevel() >= 0;
+}
+
+bool WarehouseSystem::importFromFile(const std::string& path, BulkUpsertResult& result,
+                                     std::size_t& malformedRows) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<InventoryItem> items;
+    std::string line;
+    malformedRows = 0;
+    std::getline(file, line);  // Skip header line
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        InventoryItem item;
+        if (parseCsvLine(line, item)) {
+            items.push_back(std::move(item));
+        } else {
+            malformedRows++;
+        }
+    }
+    result = bulkUpsert(items);
+    return true;
+}
+
+Order* WarehouseSystem::orderRecord(int orderId) {
+    if (orderId < 1 || static_cast<std::size_t>(orderId) > orders.size()) {
+        return nullptr;
+    }
+    return &orders[static_cast<std::size_t>(orderId) - 1];
+}
+
+const Order* WarehouseSystem::orderRecord(int orderId) const {
+    if (orderId < 1 || static_cast<std::size_t>(orderId) > orders.size()) {
+        return nullptr;
+    }
+    return &orders[static_cast<std::size_t>(orderId) - 1];
+}
+
+template <typename Links>
+void WarehouseSystem::linkOrder(OrderList& list, Order& order, Links links) {
+    auto [prev, next] = links(order);
+    prev = list.tail;
+    next = 0;
+    if (list.tail) {
+        std::get<1>(links(*orderRecord(list.tail))) = order.orderId;
+    } else {
+        list.head = order.orderId;
+    }
+    list.tail = order.orderId;
+    list.size++;
+}
+
+template <typename Links>
+void WarehouseSystem::unlinkOrder(OrderList& list, Order& order, Links links) {
+    auto [prev, next] = links(order);
+    if (prev) {
+        std::get<1>(links(*orderRecord(prev))) = next;
+    } else {
+        list.head = next;
+    }
+    if (next) {
+        std::get<0>(links(*orderRecord(next))) = prev;
+    } else {
+        list.tail = prev;
+    }
+    prev = next = 0;
+    list.size--;
+}
+
+void WarehouseSystem::moveOrder(Order& order, OrderStatus status) {
+    unlinkOrder(ordersByState[static_cast<std::size_t>(order.status)], order, StateLinks{});
+    if (isOpenOrderStatus(order.status) && !isOpenOrderStatus(status)) {
+        for (const auto& line : order.lines) {
+            auto entry = openOrdersByItem.find(line.itemId);
+            unlinkOrder(entry->second, order, ItemLinks{line.itemId});
+            if (entry->second.size == 0) {
+                openOrdersByItem.erase(entry);
+            }
+        }
+    }
+    order.status = status;
+    linkOrder(ordersByState[static_cast<std::size_t>(status)], order, StateLinks{});
+}
+
+void WarehouseSystem::recordStatusChange(const Order& order) {
+    addTransaction(TransactionAction::OrderStatusChanged, transactionItemId(order),
+        {"Order #", DecimalText(order.getOrderId()), " is now ", orderStatusName(order.getStatus())});
+}
+
+void WarehouseSystem::releaseStock(const Order& order) {
+    for (const auto& line : order.lines) {
+        releaseStock(line.itemId, line.quantity);
+    }
+}
+
+void WarehouseSystem::releaseStock(int itemId, int quantity) {
+    auto entry = reservedByItem.find(itemId);
+    if (entry != reservedByItem.end() && (entry->second -= quantity) <= 0) {
+        reservedByItem.erase(entry);
+    }
+}
+
+int WarehouseSystem::getReservedQuantity(int itemId) const {
+    auto entry = reservedByItem.find(itemId);
+    return entry != reservedByItem.end() ? entry->second : 0;
+}
+
+int WarehouseSystem::getAvailableQuantity(int itemId) const {
+    auto item = inventory.find(itemId);
+    if (item == inventory.end()) {
+        return 0;
+    }
+    return item->second.getQuantity() - getReservedQuantity(itemId);
+}
+
+int WarehouseSystem::placeOrder(std::span<const OrderLine> lines) {
+    ScopedTimer timer(Operation::CreateOrder);
+    if (lines.empty()) {
+        return 0;
+    }
+
+    int orderId = nextOrderId;
+    Order& order = orders.emplace_back(orderId);
+    auto& orderLines = order.lines;
+    orderLines.assign(lines.begin(), lines.end());
+    std::sort(orderLines.begin(), orderLines.end(), [](const OrderLine& a, const OrderLine& b) {
+        return a.itemId < b.itemId;
+    });
+    // Merge lines for the same item, checking each line before it is added
+    // in so the sum can neither overflow nor hide a bad line
+    std::size_t merged = 0;
+    for (std::size_t i = 1; i < orderLines.size(); i++) {
+        if (orderLines[i].itemId != orderLines[merged].itemId) {
+            orderLines[++merged] = orderLines[i];
+            continue;
+        }
+        long long quantity = static_cast<long long>(orderLines[merged].quantity) + orderLines[i].quantity;
+        if (orderLines[merged].quantity <= 0 || orderLines[i].quantity <= 0 ||
+            quantity > std::numeric_limits<int>::max()) {
+            orders.pop_back();
+            return 0;
+        }
+        orderLines[merged].quantity = static_cast<int>(quantity);
+    }
+    orderLines.resize(merged + 1, orderLines.front());
+
+    // One lookup per line both validates it and checks what is available
+    bool promised = true;
+    for (const auto& line : orderLines) {
+        auto item = findItem(line.itemId);
+        if (!item || line.quantity <= 0) {
+            orders.pop_back();
+            return 0;
+        }
+        promised = promised && item->getQuantity() - getReservedQuantity(line.itemId) >= line.quantity;
+    }
+    nextOrderId++;
+    if (promised) {
+        for (const auto& line : orderLines) {
+            reservedByItem[line.itemId] += line.quantity;
+        }
+    } else {
+        order.status = OrderStatus::Backordered;
+    }
+    linkOrder(ordersByState[static_cast<std::size_t>(order.status)], order, StateLinks{});
+    for (const auto& line : orderLines) {
+        linkOrder(openOrdersByItem[line.itemId], order, ItemLinks{line.itemId});
+    }
+    logOrder(order, true);
+    if (orderLines.size() == 1) {
+        addTransaction(TransactionAction::OrderCreated, orderLines.front().itemId,
+            {"Ordered ", DecimalText(orderLines.front().quantity),
+             promised ? " units" : " units (backordered)"});
+    } else {
+        addTransaction(TransactionAction::OrderCreated, 0,
+            {"Ordered ", DecimalText(order.getTotalQuantity()), " units of ",
+             DecimalText(static_cast<long long>(orderLines.size())),
+             promised ? " items" : " items (backordered)"});
+    }
+    return orderId;
+}
+
+int WarehouseSystem::createOrder(int itemId, int quantity) {
+    int orderId = placeOrder(itemId, quantity);
+    if (!orderId) {
+        std::cout << "Invalid item ID or quantity!\n";
+    } else if (orderRecord(orderId)->status == OrderStatus::Backordered) {
+        std::cout << "Order #" << orderId << " backordered: only "
+                  << std::max(getAvailableQuantity(itemId), 0) << " units available.\n";
+    } else {
+        std::cout << "Order created successfully!\n";
+    }
+    return orderId;
+}
+
+int WarehouseSystem::createOrder(std::span<const OrderLine> lines) {
+    int orderId = placeOrder(lines);
+    if (!orderId) {
+        std::cout << "Invalid item ID or quantity!\n";
+    } else if (orderRecord(orderId)->status == OrderStatus::Backordered) {
+        std::cout << "Order #" << orderId << " backordered: not enough stock for every line.\n";
+    } else {
+        std::cout << "Order #" << orderId << " created successfully!\n";
+    }
+    return orderId;
+}
+
+bool WarehouseSystem::parseOrderLines(std::string_view text, std::vector<OrderLine>& lines) {
+    lines.clear();
+    std::size_t pos = 0;
+    while (true) {
+        pos = text.find_first_not_of(' ', pos);
+        if (pos == std::string_view::npos) {
+            return !lines.empty();
+        }
+        std::size_t end = std::min(text.find(' ', pos), text.size());
+        const char* first = text.data() + pos;
+        const char* last = text.data() + end;
+        int itemId, quantity;
+        auto item = std::from_chars(first, last, itemId);
+        if (item.ec != std::errc() || item.ptr == last || *item.ptr != ':') {
+            return false;
+        }
+        auto count = std::from_chars(item.ptr + 1, last, quantity);
+        if (count.ec != std::errc() || count.ptr != last) {
+            return false;
+        }
+        lines.emplace_back(itemId, quantity);
+        pos = end;
+    }
+}
+
+std::string WarehouseSystem::formatOrderLines(std::span<const OrderLine> lines) {
+    std::string text;
+    for (const auto& line : lines) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += std::to_string(line.getItemId());
+        text += ':';
+        text += std::to_string(line.getQuantity());
+    }
+    return text;
+}
+
+WarehouseSystem::OrderResult WarehouseSystem::fulfillNextOrder(Order* handled) {
+    ScopedTimer timer(Operation::ProcessNextOrder);
+    int orderId = ordersByState[static_cast<std::size_t>(OrderStatus::Pending)].head;
+    if (!orderId) {
+        orderId = ordersByState[static_cast<std::size_t>(OrderStatus::Backordered)].head;
+    }
+    if (!orderId) {
+        return OrderResult::NoOrders;
+    }
+
+    auto result = fulfillOrder(orderId);
+    if (handled) {
+        *handled = *orderRecord(orderId);
+    }
+    return result;
+}
+
+WarehouseSystem::OrderResult WarehouseSystem::fulfillOrder(int orderId) {
+    Order* order = orderRecord(orderId);
+    if (!order || (order->status != OrderStatus::Pending &&
+                   order->status != OrderStatus::Backordered)) {
+        return OrderResult::NoOrders;
+    }
+
+    bool promised = order->status == OrderStatus::Pending;
+    if (promised) {
+        releaseStock(*order);
+    }
+    // Check every line before taking any stock, so an order that cannot be
+    // filled leaves no trace on the items. A promise only falls through if
+    // the item's quantity was lowered since; backorders cannot take stock
+    // promised to pending orders. Lines are merged by item, so each line can
+    // be checked on its own.
+    bool missing = false;
+    bool shortOfStock = false;
+    for (const auto& line : order->lines) {
+        auto item = findItem(line.itemId);
+        missing = !item;
+        if (missing) {
+            break;
+        }
+        int available = item->getQuantity() - (promised ? 0 : getReservedQuantity(line.itemId));
+        shortOfStock = available < line.quantity;
+        if (shortOfStock) {
+            break;
+        }
+    }
+    if (missing) {
+        moveOrder(*order, OrderStatus::Cancelled);
+        logOrder(*order);
+        recordStatusChange(*order);
+        return OrderResult::ItemMissing;
+    }
+    if (shortOfStock) {
+        // Backorders that are still short go to the back of the backorders
+        bool changed = order->status != OrderStatus::Backordered;
+        moveOrder(*order, OrderStatus::Backordered);
+        logOrder(*order);
+        if (changed) {
+            recordStatusChange(*order);
+        }
+        return OrderResult::InsufficientStock;
+    }
+
+    for (const auto& line : order->lines) {
+        adjustStock(inventory.find(line.itemId)->second, -line.quantity);
+        noteDemand(line.itemId, line.quantity);
+        pickStock(orderId, line.itemId, line.quantity);
+    }
+    moveOrder(*order, OrderStatus::Reserved);
+    logOrder(*order);
+    addTransaction(TransactionAction::OrderProcessed, transactionItemId(*order),
+        {"Processed order #", DecimalText(order->getOrderId()),
+         " for ", DecimalText(order->getTotalQuantity()), " units"});
+    persist();
+    return OrderResult::Processed;
+}
+
+bool WarehouseSystem::setOrderStatus(int orderId, OrderStatus status) {
+    Order* order = orderRecord(orderId);
+    if (!order || !isValidOrderTransition(order->status, status)) {
+        return false;
+    }
+    if (status == OrderStatus::Reserved) {
+        return fulfillOrder(orderId) == OrderResult::Processed;
+    }
+
+    if (order->status == OrderStatus::Reserved && status == OrderStatus::Cancelled) {
+        // Return the reserved stock, to the bins it was picked from
+        for (const auto& line : order->lines) {
+            if (auto item = findItem(line.itemId)) {
+                adjustStock(*item, line.quantity);
+                unpickStock(orderId, line.itemId, line.quantity);
+                noteDemand(line.itemId, -line.quantity);
+            }
+        }
+        picksByOrder.erase(orderId);
+        persist();
+    } else if (order->status == OrderStatus::Pending) {
+        releaseStock(*order);
+    } else if (status == OrderStatus::Shipped) {
+        picksByOrder.erase(orderId);  // The stock has left its bins for good
+    }
+    moveOrder(*order, status);
+    logOrder(*order);
+    recordStatusChange(*order);
+    return true;
+}
+
+bool WarehouseSystem::amendOrder(int orderId, int itemId, int quantity) {
+    Order* order = orderRecord(orderId);
+    OrderLine* line = order ? order->findLine(itemId) : nullptr;
+    if (!line || quantity <= 0) {
+        return false;
+    }
+    int extra = quantity - line->quantity;
+    if (order->status == OrderStatus::Pending) {
+        if (extra > 0 && getAvailableQuantity(itemId) < extra) {
+            return false;
+        }
+        if (extra > 0) {
+            reservedByItem[itemId] += extra;
+        } else {
+            releaseStock(itemId, -extra);
+        }
+    } else if (order->status == OrderStatus::Reserved) {
+        auto item = findItem(itemId);
+        if (!item || (extra > 0 && getAvailableQuantity(itemId) < extra)) {
+            return false;
+        }
+        adjustStock(*item, -extra);
+        if (extra > 0) {
+            pickStock(orderId, itemId, extra);
+        } else {
+            unpickStock(orderId, itemId, -extra);
+        }
+        noteDemand(itemId, extra);
+        persist();
+    } else if (order->status != OrderStatus::Backordered) {
+        return false;
+    }
+
+    line->quantity = quantity;
+    logOrder(*order, true);
+    addTransaction(TransactionAction::OrderAmended, itemId,
+        {"Order #", DecimalText(orderId), " changed to ", DecimalText(quantity), " units"});
+    return true;
+}
+
+WarehouseSystem::ReceiveResult WarehouseSystem::receiveShipment(std::span<const RestockLine> lines) {
+    ScopedTimer timer(Operation::ReceiveStock);
+    ReceiveResult result;
+    std::vector<RestockLine> sorted(lines.begin(), lines.end());
+    std::sort(sorted.begin(), sorted.end(), [](const RestockLine& a, const RestockLine& b) {
+        return a.itemId != b.itemId ? a.itemId < b.itemId : a.location < b.location;
+    });
+    // Merge the lines for each item and bin, and check each item's total
+    // before changing anything
+    std::vector<RestockLine> merged;
+    std::vector<InventoryItem*> items;  // For each merged line
+    long long units = 0;
+    std::size_t itemCount = 0;
+    for (std::size_t first = 0, last = 0; first < sorted.size(); first = last) {
+        auto item = inventory.find(sorted[first].itemId);
+        if (item == inventory.end()) {
+            return result;
+        }
+        long long quantity = 0;
+        for (; last < sorted.size() && sorted[last].itemId == sorted[first].itemId; last++) {
+            const RestockLine& line = sorted[last];
+            if (line.quantity <= 0 || (line.location != kNoLocation && !locations.isLocation(line.location))) {
+                return result;
+            }
+            quantity += line.quantity;
+            if (quantity > std::numeric_limits<int>::max() - item->second.getQuantity()) {
+                return result;
+            }
+            if (last > first && sorted[last - 1].location == line.location) {
+                merged.back().quantity += line.quantity;
+            } else {
+                merged.push_back(line);
+                items.push_back(&item->second);
+            }
+        }
+        units += quantity;
+        itemCount++;
+    }
+    if (merged.empty()) {
+        return result;
+    }
+
+    for (std::size_t i = 0; i < merged.size(); i++) {
+        adjustStock(*items[i], merged[i].quantity);
+        locations.add(merged[i].itemId, merged[i].location, merged[i].quantity);
+        replenishment.receive(merged[i].itemId, merged[i].quantity);
+        // A restock that arrived in full but left the item low asks again
+        if (items[i]->isLowStock() && !replenishment.hasRequest(merged[i].itemId)) {
+            lowStockChanged(*items[i]);
+        }
+    }
+    logShipment(merged);
+    addTransaction(TransactionAction::StockReceived, itemCount == 1 ? merged.front().itemId : 0,
+        {"Received ", DecimalText(units), " units of ",
+         DecimalText(static_cast<long long>(itemCount)), " items"});
+    result.received = true;
+    // Every backorder reserved would save the inventory; save it once for
+    // the whole receipt instead
+    bool saving = autoSave;
+    autoSave = false;
+    for (std::size_t i = 0; i < merged.size(); i++) {
+        if (i == 0 || merged[i - 1].itemId != merged[i].itemId) {
+            result.ordersReserved += wakeBackorders(merged[i].itemId);
+        }
+    }
+    autoSave = saving;
+    if (autoSave && result.ordersReserved > 0) {
+        save();
+    }
+    return result;
+}
+
+WarehouseSystem::ReceiveResult WarehouseSystem::receiveStockAt(int itemId, std::string_view location,
+                                                               int quantity) {
+    // Check the rest first so a rejected receipt does not add the location
+    auto item = inventory.find(itemId);
+    if (item == inventory.end() || quantity <= 0 ||
+        quantity > std::numeric_limits<int>::max() - item->second.getQuantity()) {
+        return ReceiveResult();
+    }
+    LocationId id = locations.intern(location);
+    if (id == kNoLocation) {
+        return ReceiveResult();
+    }
+    RestockLine line{itemId, quantity, id};
+    return receiveShipment(std::span<const RestockLine>(&line, 1));
+}
+
+int WarehouseSystem::getUnlocatedQuantity(int itemId) const {
+    auto item = inventory.find(itemId);
+    return item != inventory.end() ? item->second.getQuantity() - locations.getItemTotal(itemId) : 0;
+}
+
+bool WarehouseSystem::setAllocationPolicy(AllocationPolicy policy, std::string_view origin) {
+    LocationId originId = kNoLocation;
+    // Looked up rather than interned, so a mistyped origin never becomes a location
+    if (!origin.empty() && (originId = locations.find(origin)) == kNoLocation) {
+        return false;
+    }
+    allocationPolicy = policy;
+    pickOrigin = originId;
+    return true;
+}
+
+std::span<const Pick> WarehouseSystem::getOrderPicks(int orderId) const {
+    auto entry = picksByOrder.find(orderId);
+    return entry != picksByOrder.end() ? std::span<const Pick>(entry->second) : std::span<const Pick>();
+}
+
+bool WarehouseSystem::moveStock(int itemId, std::string_view from, std::string_view to, int quantity) {
+    if (quantity <= 0 || !inventory.count(itemId) || !LocationStock::isValidPath(to)) {
+        return false;
+    }
+    if (from.empty()) {
+        if (getUnlocatedQuantity(itemId) < quantity) {
+            return false;
+        }
+        locations.add(itemId, locations.intern(to), quantity);
+    } else {
+        LocationId source = locations.find(from);
+        if (source == kNoLocation || locations.getQuantity(itemId, source) < quantity) {
+            return false;
+        }
+        locations.move(itemId, source, locations.intern(to), quantity);
+    }
+    addTransaction(TransactionAction::StockMoved, itemId,
+        {"Moved ", DecimalText(quantity), " units from ", from.empty() ? "unlocated stock" : from,
+         " to ", to});
+    persist();
+    return true;
+}
+
+std::size_t WarehouseSystem::wakeBackorders(int itemId) {
+    auto list = openOrdersByItem.find(itemId);
+    if (list == openOrdersByItem.end() || getOrderCount(OrderStatus::Backordered) == 0) {
+        return 0;
+    }
+    // Only orders that can take every line now are tried, so backorders
+    // that are still short keep their place in the queue
+    auto fillable = [this](const Order& order) {
+        for (const auto& line : order.lines) {
+            if (getAvailableQuantity(line.itemId) < line.quantity) {
+                return false;
+            }
+        }
+        return true;
+    };
+    std::size_t reserved = 0;
+    for (int id = list->second.head; id && getAvailableQuantity(itemId) > 0;) {
+        Order& order = *orderRecord(id);
+        id = order.findLine(itemId)->nextForItem;
+        if (order.status == OrderStatus::Backordered && fillable(order) &&
+            fulfillOrder(order.orderId) == OrderResult::Processed) {
+            reserved++;
+        }
+    }
+    return reserved;
+}
+
+std::vector<Order> WarehouseSystem::getOrdersByStatus(OrderStatus status) const {
+    std::vector<Order> result;
+    result.reserve(getOrderCount(status));
+    for (int id = ordersByState[static_cast<std::size_t>(status)].head; id;
+         id = orderRecord(id)->nextInState) {
+        result.push_back(*orderRecord(id));
+    }
+    return result;
+}
+
+WarehouseSystem::OrderResult WarehouseSystem::processNextOrder() {
+    Order order(0, 0, 0);
+    OrderResult result = fulfillNextOrder(&order);
+    switch (result) {
+        case OrderResult::NoOrders:
+            std::cout << "No orders to process!\n";
+            break;
+        case OrderResult::Processed:
+            std::cout << "Order #" << order.getOrderId() << " processed successfully!\n";
+            break;
+        case OrderResult::InsufficientStock:
+            std::cout << "Insufficient stock for order #" << order.getOrderId() << "!\n";
+            break;
+        case OrderResult::ItemMissing:
+            break;
+    }
+    return result;
+}
+
+void WarehouseSystem::displayTransactionHistory(int limit) const {
+    ScopedTimer timer(Operation::DisplayTransactionHistory);
+    std::cout << "\nRecent Transaction History:\n";
+    std::cout << std::string(50, '-') << "\n";
+    
+    int count = 0;
+    for (auto it = transactionHistory.rbegin();
+         it != transactionHistory.rend() && count < limit; ++it, count++) {
+        std::cout << it->toString() << "\n";
+    }
+}
+
+std::vector<Order> WarehouseSystem::getOpenOrdersForItem(int itemId) const {
+    std::vector<Order> result;
+    auto entry = openOrdersByItem.find(itemId);
+    if (entry == openOrdersByItem.end()) {
+        return result;
+    }
+    result.reserve(entry->second.size);
+    for (int id = entry->second.head; id; id = orderRecord(id)->findLine(itemId)->nextForItem) {
+        result.push_back(*orderRecord(id));
+    }
+    return result;
+}
+
+void WarehouseSystem::displayOrder(const Order& order) const {
+    auto itemName = [this](int itemId) -> const std::string& {
+        static const std::string unknown = "Unknown";
+        auto item = inventory.find(itemId);
+        return item != inventory.end() ? item->second.getName() : unknown;
+    };
+    std::cout << "Order #" << order.getOrderId() << ":\n";
+    if (order.getLines().size() == 1) {
+        std::cout << "  Item: " << itemName(order.getItemId())
+                  << " (ID: " << order.getItemId() << ")\n"
+                  << "  Quantity: " << order.getQuantity() << "\n";
+    } else {
+        std::cout << "  Items:\n";
+        for (const auto& line : order.getLines()) {
+            std::cout << "    " << itemName(line.getItemId()) << " (ID: " << line.getItemId()
+                      << ") x " << line.getQuantity() << "\n";
+        }
+    }
+    std::cout << "  Status: " << orderStatusName(order.getStatus()) << "\n";
+    auto picks = getOrderPicks(order.getOrderId());
+    if (!picks.empty()) {
+        std::cout << "  Picked from:\n";
+        for (const auto& pick : picks) {
+            std::cout << "    " << locations.getPath(pick.location) << ": " << pick.quantity
+                      << " of item " << pick.itemId << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+void WarehouseSystem::displayItemLocations(int itemId) const {
+    auto item = inventory.find(itemId);
+    if (item == inventory.end()) {
+        std::cout << "Item " << itemId << " not found.\n";
+        return;
+    }
+    std::vector<BinStock> bins(locations.getBins(itemId).begin(), locations.getBins(itemId).end());
+    std::sort(bins.begin(), bins.end(), [this](const BinStock& a, const BinStock& b) {
+        return locations.getPath(a.location) < locations.getPath(b.location);
+    });
+    std::cout << "\nLocations of " << item->second.getName() << " (ID: " << itemId << "), "
+              << item->second.getQuantity() << " units:\n";
+    std::cout << std::string(50, '-') << "\n";
+    for (const auto& bin : bins) {
+        std::cout << std::left << std::setw(30) << locations.getPath(bin.location) << std::right
+                  << std::setw(8) << bin.quantity << "  lot " << bin.lot << "\n";
+    }
+    std::cout << std::left << std::setw(30) << "(unlocated)" << std::right << std::setw(8)
+              << getUnlocatedQuantity(itemId) << "\n";
+    std::cout << "Orders pick by " << allocationPolicyName(allocationPolicy);
+    if (pickOrigin != kNoLocation) {
+        std::cout << " from " << locations.getPath(pickOrigin);
+    }
+    std::cout << "\n";
+}
+
+void WarehouseSystem::displayOrderQueue() const {
+    ScopedTimer timer(Operation::DisplayOrderQueue);
+    if (getPendingOrderCount() == 0) {
+        std::cout << "No pending orders.\n";
+        return;
+    }
+
+    std::cout << "\nPending Orders:\n";
+    std::cout << std::string(50, '-') << "\n";
+    for (auto status : {OrderStatus::Pending, OrderStatus::Backordered}) {
+        for (int id = ordersByState[static_cast<std::size_t>(status)].head; id;
+             id = orderRecord(id)->nextInState) {
+            displayOrder(*orderRecord(id));
+        }
+    }
+}
+
+void WarehouseSystem::displayOrdersByStatus(OrderStatus status) const {
+    ScopedTimer timer(Operation::DisplayOrderQueue);
+    if (getOrderCount(status) == 0) {
+        std::cout << "No " << orderStatusName(status) << " orders.\n";
+        return;
+    }
+
+    std::cout << "\n" << orderStatusName(status) << " Orders (" << getOrderCount(status) << "):\n";
+    std::cout << std::string(50, '-') << "\n";
+    for (int id = ordersByState[static_cast<std::size_t>(status)].head; id;
+         id = orderRecord(id)->nextInState) {
+        displayOrder(*orderRecord(id));
+    }
+}
+
+void WarehouseSystem::displayItemOrders(int itemId) const {
+    ScopedTimer timer(Operation::DisplayOrderQueue);
+    auto entry = openOrdersByItem.find(itemId);
+    if (entry == openOrdersByItem.end()) {
+        std::cout << "No open orders for item " << itemId << ".\n";
+        return;
+    }
+
+    std::cout << "\nOpen Orders for Item " << itemId << " (" << entry->second.size << "):\n";
+    std::cout << std::string(50, '-') << "\n";
+    for (int id = entry->second.head; id; id = orderRecord(id)->findLine(itemId)->nextForItem) {
+        displayOrder(*orderRecord(id));
+    }
+}
@@ -0,0 +1,999 @@
+#pragma once
+
+#include "forecast.h"
+#include "location.h"
+#include "metrics.h"
+#include "query.h"
+#include "replenishment.h"
+#include "search.h"
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <array>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <initializer_list>
+#include <charconv>
+#include <cctype>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <utility>
+
+// InventoryItem class definition
+class InventoryItem {
+private:
+    int id;
+    std::string name;
+    std::string category;
+    int quantity;
+    double price;
+    int minStockLevel;
+
+public:
+    InventoryItem() = default;
+    InventoryItem(int id, const std::string& name, const std::string& category, 
+                 int quantity, double price, int minStockLevel)
+        : id(id), name(name), category(category), quantity(quantity), 
+          price(price), minStockLevel(minStockLevel) {}
+
+    // Getters
+    int getId() const { return id; }
+    const std::string& getName() const { return name; }
+    const std::string& getCategory() const { return category; }
+    int getQuantity() const { return quantity; }
+    double getPrice() const { return price; }
+    int getMinStockLevel() const { return minStockLevel; }
+
+    // Setters
+    void setId(int newId) { id = newId; }
+    void setName(const std::string& newName) { name = newName; }
+    void setCategory(const std::string& newCategory) { category = newCategory; }
+    void setQuantity(int newQuantity) { quantity = newQuantity; }
+    void setPrice(double newPrice) { price = newPrice; }
+    void setMinStockLevel(int newMinStockLevel) { minStockLevel = newMinStockLevel; }
+
+    // Check if item is low on stock
+    bool isLowStock() const { return quantity <= minStockLevel; }
+};
+
+// Kinds of change recorded in the transaction history
+enum class TransactionAction : std::uint8_t {
+    Add, OrderCreated, OrderProcessed, OrderStatusChanged, OrderAmended, BulkUpsert, ReorderPoints, RestockIssued,
+    StockReceived, StockMoved
+};
+
+inline const char* transactionActionName(TransactionAction action) {
+    switch (action) {
+        case TransactionAction::Add: return "Add";
+        case TransactionAction::OrderCreated: return "Order Created";
+        case TransactionAction::OrderProcessed: return "Order Processed";
+        case TransactionAction::OrderStatusChanged: return "Order Status";
+        case TransactionAction::OrderAmended: return "Order Amended";
+        case TransactionAction::BulkUpsert: return "Bulk Upsert";
+        case TransactionAction::ReorderPoints: return "Reorder Points";
+        case TransactionAction::RestockIssued: return "Restock Issued";
+        case TransactionAction::StockReceived: return "Stock Received";
+        case TransactionAction::StockMoved: return "Stock Moved";
+    }
+    return "";
+}
+
+// Decimal text of a number in a fixed buffer, for building transaction
+// details without a temporary std::string
+class DecimalText {
+private:
+    char buffer[24];
+    std::size_t length;
+
+public:
+    explicit DecimalText(long long value)
+        : length(static_cast<std::size_t>(std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer)) {}
+
+    operator std::string_view() const { return std::string_view(buffer, length); }
+};
+
+// Transaction class for history tracking. The details text lives in the
+// memory resource of the container holding the transaction.
+class Transaction {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+private:
+    std::time_t timestamp;
+    TransactionAction action;
+    int itemId;
+    std::pmr::string details;
+
+public:
+    // Details are the concatenation of the given pieces
+    Transaction(TransactionAction action, int itemId,
+                std::initializer_list<std::string_view> details,
+                const allocator_type& allocator = {})
+        : timestamp(std::time(nullptr)), action(action), itemId(itemId), details(allocator) {
+        for (auto piece : details) {
+            this->details.append(piece);
+        }
+    }
+
+    Transaction(const Transaction& other, const allocator_type& allocator)
+        : timestamp(other.timestamp), action(other.action), itemId(other.itemId),
+          details(other.details, allocator) {}
+
+    Transaction(Transaction&& other, const allocator_type& allocator)
+        : timestamp(other.timestamp), action(other.action), itemId(other.itemId),
+          details(std::move(other.details), allocator) {}
+
+    Transaction(const Transaction&) = default;
+    Transaction(Transaction&&) = default;
+    Transaction& operator=(const Transaction&) = default;
+    Transaction& operator=(Transaction&&) = default;
+
+    TransactionAction getAction() const { return action; }
+    int getItemId() const { return itemId; }
+    std::string_view getDetails() const { return details; }
+
+    std::string getFormattedTime() const;
+    std::string toString() const;
+};
+
+// Category tree node
+struct CategoryNode {
+    std::string name;
+    std::vector<std::shared_ptr<CategoryNode>> children;
+    std::vector<int> itemIds; // Store item IDs in this category
+
+    CategoryNode(const std::string& name) : name(name) {}
+};
+
+// Order life cycle. Pending and Backordered orders wait in the queue:
+// a pending order has stock promised to it in the reservation ledger, a
+// backordered one is waiting for stock. Reserved orders have taken their
+// stock.
+enum class OrderStatus : std::uint8_t { Pending, Reserved, Picked, Shipped, Cancelled, Backordered, Count };
+
+constexpr std::size_t kOrderStatusCount = static_cast<std::size_t>(OrderStatus::Count);
+
+inline const char* orderStatusName(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::Pending: return "Pending";
+        case OrderStatus::Reserved: return "Reserved";
+        case OrderStatus::Picked: return "Picked";
+        case OrderStatus::Shipped: return "Shipped";
+        case OrderStatus::Cancelled: return "Cancelled";
+        case OrderStatus::Backordered: return "Backordered";
+        case OrderStatus::Count: break;
+    }
+    return "";
+}
+
+// Match a status name, ignoring case. Returns false for unknown names.
+inline bool parseOrderStatus(std::string_view name, OrderStatus& status) {
+    for (std::size_t i = 0; i < kOrderStatusCount; i++) {
+        std::string_view candidate = orderStatusName(static_cast<OrderStatus>(i));
+        if (std::equal(name.begin(), name.end(), candidate.begin(), candidate.end(),
+                       [](char a, char b) {
+                           return std::tolower(static_cast<unsigned char>(a)) ==
+                                  std::tolower(static_cast<unsigned char>(b));
+                       })) {
+            status = static_cast<OrderStatus>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Allowed moves of the order state machine:
+//     Pending     -> Reserved, Backordered, Cancelled
+//     Backordered -> Reserved, Cancelled
+//     Reserved    -> Picked, Cancelled
+//     Picked      -> Shipped
+// Shipped and Cancelled are final.
+inline bool isOpenOrderStatus(OrderStatus status) {
+    return status != OrderStatus::Shipped && status != OrderStatus::Cancelled;
+}
+
+inline bool isValidOrderTransition(OrderStatus from, OrderStatus to) {
+    switch (from) {
+        case OrderStatus::Pending:
+            return to == OrderStatus::Reserved || to == OrderStatus::Backordered ||
+                   to == OrderStatus::Cancelled;
+        case OrderStatus::Backordered:
+            return to == OrderStatus::Reserved || to == OrderStatus::Cancelled;
+        case OrderStatus::Reserved:
+            return to == OrderStatus::Picked || to == OrderStatus::Cancelled;
+        case OrderStatus::Picked:
+            return to == OrderStatus::Shipped;
+        default:
+            return false;
+    }
+}
+
+// One item of an order
+class OrderLine {
+private:
+    int itemId;
+    int quantity;
+    int prevForItem = 0;  // Neighbours in the item's open order list (order IDs, 0 = none)
+    int nextForItem = 0;
+
+    friend class WarehouseSystem;
+
+public:
+    OrderLine(int itemId, int quantity) : itemId(itemId), quantity(quantity) {}
+
+    int getItemId() const { return itemId; }
+    int getQuantity() const { return quantity; }
+};
+
+// Order class for queue. Lines are sorted by item ID with one line per
+// item, and their storage comes from the memory resource of the container
+// holding the order.
+class Order {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<OrderLine>;
+
+private:
+    int orderId;
+    OrderStatus status;
+    std::time_t orderTime;
+    std::pmr::vector<OrderLine> lines;
+    int prevInState = 0;  // Neighbours in the per-state order list (0 = none)
+    int nextInState = 0;
+
+    friend class WarehouseSystem;
+
+    OrderLine* findLine(int itemId) {
+        return const_cast<OrderLine*>(std::as_const(*this).findLine(itemId));
+    }
+
+public:
+    explicit Order(int orderId, const allocator_type& allocator = {})
+        : orderId(orderId), status(OrderStatus::Pending), orderTime(std::time(nullptr)),
+          lines(allocator) {}
+
+    Order(int orderId, int itemId, int quantity, const allocator_type& allocator = {})
+        : Order(orderId, allocator) {
+        lines.emplace_back(itemId, quantity);
+    }
+
+    Order(const Order& other, const allocator_type& allocator)
+        : orderId(other.orderId), status(other.status), orderTime(other.orderTime),
+          lines(other.lines, allocator), prevInState(other.prevInState),
+          nextInState(other.nextInState) {}
+
+    Order(Order&& other, const allocator_type& allocator)
+        : orderId(other.orderId), status(other.status), orderTime(other.orderTime),
+          lines(std::move(other.lines), allocator), prevInState(other.prevInState),
+          nextInState(other.nextInState) {}
+
+    Order(const Order&) = default;
+    Order(Order&&) = default;
+    Order& operator=(const Order&) = default;
+    Order& operator=(Order&&) = default;
+
+    int getOrderId() const { return orderId; }
+    OrderStatus getStatus() const { return status; }
+    std::time_t getOrderTime() const { return orderTime; }
+    std::span<const OrderLine> getLines() const { return lines; }
+
+    // Item and quantity of a single-line order, or of its first line
+    int getItemId() const { return lines.empty() ? 0 : lines.front().getItemId(); }
+    int getQuantity() const { return lines.empty() ? 0 : lines.front().getQuantity(); }
+
+    // Summed as long long: each line fits in an int, but their sum may not
+    long long getTotalQuantity() const {
+        long long total = 0;
+        for (const auto& line : lines) {
+            total += line.getQuantity();
+        }
+        return total;
+    }
+
+    // The line for an item, or nullptr if the order does not contain it
+    const OrderLine* findLine(int itemId) const {
+        auto line = std::lower_bound(lines.begin(), lines.end(), itemId,
+                                     [](const OrderLine& candidate, int id) {
+                                         return candidate.getItemId() < id;
+                                     });
+        return line != lines.end() && line->getItemId() == itemId ? &*line : nullptr;
+    }
+
+    void setStatus(OrderStatus newStatus) { status = newStatus; }
+};
+
+// Sort orders supported by paginated listings
+enum class SortKey { Id, Name, Quantity };
+
+// Resume point for paginated listings. The cursor remembers the sort key of the
+// last item it returned (with the item ID as tie-breaker), so the next page
+// starts right after it even if items were added or removed in between.
+class PageCursor {
+private:
+    SortKey key;
+    std::string category;  // Empty means all categories
+    bool started;
+    bool finished;
+    int lastId;
+    int lastQuantity;
+    std::string lastName;
+
+public:
+    PageCursor(SortKey key = SortKey::Id, const std::string& category = "")
+        : key(key), category(category), started(false), finished(false),
+          lastId(0), lastQuantity(0) {}
+
+    SortKey getKey() const { return key; }
+    const std::string& getCategory() const { return category; }
+    bool isStarted() const { return started; }
+    bool isFinished() const { return finished; }
+    int getLastId() const { return lastId; }
+
+    // Check if item belongs to this listing
+    bool matches(const InventoryItem& item) const {
+        return category.empty() || item.getCategory() == category;
+    }
+
+    // Strict ordering of two items under this cursor's sort key
+    bool less(const InventoryItem& a, const InventoryItem& b) const {
+        switch (key) {
+            case SortKey::Name:
+                if (a.getName() != b.getName()) return a.getName() < b.getName();
+                break;
+            case SortKey::Quantity:
+                if (a.getQuantity() != b.getQuantity()) return a.getQuantity() < b.getQuantity();
+                break;
+            case SortKey::Id:
+                break;
+        }
+        return a.getId() < b.getId();
+    }
+
+    // Check if item sorts strictly after the last item returned
+    bool isAfter(const InventoryItem& item) const {
+        if (!started) return true;
+        switch (key) {
+            case SortKey::Name:
+                if (item.getName() != lastName) return item.getName() > lastName;
+                break;
+            case SortKey::Quantity:
+                if (item.getQuantity() != lastQuantity) return item.getQuantity() > lastQuantity;
+                break;
+            case SortKey::Id:
+                break;
+        }
+        return item.getId() > lastId;
+    }
+
+    void advance(const InventoryItem& last) {
+        started = true;
+        lastId = last.getId();
+        lastQuantity = last.getQuantity();
+        lastName = last.getName();
+    }
+
+    void finish() { finished = true; }
+
+    // Serialize to an opaque token so a listing can be resumed later.
+    // Format: key:finished:lastId:lastQuantity:categoryLength:category lastName
+    std::string toToken() const;
+
+    // Parse a token produced by toToken(); returns false if it is malformed
+    static bool fromToken(const std::string& token, PageCursor& cursor);
+};
+
+
+// WarehouseSystem class definition
+class WarehouseSystem {
+private:
+    std::map<int, InventoryItem> inventory;
+    NameIndex nameIndex;  // Item names, kept in step with the inventory
+    ItemColumns columns;  // Filterable fields of every item, for queries
+    std::string filename;
+    int nextId;
+    // Orders and transactions are created at high rates, so they draw their
+    // memory (deque blocks and detail strings) from a pool that recycles
+    // freed blocks instead of going to the global heap each time. The pool
+    // must be declared before the containers that use it.
+    std::pmr::unsynchronized_pool_resource recordPool;
+    std::pmr::deque<Transaction> transactionHistory;  // Newest at the back
+    std::pmr::deque<Order> orders;                    // Every order, indexed by orderId - 1
+
+    // Orders linked through the orders themselves, so adding or removing one
+    // is O(1) and never moves the others
+    struct OrderList {
+        int head = 0;
+        int tail = 0;
+        std::size_t size = 0;
+    };
+    // One list per state. The Pending list followed by the Backordered list
+    // is the processing queue.
+    std::array<OrderList, kOrderStatusCount> ordersByState;
+    // Open (not shipped or cancelled) orders of each item, oldest first,
+    // linked through the order's line for that item
+    std::pmr::unordered_map<int, OrderList> openOrdersByItem;
+    // Stock promised to pending orders, by item. Items without pending
+    // orders have no entry.
+    std::pmr::unordered_map<int, int> reservedByItem;
+    std::shared_ptr<CategoryNode> categoryRoot;
+    int nextOrderId;
+    bool autoSave;
+
+    // Append-only log of order changes, replayed on construction
+    std::string orderLogPath;
+    mutable std::ofstream orderLog;
+    std::size_t orderLogRecords;  // Records in the log, superseded ones included
+    // Append-only log of received stock, applied on top of the CSV file so
+    // receiving stock does not rewrite it. Saving the file starts it over.
+    std::string stockLogPath;
+    mutable std::ofstream stockLog;
+    mutable std::size_t stockLogRecords;  // Shipments in the log
+    mutable std::uint64_t csvHash;        // Of the CSV file as last loaded or saved
+    mutable std::uint64_t stockLogBase;   // Hash of the CSV file the stock log applies to
+    mutable std::size_t stockLogSize;     // Bytes in the log, header included
+    mutable std::uint64_t stockLogGeneration;  // Times the log was started over
+
+    // Stock changes since the running stock totals were last recounted
+    std::size_t stockChangesSinceCheck;
+    StockDrift lastStockDrift;
+    // Daily demand of every item, fed by the stock orders take
+    DemandForecaster forecaster;
+    // Restock orders for items that ran low, raised as they cross their
+    // minimum stock level rather than by scanning for them
+    ReplenishmentQueue replenishment;
+    // Stock by bin, and the bins each reserved or picked order took its
+    // stock from. An item's binned stock never exceeds its quantity; the
+    // rest, such as stock from an inventory file without locations, is
+    // unlocated. Saved next to the inventory file along with it.
+    LocationStock locations;
+    AllocationPolicy allocationPolicy;
+    LocationId pickOrigin;
+    std::unordered_map<int, std::vector<Pick>> picksByOrder;
+    std::string locationsPath;
+
+    // Count changes to the stock, recounting the running totals once they
+    // outnumber the items four to one
+    void noteStockChanges(std::size_t count);
+    // Count stock taken by an order (or returned, if negative) as demand today
+    void noteDemand(int itemId, int quantity) {
+        forecaster.recordDemand(itemId, quantity, std::time(nullptr));
+    }
+
+    void loadFromFile();
+
+    void saveToFile() const;
+
+    // Write changes through to the CSV file unless saving is deferred
+    void persist() const;
+
+    // Request a restock for an item that just became low on stock, or
+    // drop the request of one that no longer is
+    void noteLowStock(const InventoryItem& item, bool wasLow) {
+        if (item.isLowStock() != wasLow) {
+            lowStockChanged(item);
+        }
+    }
+    void lowStockChanged(const InventoryItem& item);
+    // Move the drafted restock request of an item that changed category to
+    // the new category's draft; an issued one is already on its way from
+    // the old supplier
+    void recategorizeRestock(const InventoryItem& item) {
+        if (item.isLowStock() && replenishment.isDrafted(item.getId())) {
+            replenishment.settle(item.getId());
+            lowStockChanged(item);
+        }
+    }
+    // Units to restock an item with: its forecast reorder quantity, or
+    // without demand history, enough to reach twice its minimum stock level
+    int restockQuantity(const InventoryItem& item) const;
+    void issueRestock(const RestockOrder& order);
+    // Change an item's stock by delta, keeping the query columns in step
+    void adjustStock(InventoryItem& item, int delta) {
+        bool wasLow = item.isLowStock();
+        item.setQuantity(item.getQuantity() + delta);
+        columns.updateQuantity(item);
+        noteStockChanges(1);
+        noteLowStock(item, wasLow);
+    }
+
+    // Take an order's stock for an item from the item's bins, as the
+    // allocation policy picks them; whatever the bins lack is unlocated
+    void pickStock(int orderId, int itemId, int quantity);
+    // Return up to quantity units of an item picked for an order to the
+    // bins they came from, newest picks first
+    void unpickStock(int orderId, int itemId, int quantity);
+    // Empty bins, as the allocation policy picks them, until the item's
+    // binned stock fits its quantity
+    void fitLocations(const InventoryItem& item);
+    void loadLocations();
+    // Drop bins of missing items, fit the rest to their quantities and drop
+    // the picks of orders that no longer hold stock
+    void checkLocations();
+    void writeLocations(std::ostream& out) const;
+
+    void addTransaction(TransactionAction action, int itemId,
+                        std::initializer_list<std::string_view> details);
+
+    void initializeCategoryTree();
+
+    std::shared_ptr<CategoryNode> findOrCreateCategory(const std::string& category);
+
+    Order* orderRecord(int orderId);
+    const Order* orderRecord(int orderId) const;
+
+    // Link fields of an order in its state list, and in one item's list
+    struct StateLinks {
+        std::tuple<int&, int&> operator()(Order& order) const {
+            return {order.prevInState, order.nextInState};
+        }
+    };
+    struct ItemLinks {
+        int itemId;
+        std::tuple<int&, int&> operator()(Order& order) const {
+            OrderLine& line = *order.findLine(itemId);
+            return {line.prevForItem, line.nextForItem};
+        }
+    };
+
+    template <typename Links>
+    void linkOrder(OrderList& list, Order& order, Links links);
+
+    template <typename Links>
+    void unlinkOrder(OrderList& list, Order& order, Links links);
+
+    // Move an order to the back of the list for status. Moving to the
+    // current status sends it to the back of that list.
+    void moveOrder(Order& order, OrderStatus status);
+
+    void recordStatusChange(const Order& order);
+
+    // Give back the stock promised to an order or one of its lines
+    void releaseStock(const Order& order);
+    void releaseStock(int itemId, int quantity);
+
+    // Item ID recorded in the transactions of an order; 0 for several lines
+    static int transactionItemId(const Order& order) {
+        return order.lines.size() == 1 ? order.lines.front().itemId : 0;
+    }
+
+    void loadOrderLog();
+    void loadStockLog();
+    // Empty the stock log and mark it as applying to the current CSV file
+    void resetStockLog() const;
+    void logShipment(std::span<const RestockLine> lines);
+    // Reserve stock for the item's backorders that can now be filled in
+    // full, oldest first. Returns the number reserved.
+    std::size_t wakeBackorders(int itemId);
+
+    // Append the order's current state to the order log. Lines are left out
+    // when only the status changed.
+    void logOrder(const Order& order, bool withLines = false);
+
+public:
+    WarehouseSystem(const std::string& filename);
+
+    void addItem(const InventoryItem& item);
+
+    // Remove an item, cancelling its open orders that are not picked yet
+    bool removeItem(int id);
+
+    bool updateItem(const InventoryItem& item);
+
+    // Change items through updateItem() rather than the returned pointer,
+    // so the search and query indexes see the change
+    InventoryItem* findItem(int id);
+
+    const InventoryItem* findItem(int id) const;
+
+    void displayTableHeader() const;
+
+    void displayTableRow(const InventoryItem& item) const;
+
+    void displayAllItems() const;
+
+    // Fetch up to pageSize items following the cursor and advance it.
+    // ID order walks the map directly in O(log n + pageSize); name and
+    // quantity order keep the pageSize best candidates in a bounded heap,
+    // so memory stays proportional to the page rather than the catalog.
+    std::vector<InventoryItem> fetchPage(PageCursor& cursor, std::size_t pageSize) const;
+
+    void displayLowStockItems() const;
+
+    void displayByCategory(const std::string& category) const;
+
+    std::vector<InventoryItem> getAllItems() const;
+
+    // Up to limit items whose name matches query, ignoring case: exact
+    // names first, then names starting with the query, then names
+    // containing it, or close misspellings if nothing matches. Rename items
+    // through updateItem() so the name index sees the change.
+    std::vector<NameSearchResult> searchItems(std::string_view query, std::size_t limit = 10) const;
+
+    void displaySearchResults(std::string_view query, std::size_t limit = 10) const;
+    void displaySearchResults(std::string_view query, std::span<const NameSearchResult> results) const;
+
+    struct QueryResult {
+        std::vector<InventoryItem> items;  // Sorted, and cut to the query's limit
+        std::size_t matched = 0;           // Items passing every filter
+        QueryPlan plan;
+    };
+
+    // Run an ad-hoc report. The planner takes candidates from whichever
+    // index promises the fewest (category, name prefix, quantity or price
+    // range), or else scans the query columns; the remaining filters run
+    // on the candidates, and only the items within the limit are copied.
+    QueryResult queryItems(const ItemQuery& query) const;
+
+    void displayQueryResults(const ItemQuery& query) const;
+    void displayQueryResults(const QueryResult& result) const;
+
+    struct CategoryTotals {
+        std::string category;  // Full path, e.g. "Tools/Hand"
+        StockTotals totals;    // Items in the category and every category below it
+    };
+
+    struct StockReport {
+        StockTotals total;
+        std::vector<CategoryTotals> categories;  // Parents first, each followed by its subcategories
+    };
+
+    // Stock value, quantity, item count and low-stock count of the whole
+    // inventory and of every category, rolled up the slash-separated
+    // category tree. The query columns are summed on threadCount threads
+    // (0 for one per hardware thread).
+    StockReport aggregateStock(unsigned threadCount = 0) const;
+
+    // Running stock totals of every item, or of a category and the
+    // categories below it, kept up to date as items and stock change, so
+    // reading them is O(1)
+    StockTotals getStockTotals() const { return columns.runningTotals(); }
+    StockTotals getStockTotals(const std::string& category) const;
+
+    // The report of aggregateStock(), read from the running totals
+    StockReport getStockReport() const;
+
+    // Recount the stock totals as aggregateStock() does and replace the
+    // running totals with the recount, returning how far they had drifted.
+    // This also happens automatically after enough changes.
+    StockDrift verifyStockTotals(unsigned threadCount = 0);
+    const StockDrift& getLastStockDrift() const { return lastStockDrift; }
+    // Stock changes made since the totals were last verified
+    std::size_t getStockChangesSinceCheck() const { return stockChangesSinceCheck; }
+
+    void displayStockReport() const;
+    void displayStockReport(const StockReport& report) const;
+
+    // Reorder points and quantities forecast from demand. Stock taken by
+    // orders counts as demand on the day it is taken, and stock returned by
+    // cancelled or reduced orders counts against it; orders replayed from
+    // the order log count on the day they were placed.
+    const ForecastSettings& getForecastSettings() const { return forecaster.getSettings(); }
+    void setForecastSettings(const ForecastSettings& settings) { forecaster.setSettings(settings); }
+    bool getReorderRecommendation(int itemId, ReorderRecommendation& result) const {
+        return forecaster.recommend(itemId, std::time(nullptr), result);
+    }
+
+    // Recommendations for every item with demand, sorted by item ID,
+    // computed on threadCount threads (0 for one per hardware thread)
+    std::vector<ReorderRecommendation> recommendReorders(unsigned threadCount = 0) const;
+
+    // Set the minimum stock level of every item with demand to its reorder
+    // point, so the low stock listings show the items due for a restock.
+    // Returns the number of items changed.
+    std::size_t applyReorderPoints(unsigned threadCount = 0);
+
+    void displayReorderRecommendations(std::size_t limit = 20) const;
+
+    // Restock orders raised as items fall to their minimum stock level:
+    // drafts gather per category and are issued to the inbound queue once
+    // they fill up, or all at once by issueRestockOrders(). Received
+    // stock closes the issued lines for its item. Items that were already
+    // low when the inventory was loaded are not requested until their
+    // stock changes.
+    const ReplenishmentQueue& getReplenishment() const { return replenishment; }
+
+    // Issue every draft restock order. Returns the number issued.
+    std::size_t issueRestockOrders();
+
+    // Every draft and the newest limit issued orders
+    void displayRestockOrders(std::size_t limit = 20) const;
+
+    void sortByName() const;
+
+    void sortByQuantity() const;
+
+    int getNextId() const { return nextId; }
+
+    // Defer writing the CSV file while applying many changes. Re-enabling
+    // auto-save does not write by itself; call save() once at the end.
+    void setAutoSave(bool enabled) { autoSave = enabled; }
+    void save() const {
+        saveToFile();
+        flushLogs();
+    }
+    // Push buffered order and stock log records to disk. Writes are only
+    // flushed one by one while auto-save is on.
+    void flushLogs() const {
+        orderLog.flush();
+        stockLog.flush();
+    }
+
+    const std::string& getFilename() const { return filename; }
+
+    // Orders are kept in a log next to the inventory file
+    static std::string orderLogPathFor(const std::string& filename) { return filename + ".orders"; }
+    const std::string& getOrderLogPath() const { return orderLogPath; }
+
+    // Received stock is logged next to the inventory file until it is next saved
+    static std::string stockLogPathFor(const std::string& filename) { return filename + ".stock"; }
+
+    // Stock by location is saved next to the inventory file, once there
+    // are locations
+    static std::string locationsPathFor(const std::string& filename) { return filename + ".locations"; }
+    const std::string& getLocationsPath() const { return locationsPath; }
+
+    // Rewrite the order log with one record per order. This also happens
+    // automatically once superseded records outnumber the orders.
+    bool compactOrderLog();
+
+    // Write the inventory in the CSV file format, header included
+    void writeCsv(std::ostream& out) const;
+
+    // Saving the CSV file elsewhere, as AsyncWarehouse::saveAsync() does,
+    // takes two steps: write out the text of snapshotCsv(), then pass the
+    // snapshot to csvSaved() so the stock log keeps only the stock received
+    // since the snapshot was taken.
+    struct CsvSnapshot {
+        std::string text;
+        std::string locationsText;  // For the locations file, empty without locations
+        std::uint64_t hash;
+        std::uint64_t stockLogGeneration;
+        std::size_t stockLogSize;
+        std::size_t stockLogRecords;
+    };
+    CsvSnapshot snapshotCsv() const;
+    void csvSaved(const CsvSnapshot& snapshot) const;
+
+    // Parse one "ID,Name,Category,Quantity,Price,MinStockLevel" row.
+    // Returns false if a field is missing or not a valid number.
+    static bool parseCsvLine(const std::string& line, InventoryItem& item);
+
+    // Check that an item can be stored and round-trips through the CSV file
+    static bool isValidItem(const InventoryItem& item);
+
+    struct BulkUpsertResult {
+        std::size_t added = 0;
+        std::size_t updated = 0;
+        std::vector<int> rejectedIds;  // IDs of items that failed validation
+    };
+
+    // Insert or replace a range of items in one pass. Items are validated,
+    // sorted by ID (the last duplicate wins) and merged into the inventory
+    // with position hints, the category tree is touched once per distinct
+    // category, and the file is written once at the end.
+    template <typename Iterator>
+    BulkUpsertResult bulkUpsert(Iterator first, Iterator last) {
+        ScopedTimer timer(Operation::BulkUpsert);
+        BulkUpsertResult result;
+        std::vector<const InventoryItem*> valid;
+        valid.reserve(std::distance(first, last));
+        for (auto it = first; it != last; ++it) {
+            const InventoryItem& item = *it;
+            if (isValidItem(item)) {
+                valid.push_back(&item);
+            } else {
+                result.rejectedIds.push_back(item.getId());
+            }
+        }
+        if (valid.empty()) {
+            return result;
+        }
+
+        std::stable_sort(valid.begin(), valid.end(),
+                         [](const InventoryItem* a, const InventoryItem* b) {
+                             return a->getId() < b->getId();
+                         });
+
+        std::map<std::string, std::vector<int>> newIdsByCategory;
+        nameIndex.reserve(inventory.size() + valid.size());
+        auto hint = inventory.begin();
+        for (std::size_t i = 0; i < valid.size(); i++) {
+            if (i + 1 < valid.size() && valid[i + 1]->getId() == valid[i]->getId()) {
+                continue;  // A later duplicate replaces this one
+            }
+            const InventoryItem& item = *valid[i];
+            hint = inventory.lower_bound(item.getId());
+            nameIndex.insert(item.getId(), item.getName());
+            bool wasLow = false;
+            bool recategorized = false;
+            if (hint != inventory.end() && hint->first == item.getId()) {
+                wasLow = hint->second.isLowStock();
+                recategorized = hint->second.getCategory() != item.getCategory();
+                hint->second = item;
+                result.updated++;
+            } else {
+                hint = inventory.emplace_hint(hint, item.getId(), item);
+                newIdsByCategory[item.getCategory()].push_back(item.getId());
+                result.added++;
+            }
+            columns.upsert(hint->second);
+            fitLocations(hint->second);
+            noteLowStock(hint->second, wasLow);
+            if (recategorized) {
+                recategorizeRestock(hint->second);
+            }
+        }
+        nextId = std::max(nextId, valid.back()->getId() + 1);
+
+        for (const auto& [category, ids] : newIdsByCategory) {
+            auto categoryNode = findOrCreateCategory(category);
+            categoryNode->itemIds.insert(categoryNode->itemIds.end(), ids.begin(), ids.end());
+        }
+
+        addTransaction(TransactionAction::BulkUpsert, 0,
+            {"Added ", DecimalText(static_cast<long long>(result.added)), " and updated ",
+             DecimalText(static_cast<long long>(result.updated)), " items"});
+        noteStockChanges(result.added + result.updated);
+        persist();
+        return result;
+    }
+
+    BulkUpsertResult bulkUpsert(const std::vector<InventoryItem>& items) {
+        return bulkUpsert(items.begin(), items.end());
+    }
+
+    // Upsert every row of a CSV file in the inventory file format.
+    // Malformed rows are counted in malformedRows and skipped.
+    bool importFromFile(const std::string& path, BulkUpsertResult& result,
+                        std::size_t& malformedRows);
+
+    // Stock promised to pending orders, and stock that is neither taken
+    // nor promised. Available stock is negative if the item's quantity was
+    // lowered below what is promised.
+    int getReservedQuantity(int itemId) const;
+    int getAvailableQuantity(int itemId) const;
+
+    // Queue an order without printing. Lines for the same item are merged.
+    // The order is pending with stock promised for every line if enough is
+    // available for all of them, and backordered otherwise. Returns the new
+    // order ID, or 0 if there are no lines, an item does not exist or a
+    // quantity is not positive.
+    int placeOrder(std::span<const OrderLine> lines);
+
+    int placeOrder(int itemId, int quantity) {
+        OrderLine line(itemId, quantity);
+        return placeOrder(std::span<const OrderLine>(&line, 1));
+    }
+
+    // Place an order as placeOrder() does and print the outcome. Returns the
+    // new order ID, or 0 if the order was rejected.
+    int createOrder(int itemId, int quantity);
+
+    int createOrder(std::span<const OrderLine> lines);
+
+    // Parse order lines written as space-separated "itemId:quantity" pairs,
+    // e.g. "12:3 40:1". Returns false if the text is empty or malformed.
+    static bool parseOrderLines(std::string_view text, std::vector<OrderLine>& lines);
+    static std::string formatOrderLines(std::span<const OrderLine> lines);
+
+    enum class OrderResult { Processed, InsufficientStock, ItemMissing, NoOrders };
+
+    // Reserve stock for the order at the front of the queue without
+    // printing. Pending orders go first and take the stock promised to
+    // them, then backorders, which need stock nobody else was promised.
+    // Orders short on stock are backordered and move to the back of the
+    // backorders; orders for removed items are cancelled. The handled order
+    // is copied to handled if given.
+    OrderResult fulfillNextOrder(Order* handled = nullptr);
+
+    // Reserve stock for one queued order, as fulfillNextOrder() does. All
+    // lines are reserved together or none of them is. Returns NoOrders if
+    // the order is not waiting in the queue.
+    OrderResult fulfillOrder(int orderId);
+
+    // Fulfill the next order and print the outcome
+    OrderResult processNextOrder();
+
+    const Order* findOrder(int orderId) const { return orderRecord(orderId); }
+
+    // Move an order along the state machine. Reserving takes the stock and
+    // fails if there is not enough; cancelling a reserved order returns it.
+    // A pending order gives up its promised stock when it is cancelled or
+    // backordered.
+    // Returns false for unknown orders and invalid transitions.
+    bool setOrderStatus(int orderId, OrderStatus status);
+
+    std::size_t getOrderCount(OrderStatus status) const {
+        return ordersByState[static_cast<std::size_t>(status)].size;
+    }
+
+    // Orders in the given state, oldest first
+    std::vector<Order> getOrdersByStatus(OrderStatus status) const;
+
+    // Open orders for an item, oldest first
+    std::vector<Order> getOpenOrdersForItem(int itemId) const;
+
+    // Cancel an order that has not been picked yet. Returns false if the
+    // order does not exist or is past the point of cancelling.
+    bool cancelOrder(int orderId) { return setOrderStatus(orderId, OrderStatus::Cancelled); }
+
+    // Change the quantity of one line of a queued or reserved order without
+    // moving it in the queue. Pending and reserved orders take or return the
+    // difference in promised or actual stock, and fail if not enough is
+    // available.
+    bool amendOrder(int orderId, int itemId, int quantity);
+
+    // Amend a single-line order. Fails for orders with several lines.
+    bool amendOrder(int orderId, int quantity) {
+        auto order = orderRecord(orderId);
+        return order && order->lines.size() == 1 &&
+               amendOrder(orderId, order->lines.front().itemId, quantity);
+    }
+
+    struct ReceiveResult {
+        bool received = false;
+        std::size_t ordersReserved = 0;  // Backorders the new stock let through
+    };
+
+    // Add delivered stock without rewriting the rest of the item, and
+    // without writing the CSV file: each delivery is appended to the stock
+    // log as one record. A shipment's lines are merged by item and checked
+    // together, then applied together; nothing changes if an item does not
+    // exist, a quantity is not positive or a quantity would overflow.
+    // The delivery closes the items' issued restock lines, and backorders
+    // for the delivered items are then reserved, oldest first, if they
+    // can be filled in full.
+    ReceiveResult receiveShipment(std::span<const RestockLine> lines);
+
+    ReceiveResult receiveStock(int itemId, int quantity) {
+        RestockLine line{itemId, quantity};
+        return receiveShipment(std::span<const RestockLine>(&line, 1));
+    }
+
+    // Receive stock into a bin, numbering the location if it is new.
+    // Nothing is received for an invalid "Warehouse/Zone/Bin" path.
+    ReceiveResult receiveStockAt(int itemId, std::string_view location, int quantity);
+
+    // Stock by location. Orders take their stock from the item's bins when
+    // they are reserved, and cancelled or reduced orders put it back where
+    // it came from; the allocation policy picks the bins, with origin as
+    // the starting point of the Nearest policy.
+    const LocationStock& getLocations() const { return locations; }
+    int getUnlocatedQuantity(int itemId) const;
+    AllocationPolicy getAllocationPolicy() const { return allocationPolicy; }
+    // Returns false, changing nothing, if origin is neither empty nor a
+    // known location
+    bool setAllocationPolicy(AllocationPolicy policy, std::string_view origin = "");
+    // Bins an order's stock was taken from, until it ships or is cancelled
+    std::span<const Pick> getOrderPicks(int orderId) const;
+
+    // Move stock of an item into a bin, from another bin or, with an empty
+    // from, from its unlocated stock. Returns false, changing nothing, if
+    // there is not enough stock where it comes from or a path is invalid.
+    bool moveStock(int itemId, std::string_view from, std::string_view to, int quantity);
+
+    void displayItemLocations(int itemId) const;
+
+    std::size_t getPendingOrderCount() const {
+        return getOrderCount(OrderStatus::Pending) + getOrderCount(OrderStatus::Backordered);
+    }
+
+    void displayTransactionHistory(int limit = 10) const;
+
+    void displayOrderQueue() const;
+
+    void displayOrdersByStatus(OrderStatus status) const;
+
+    void displayItemOrders(int itemId) const;
+
+    void displayOrder(const Order& order) const;
+};